@@ -0,0 +1,123 @@
+#ifndef CLI_H
+#define CLI_H
+
+// argument handling shared by sas2csv and sas2bin
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sascore.h"
+
+// rows decoded at once
+#define CLI_BATCH 65536
+
+struct CliArgs {
+  std::string in, out;
+  std::vector<std::string> cols;
+  char delim = ',';
+  bool keep_deleted = false;
+  bool debug = false;
+  bool dates = true;
+  int nthreads = 1;
+  std::string na;
+};
+
+inline bool sas_big_endian()
+{
+  const uint16_t one = 1;
+  return *(const uint8_t*)&one == 0;
+}
+
+inline bool cli_args(int argc, char** argv, const char* prog, CliArgs& args)
+{
+  std::vector<std::string> pos;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+
+    if (a == "-d" && i + 1 < argc) {
+      std::string d = argv[++i];
+      args.delim = d == "\\t" ? '\t' : d[0];
+    } else if (a == "-c" && i + 1 < argc) {
+      std::stringstream ss(argv[++i]);
+      std::string col;
+      while (std::getline(ss, col, ',')) args.cols.push_back(col);
+    } else if (a == "-t" && i + 1 < argc) {
+      args.nthreads = std::atoi(argv[++i]);
+    } else if (a == "-n" && i + 1 < argc) {
+      args.na = argv[++i];
+    } else if (a == "-D") {
+      args.dates = false;
+    } else if (a == "-k") {
+      args.keep_deleted = true;
+    } else if (a == "-v") {
+      args.debug = true;
+    } else if (a.size() > 1 && a[0] == '-') {
+      pos.clear();
+      break;
+    } else {
+      pos.push_back(a);
+    }
+  }
+
+  if (pos.empty() || pos.size() > 2) {
+    std::cerr << "usage: " << prog <<
+      " [-d delim] [-c col,col,...] [-t threads] [-n na] [-D] [-k] [-v]"
+      " file.sas7bdat [out]" << std::endl;
+    return false;
+  }
+
+  args.in = pos[0];
+  if (pos.size() > 1) args.out = pos[1];
+
+  return true;
+}
+
+// print warnings and errors. Returns false on error.
+inline bool cli_check(SasReader& reader, int status)
+{
+  std::vector<std::string>& warnings = reader.log().warnings;
+  for (auto& msg : warnings)
+    std::cerr << "warning: " << msg << std::endl;
+  warnings.clear();
+
+  if (status != SAS_OK) {
+    if (status == SAS_ERROR_WRITE)
+      std::cerr << "error: " << sas_strerror(status) << std::endl;
+    else
+      std::cerr << "error: " << reader.error() << " (" <<
+        sas_strerror(status) << ")" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+inline bool cli_open(SasReader& reader, const CliArgs& args,
+                     std::vector<int64_t>& cols)
+{
+  if (args.debug) reader.log().debug = &std::cerr;
+
+  if (!cli_check(reader, reader.open(args.in))) return false;
+
+  if (args.cols.empty()) {
+    for (int64_t i = 0; i < reader.ncol(); ++i) cols.push_back(i);
+    return true;
+  }
+
+  for (auto& name : args.cols) {
+    int64_t c = reader.column(name);
+    if (c < 0) {
+      std::cerr << "error: column " << name << " not found" << std::endl;
+      return false;
+    }
+    cols.push_back(c);
+  }
+
+  return true;
+}
+
+#endif
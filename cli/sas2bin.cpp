@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// sas2bin: convert a sas7bdat file to a simple columnar binary file
+//
+//   sas2bin [-c col,col,...] [-k] [-v] file.sas7bdat out.bin
+//
+// Layout, all integers little endian:
+//
+//   "SASBIN01"                    8 bytes magic
+//   int64 nrow, int64 ncol
+//   per column: uint8 type (1 numeric, 2 character), int32 name length, name
+//   per column, in order:
+//     numeric:   nrow float64 values, SAS missings are NaN
+//     character: (nrow + 1) int64 offsets into the following int64 length
+//                prefixed block of characters
+//
+// Columns are written one after another, the file is assembled from batches
+// kept in temporary column files to bound memory.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "sascore.h"
+#include "cli.h"
+
+template <typename T>
+static void put(std::ostream& out, T val)
+{
+  if (sas_big_endian()) val = swap_endian(val);
+  out.write((const char*)&val, sizeof(val));
+}
+
+static bool copy_file(const std::string& from, std::ostream& out)
+{
+  std::ifstream in(from, std::ios::binary);
+  char buf[65536];
+  while (in.read(buf, sizeof(buf)) || in.gcount() > 0)
+    out.write(buf, in.gcount());
+  return (bool)out;
+}
+
+int main(int argc, char** argv)
+{
+  CliArgs args;
+  if (!cli_args(argc, argv, "sas2bin", args)) return 2;
+
+  if (args.out.empty()) {
+    std::cerr << "sas2bin: output file required" << std::endl;
+    return 2;
+  }
+
+  SasReader reader;
+  std::vector<int64_t> cols;
+  if (!cli_open(reader, args, cols)) return 1;
+
+  size_t kk = cols.size();
+
+  // values and characters of every column go to temporary files first
+  std::vector<std::string> tmpval(kk), tmpchr(kk);
+  std::vector<std::ofstream> val(kk), chr(kk);
+  std::vector<int64_t> charpos(kk, 0);
+
+  for (size_t j = 0; j < kk; ++j) {
+    tmpval[j] = args.out + "." + std::to_string(j) + ".val";
+    tmpchr[j] = args.out + "." + std::to_string(j) + ".chr";
+    val[j].open(tmpval[j], std::ios::binary);
+    if (reader.meta().vartyps[cols[j]] != 1) {
+      chr[j].open(tmpchr[j], std::ios::binary);
+      put<int64_t>(val[j], 0);
+    }
+  }
+
+  auto cleanup = [&]() {
+    for (size_t j = 0; j < kk; ++j) {
+      val[j].close();
+      chr[j].close();
+      std::remove(tmpval[j].c_str());
+      std::remove(tmpchr[j].c_str());
+    }
+  };
+
+  SasBatch batch;
+  int64_t nrow = 0;
+
+  for (int64_t start = 0; start < reader.nrow(); start += CLI_BATCH) {
+    int status = reader.read(start, CLI_BATCH, cols, !args.keep_deleted, batch);
+    if (!cli_check(reader, status)) {
+      cleanup();
+      return 1;
+    }
+
+    for (size_t j = 0; j < kk; ++j) {
+      const SasColumn& col = batch.cols[j];
+      if (col.numeric) {
+        for (auto v : col.num) put(val[j], v);
+      } else {
+        for (size_t i = 0; i < batch.rows.size(); ++i)
+          put<int64_t>(val[j], charpos[j] + col.offsets[i + 1]);
+        chr[j].write(col.chars.data(), col.chars.size());
+        charpos[j] += col.chars.size();
+      }
+    }
+
+    nrow += batch.rows.size();
+  }
+
+  std::ofstream out(args.out, std::ios::binary);
+  out.write("SASBIN01", 8);
+  put<int64_t>(out, nrow);
+  put<int64_t>(out, kk);
+
+  for (size_t j = 0; j < kk; ++j) {
+    const std::string& name = reader.meta().varnames[cols[j]];
+    put<uint8_t>(out, reader.meta().vartyps[cols[j]] == 1 ? 1 : 2);
+    put<int32_t>(out, name.size());
+    out.write(name.data(), name.size());
+  }
+
+  bool ok = (bool)out;
+  for (size_t j = 0; j < kk && ok; ++j) {
+    val[j].close();
+    ok = copy_file(tmpval[j], out);
+
+    if (ok && chr[j].is_open()) {
+      chr[j].close();
+      put<int64_t>(out, charpos[j]);
+      ok = copy_file(tmpchr[j], out);
+    }
+  }
+
+  cleanup();
+
+  if (!ok) {
+    std::cerr << "sas2bin: write error" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// sas2csv: convert a sas7bdat file to csv without R
+//
+//   sas2csv [-d delim] [-c col,col,...] [-t threads] [-n na] [-D] [-k] [-v]
+//           file.sas7bdat [out.csv]
+//
+// -d field delimiter (default ,), -c selected columns, -t formatting threads,
+// -n string for missing values, -D do not format dates, -k keep deleted rows,
+// -v print debug output. Without out.csv the result is written to stdout.
+
+#include <fstream>
+#include <iostream>
+
+#include "sascore.h"
+#include "sascsv.h"
+#include "cli.h"
+
+int main(int argc, char** argv)
+{
+  CliArgs args;
+  if (!cli_args(argc, argv, "sas2csv", args)) return 2;
+
+  SasReader reader;
+  std::vector<int64_t> cols;
+  if (!cli_open(reader, args, cols)) return 1;
+
+  std::ofstream file;
+  if (!args.out.empty()) {
+    file.open(args.out, std::ios::binary);
+    if (!file) {
+      std::cerr << "sas2csv: could not open " << args.out << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& out = args.out.empty() ? std::cout : file;
+
+  SasCsvOptions opt;
+  opt.sep = args.delim;
+  opt.quote = false;
+  opt.na = args.na;
+  opt.dates = args.dates;
+  opt.skip_deleted = !args.keep_deleted;
+  opt.nthreads = args.nthreads;
+  opt.chunk = CLI_BATCH;
+
+  int64_t rows = 0;
+  return cli_check(reader, sas_write_csv(reader, cols, out, opt, rows)) ? 0 : 1;
+}
@@ -11,29 +11,280 @@ Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
 // readsas
-Rcpp::List readsas(const char * filePath, const bool debug, Nullable<IntegerVector> selectrows_, Nullable<CharacterVector> selectcols_, const bool empty_to_na, std::string tempstr, const bool convert);
-RcppExport SEXP _readsas_readsas(SEXP filePathSEXP, SEXP debugSEXP, SEXP selectrows_SEXP, SEXP selectcols_SEXP, SEXP empty_to_naSEXP, SEXP tempstrSEXP, SEXP convertSEXP) {
+Rcpp::List readsas(SEXP input, const bool debug, Nullable<NumericVector> selectrows_, Nullable<CharacterVector> selectcols_, const bool empty_to_na, const bool convert, const bool profile, Nullable<CharacterVector> col_classes_, const bool narrow, Nullable<List> where_, Nullable<CharacterVector> zonemap_, Nullable<CharacterVector> index_, Nullable<List> sample_, const double n_max, Nullable<List> lazy_, const bool pagemap, Nullable<NumericVector> pages_, Nullable<List> formats_);
+RcppExport SEXP _readsas_readsas(SEXP inputSEXP, SEXP debugSEXP, SEXP selectrows_SEXP, SEXP selectcols_SEXP, SEXP empty_to_naSEXP, SEXP convertSEXP, SEXP profileSEXP, SEXP col_classes_SEXP, SEXP narrowSEXP, SEXP where_SEXP, SEXP zonemap_SEXP, SEXP index_SEXP, SEXP sample_SEXP, SEXP n_maxSEXP, SEXP lazy_SEXP, SEXP pagemapSEXP, SEXP pages_SEXP, SEXP formats_SEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< const char * >::type filePath(filePathSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
     Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
-    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type selectrows_(selectrows_SEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type selectrows_(selectrows_SEXP);
     Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type selectcols_(selectcols_SEXP);
     Rcpp::traits::input_parameter< const bool >::type empty_to_na(empty_to_naSEXP);
-    Rcpp::traits::input_parameter< std::string >::type tempstr(tempstrSEXP);
     Rcpp::traits::input_parameter< const bool >::type convert(convertSEXP);
-    rcpp_result_gen = Rcpp::wrap(readsas(filePath, debug, selectrows_, selectcols_, empty_to_na, tempstr, convert));
+    Rcpp::traits::input_parameter< const bool >::type profile(profileSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type col_classes_(col_classes_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type narrow(narrowSEXP);
+    Rcpp::traits::input_parameter< Nullable<List> >::type where_(where_SEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type zonemap_(zonemap_SEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type index_(index_SEXP);
+    Rcpp::traits::input_parameter< Nullable<List> >::type sample_(sample_SEXP);
+    Rcpp::traits::input_parameter< const double >::type n_max(n_maxSEXP);
+    Rcpp::traits::input_parameter< Nullable<List> >::type lazy_(lazy_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type pagemap(pagemapSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type pages_(pages_SEXP);
+    Rcpp::traits::input_parameter< Nullable<List> >::type formats_(formats_SEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas(input, debug, selectrows_, selectcols_, empty_to_na, convert, profile, col_classes_, narrow, where_, zonemap_, index_, sample_, n_max, lazy_, pagemap, pages_, formats_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_arrow
+double readsas_arrow(SEXP input, SEXP array_ptr, SEXP schema_ptr, Nullable<NumericVector> selectrows_, Nullable<CharacterVector> selectcols_, const bool remove_deleted, const bool empty_to_na, const bool convert);
+RcppExport SEXP _readsas_readsas_arrow(SEXP inputSEXP, SEXP array_ptrSEXP, SEXP schema_ptrSEXP, SEXP selectrows_SEXP, SEXP selectcols_SEXP, SEXP remove_deletedSEXP, SEXP empty_to_naSEXP, SEXP convertSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type array_ptr(array_ptrSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type schema_ptr(schema_ptrSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type selectrows_(selectrows_SEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type selectcols_(selectcols_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type remove_deleted(remove_deletedSEXP);
+    Rcpp::traits::input_parameter< const bool >::type empty_to_na(empty_to_naSEXP);
+    Rcpp::traits::input_parameter< const bool >::type convert(convertSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_arrow(input, array_ptr, schema_ptr, selectrows_, selectcols_, remove_deleted, empty_to_na, convert));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_cache_open
+SEXP readsas_cache_open(std::string path, std::string source);
+RcppExport SEXP _readsas_readsas_cache_open(SEXP pathSEXP, SEXP sourceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type source(sourceSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_cache_open(path, source));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_cache_write
+bool readsas_cache_write(std::string path, std::string source, List data, RawVector meta);
+RcppExport SEXP _readsas_readsas_cache_write(SEXP pathSEXP, SEXP sourceSEXP, SEXP dataSEXP, SEXP metaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::string >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< List >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< RawVector >::type meta(metaSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_cache_write(path, source, data, meta));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_formats
+Rcpp::List readsas_formats(SEXP input, const bool debug);
+RcppExport SEXP _readsas_readsas_formats(SEXP inputSEXP, SEXP debugSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_formats(input, debug));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_csv
+double readsas_csv(SEXP input, std::string out, Nullable<CharacterVector> selectcols_, std::string sep, const bool quote, std::string na, const bool convert_dates, const bool remove_deleted, const bool convert, int nthreads, double chunk);
+RcppExport SEXP _readsas_readsas_csv(SEXP inputSEXP, SEXP outSEXP, SEXP selectcols_SEXP, SEXP sepSEXP, SEXP quoteSEXP, SEXP naSEXP, SEXP convert_datesSEXP, SEXP remove_deletedSEXP, SEXP convertSEXP, SEXP nthreadsSEXP, SEXP chunkSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< std::string >::type out(outSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type selectcols_(selectcols_SEXP);
+    Rcpp::traits::input_parameter< std::string >::type sep(sepSEXP);
+    Rcpp::traits::input_parameter< const bool >::type quote(quoteSEXP);
+    Rcpp::traits::input_parameter< std::string >::type na(naSEXP);
+    Rcpp::traits::input_parameter< const bool >::type convert_dates(convert_datesSEXP);
+    Rcpp::traits::input_parameter< const bool >::type remove_deleted(remove_deletedSEXP);
+    Rcpp::traits::input_parameter< const bool >::type convert(convertSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< double >::type chunk(chunkSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_csv(input, out, selectcols_, sep, quote, na, convert_dates, remove_deleted, convert, nthreads, chunk));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_open
+SEXP readsas_open(SEXP input, const bool debug, const double pages);
+RcppExport SEXP _readsas_readsas_open(SEXP inputSEXP, SEXP debugSEXP, SEXP pagesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    Rcpp::traits::input_parameter< const double >::type pages(pagesSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_open(input, debug, pages));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_read
+Rcpp::List readsas_read(SEXP handle, const bool debug, Nullable<NumericVector> selectrows_, Nullable<CharacterVector> selectcols_, const bool empty_to_na, const bool convert, Nullable<CharacterVector> col_classes_, const bool narrow, Nullable<List> where_);
+RcppExport SEXP _readsas_readsas_read(SEXP handleSEXP, SEXP debugSEXP, SEXP selectrows_SEXP, SEXP selectcols_SEXP, SEXP empty_to_naSEXP, SEXP convertSEXP, SEXP col_classes_SEXP, SEXP narrowSEXP, SEXP where_SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle(handleSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type selectrows_(selectrows_SEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type selectcols_(selectcols_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type empty_to_na(empty_to_naSEXP);
+    Rcpp::traits::input_parameter< const bool >::type convert(convertSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type col_classes_(col_classes_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type narrow(narrowSEXP);
+    Rcpp::traits::input_parameter< Nullable<List> >::type where_(where_SEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_read(handle, debug, selectrows_, selectcols_, empty_to_na, convert, col_classes_, narrow, where_));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_close
+void readsas_close(SEXP handle);
+RcppExport SEXP _readsas_readsas_close(SEXP handleSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle(handleSEXP);
+    readsas_close(handle);
+    return R_NilValue;
+END_RCPP
+}
+// readsas_layout
+Rcpp::List readsas_layout(SEXP input, const bool debug);
+RcppExport SEXP _readsas_readsas_layout(SEXP inputSEXP, SEXP debugSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_layout(input, debug));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_rowpos
+Rcpp::List readsas_rowpos(NumericVector pagerows, const double rowlength, NumericVector rows_, const double from, const double to);
+RcppExport SEXP _readsas_readsas_rowpos(SEXP pagerowsSEXP, SEXP rowlengthSEXP, SEXP rows_SEXP, SEXP fromSEXP, SEXP toSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type pagerows(pagerowsSEXP);
+    Rcpp::traits::input_parameter< const double >::type rowlength(rowlengthSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type rows_(rows_SEXP);
+    Rcpp::traits::input_parameter< const double >::type from(fromSEXP);
+    Rcpp::traits::input_parameter< const double >::type to(toSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_rowpos(pagerows, rowlength, rows_, from, to));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_multi
+Rcpp::List readsas_multi(CharacterVector files, const bool debug, Nullable<CharacterVector> selectcols_, const bool empty_to_na, const bool convert, int nthreads);
+RcppExport SEXP _readsas_readsas_multi(SEXP filesSEXP, SEXP debugSEXP, SEXP selectcols_SEXP, SEXP empty_to_naSEXP, SEXP convertSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< CharacterVector >::type files(filesSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type selectcols_(selectcols_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type empty_to_na(empty_to_naSEXP);
+    Rcpp::traits::input_parameter< const bool >::type convert(convertSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_multi(files, debug, selectcols_, empty_to_na, convert, nthreads));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+// readsas_refresh
+Rcpp::List readsas_refresh(SEXP input, List pagemap_, const bool debug);
+RcppExport SEXP _readsas_readsas_refresh(SEXP inputSEXP, SEXP pagemap_SEXP, SEXP debugSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< List >::type pagemap_(pagemap_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_refresh(input, pagemap_, debug));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_summary
+Rcpp::List readsas_summary(SEXP input, Nullable<CharacterVector> selectcols_, const bool remove_deleted, int top, int nthreads, const bool debug);
+RcppExport SEXP _readsas_readsas_summary(SEXP inputSEXP, SEXP selectcols_SEXP, SEXP remove_deletedSEXP, SEXP topSEXP, SEXP nthreadsSEXP, SEXP debugSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type selectcols_(selectcols_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type remove_deleted(remove_deletedSEXP);
+    Rcpp::traits::input_parameter< int >::type top(topSEXP);
+    Rcpp::traits::input_parameter< int >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_summary(input, selectcols_, remove_deleted, top, nthreads, debug));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_xpt
+Rcpp::List readsas_xpt(SEXP input, const bool debug, const double offset, Nullable<NumericVector> selectrows_, Nullable<CharacterVector> selectcols_, const bool empty_to_na, const bool convert);
+RcppExport SEXP _readsas_readsas_xpt(SEXP inputSEXP, SEXP debugSEXP, SEXP offsetSEXP, SEXP selectrows_SEXP, SEXP selectcols_SEXP, SEXP empty_to_naSEXP, SEXP convertSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    Rcpp::traits::input_parameter< const double >::type offset(offsetSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type selectrows_(selectrows_SEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type selectcols_(selectcols_SEXP);
+    Rcpp::traits::input_parameter< const bool >::type empty_to_na(empty_to_naSEXP);
+    Rcpp::traits::input_parameter< const bool >::type convert(convertSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_xpt(input, debug, offset, selectrows_, selectcols_, empty_to_na, convert));
+    return rcpp_result_gen;
+END_RCPP
+}
+// readsas_xpt_members
+Rcpp::List readsas_xpt_members(SEXP input, const bool debug);
+RcppExport SEXP _readsas_readsas_xpt_members(SEXP inputSEXP, SEXP debugSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const bool >::type debug(debugSEXP);
+    rcpp_result_gen = Rcpp::wrap(readsas_xpt_members(input, debug));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_readsas_readsas", (DL_FUNC) &_readsas_readsas, 7},
+    {"_readsas_readsas", (DL_FUNC) &_readsas_readsas, 18},
+    {"_readsas_readsas_arrow", (DL_FUNC) &_readsas_readsas_arrow, 8},
+    {"_readsas_readsas_cache_open", (DL_FUNC) &_readsas_readsas_cache_open, 2},
+    {"_readsas_readsas_cache_write", (DL_FUNC) &_readsas_readsas_cache_write, 4},
+    {"_readsas_readsas_close", (DL_FUNC) &_readsas_readsas_close, 1},
+    {"_readsas_readsas_csv", (DL_FUNC) &_readsas_readsas_csv, 11},
+    {"_readsas_readsas_formats", (DL_FUNC) &_readsas_readsas_formats, 2},
+    {"_readsas_readsas_layout", (DL_FUNC) &_readsas_readsas_layout, 2},
+    {"_readsas_readsas_multi", (DL_FUNC) &_readsas_readsas_multi, 6},
+    {"_readsas_readsas_open", (DL_FUNC) &_readsas_readsas_open, 3},
+    {"_readsas_readsas_read", (DL_FUNC) &_readsas_readsas_read, 9},
+    {"_readsas_readsas_refresh", (DL_FUNC) &_readsas_readsas_refresh, 3},
+    {"_readsas_readsas_rowpos", (DL_FUNC) &_readsas_readsas_rowpos, 5},
+    {"_readsas_readsas_summary", (DL_FUNC) &_readsas_readsas_summary, 6},
+    {"_readsas_readsas_xpt", (DL_FUNC) &_readsas_readsas_xpt, 7},
+    {"_readsas_readsas_xpt_members", (DL_FUNC) &_readsas_readsas_xpt_members, 2},
     {NULL, NULL, 0}
 };
 
+void readsas_cache_init(DllInfo* dll);
+void readsas_lazy_init(DllInfo* dll);
 RcppExport void R_init_readsas(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    readsas_cache_init(dll);
+    readsas_lazy_init(dll);
 }
@@ -15,2453 +15,921 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cctype>
+#include <cerrno>
+#include <climits>
 #include <cstdio>
+#include <cstdlib>
 #include <stdint.h>
 #include <string>
 #include <fstream>
 #include <streambuf>
 #include <regex>
 #include <bitset>
+#include <memory>
 
 #include "sas.h"
-#include "uncompress.h"
 
 using namespace Rcpp;
 
 
-//' Reads SAS data files
-//'
-//' @param filePath The full systempath to the sas7bdat file you want to import.
-//' @param debug print debug information
-//' @param selectrows_ integer vector of selected rows
-//' @param selectcols_ character vector of selected rows
-//' @param empty_to_na logical convert '' to NA_character_
-//' @param tempstr filepath used for temp output when uncompressing
-//' @param convert logical convert missings `.I` and `.M` to Inf and -Inf
-//' @import Rcpp
-//' @keywords internal
-//' @noRd
-// [[Rcpp::export]]
-Rcpp::List readsas(const char * filePath,
-                   const bool debug,
-                   Nullable<IntegerVector> selectrows_,
-                   Nullable<CharacterVector> selectcols_,
-                   const bool empty_to_na,
-                   std::string tempstr,
-                   const bool convert)
-{
-  std::ifstream sas(filePath, std::ios::in | std::ios::binary | std::ios::ate);
-  auto sas_size = sas.tellg();
-  if (sas) {
-
-    sas.seekg(0, std::ios_base::beg);
-
-    if (tempstr.compare("") == 0) tempstr = ".readsas_unc_tmp_file";
-    std::fstream out (tempstr, std::ios::out | std::ios::binary);
-
-
-    int compr = 0;
-
-    bool hasattributes = 0, hasproc = 1, swapit = 0, c5first = 0;
-    int8_t  unk8  = 0;
-    int8_t ALIGN_1_CHECKER_VALUE = 0;
-    int8_t ALIGN_2_VALUE = 0;
-    int8_t ENDIANNESS = 0;
-    int16_t unk16 = 0;
-    int32_t unk32 = 0;
-    int64_t unk64 = 0;
-    double unkdub = 0;
-
-    int8_t u64 = 0;
-    uint8_t encoding = 0;
-    int16_t dataoffset = 0;
-    int16_t swlen = 0, proclen = 0, comprlen = 0, textoff = 0, todata = 0,
-      addtextoff = 0, fmtkey = 0, fmtkey2 = 0,
-      fmt32 = 0, fmt322 = 0, ifmt32 = 0, ifmt322 = 0;
-    int16_t PAGE_TYPE = 0, BLOCK_COUNT = 0, SUBHEADER_COUNT = 0;
-
-    uint32_t pageseqnum32 = 0;
-
-    double created = 0, created2 = 0;   // 8
-    double modified = 0, modified2 = 0; // 16
-
-    std::string compression = "";
-    std::string compstr = "";
-    std::string proc = "";
-    std::string enc = "";
-    std::string sw = "";
-    std::string sasfile  (8, '\0');
-    std::string filetype (8, '\0');
-    std::string sasrel   (8, '\0');
-    std::string sasserv  (16, '\0');
-    std::string osver    (16, '\0');
-    std::string osmaker  (16, '\0');
-    std::string osname   (16, '\0');
-    std::string dataset  (64, '\0');
-
-    std::vector<CN_Poi> cnpois;
-    std::vector<idxofflen> fmt;
-    std::vector<idxofflen> lbl;
-    std::vector<idxofflen> unk;
-    std::vector<int16_t> c8vec;
-
-    std::vector<double> fmt32s;
-    std::vector<double> ifmt32s;
-    std::vector<double> fmtkeys;
-    std::vector<int32_t> vartyps;
-    std::vector<int32_t> colwidth;
-    std::vector<int64_t> coloffset;
-    std::vector<int16_t> page_type;
-    std::vector<int16_t> cnidx;
-    std::vector<int16_t> cnoff;
-    std::vector<int16_t> cnlen;
-    std::vector<int16_t> cnzer;
-
-    std::vector<std::string> labels;
-    std::vector<std::string> formats;
-    std::vector<std::string> varnames; // (k)
-
-    // read 2* 4*4 = 32
-    // 0 - 31: Magic Number
-    int32_t mn1 = 0, mn2 = 0, mn3 = 0, mn4 = 0;
-    int32_t mn5 = 0, mn6 = 0, mn7 = 0, mn8 = 0;
-
-    mn1 = readbin(mn1, sas, 0);
-    mn2 = readbin(mn2, sas, 0);
-    mn3 = readbin(mn3, sas, 0);
-    mn4 = readbin(mn4, sas, 0);
-    mn5 = readbin(mn5, sas, 0);
-    mn6 = readbin(mn6, sas, 0);
-    mn7 = readbin(mn7, sas, 0);
-    mn8 = readbin(mn8, sas, 0);
+// column classes of read.sas(col_classes = ...)
+enum ColClass {
+  CC_DEFAULT = 0, CC_NUMERIC, CC_INTEGER, CC_LOGICAL, CC_INTEGER64,
+  CC_CHARACTER, CC_SKIP
+};
 
-    if (debug)
-      Rprintf("Magicnumber: %d, %d, %d, %d, %d, %d, %d, %d  \n",
-              mn1, mn2, mn3, mn4, mn5, mn6, mn7, mn8);
-
-    if (mn1 != 0)
-      Rcpp::warning("mn1 != 0");
-    // End Magicnumber
-
-    /*
-     * Most likely the following blocks of 4 are handled as fixed values. eg as
-     *  int32 with a specific meaning.
-     *
-     */
-
-    if (debug) Rcout << sas.tellg() << std::endl;
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    ALIGN_1_CHECKER_VALUE = readbin(ALIGN_1_CHECKER_VALUE, sas, 0); // 51 or 34
-    if (ALIGN_1_CHECKER_VALUE == 51) u64 = 4;// 51 is b'3'
-    if (debug) Rprintf("ALIGN_1_CHECKER_VALUE: %d \n", ALIGN_1_CHECKER_VALUE);
-
-    unk8 = readbin(unk8, sas, 0);
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, 0);
-    if (debug) Rprintf("%d\n", unk8);
-    int8_t U64_BYTE_CHECKER_VALUE = 0;
-    U64_BYTE_CHECKER_VALUE = readbin(U64_BYTE_CHECKER_VALUE, sas, 0);
-    if (U64_BYTE_CHECKER_VALUE == 51) ALIGN_2_VALUE = 4;
-    if (debug) Rprintf("U64_BYTE_CHECKER_VALUE: %d \n", U64_BYTE_CHECKER_VALUE);
-    // end block of 4
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, 0);
-    if (debug) Rprintf("%d\n", unk8);
-    ENDIANNESS = readbin(ENDIANNESS, sas, 0);
-    if (debug) Rprintf("ENDIANNESS: %d \n", ENDIANNESS);
-    if (ENDIANNESS == 0) swapit = 1;
-    // if (ENDIANNESS < 1) stop("Endiannes < 1 found");
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-    // (1) 49 Unix (2) 50 Win
-    uint8_t PLATFORM = 0;
-    PLATFORM = readbin(PLATFORM, sas, swapit);
-    if (debug) Rprintf("PLATFORM: %d \n", PLATFORM);
-    // end block of 4
-
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit); // 1|4
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // ?
-    if (debug) Rprintf("%d\n", unk8);
-
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 3
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 1
-    if (debug) Rprintf("%d\n", unk8);
-
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-
-
-    int8_t U64_BYTE_CHECKER_VALUE2 = 0;
-
-    /* SAS written files repeat the first two blocks here */
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("ALIGN_1_CHECKER_VALUE2 %d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-    U64_BYTE_CHECKER_VALUE2 = readbin(U64_BYTE_CHECKER_VALUE2, sas, swapit);
-    if (debug) Rprintf("U64_BYTE_CHECKER_VALUE2 %d\n", U64_BYTE_CHECKER_VALUE2);
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("%d\n", unk8);
-    ENDIANNESS = readbin(ENDIANNESS, sas, swapit);
-    if (debug) Rprintf("ENDIANNESS: %d \n", ENDIANNESS);
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("unk2 %d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit);
-    if (debug) Rprintf("Platform2 %d\n", unk8);
-
-    // o64
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg() << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit); // 4
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 51
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 1
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 35
-    if (debug) Rprintf("%d\n", unk8);
-
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit); // interpreted as sas release ?
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // data representation 1 linux ?
-    if (debug) Rprintf("%d\n", unk8);
-    encoding = readbin(encoding, sas, swapit); // file encoding?
-    if (debug) Rprintf("%d\n", encoding);
-    enc = SASEncoding(encoding);
-    unk8 = readbin(unk8, sas, swapit); // sys encoding?
-    if (debug) Rprintf("%d\n", unk8);
-
-
-    if (debug) Rcout << " ---- block ---- " << sas.tellg()  << std::endl;
-    /* begin block of 4 ----------------------------------------------------- */
-    unk8 = readbin(unk8, sas, swapit); // 0
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 16 | 32: PAGE_BIT_OFFSET?
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 3
-    if (debug) Rprintf("%d\n", unk8);
-    unk8 = readbin(unk8, sas, swapit); // 1
-    if (debug) Rprintf("%d\n", unk8);
-
-
-    // o80
-    unk32 = readbin(unk32, sas, swapit); // 0
-    // Rprintf("%d\n", unk32);
-
-    unk32 = readbin(unk32, sas, swapit); // 0
-    // Rprintf("%d\n", unk32);
-
-
-    // o84 SAS FILE
-    sasfile = readstring(sasfile, sas);
-    if (debug) Rcout << sasfile << std::endl;
-
-    // o92 dataset name
-    dataset = readstring(dataset, sas);
-    dataset = std::regex_replace(dataset, std::regex(" +$"), "$1");
-    if (debug) Rcout << dataset << std::endl;
-
-    // o156 filetype 'DATA    '
-    filetype = readstring(filetype, sas);
-    filetype = std::regex_replace(filetype, std::regex(" +$"), "$1");
-    if (debug) Rcout << filetype << std::endl;
-
-    if (ALIGN_2_VALUE == 4) {
-      unk32 = readbin(unk32, sas, swapit);
-      if (debug) Rcout << unk32 << std::endl;
-    }
-
-    created = readbin(created, sas, swapit);
-    if (debug) Rcout << created << std::endl;
+inline int col_class(const std::string& cls)
+{
+  if (cls == "numeric" || cls == "double") return CC_NUMERIC;
+  if (cls == "integer") return CC_INTEGER;
+  if (cls == "logical") return CC_LOGICAL;
+  if (cls == "integer64") return CC_INTEGER64;
+  if (cls == "character") return CC_CHARACTER;
+  if (cls == "skip" || cls == "NULL") return CC_SKIP;
+  stop("unknown column class: %s", cls);
+}
 
-    modified = readbin(modified, sas, swapit);
-    if (debug) Rcout << modified << std::endl;
+const int64_t NA_INTEGER64 = std::numeric_limits<int64_t>::min();
+
+// factor of a column with a user defined format. The levels are the labels of
+// the format, followed by values without label in order of appearance.
+// Missings without label are NA.
+struct FormatFactor {
+  SasFormatLookup lookup;
+  std::vector<int> level;  // level of each label, from 1
+  std::vector<std::string> levels;
+  size_t nlabels = 0;      // levels of the format, UTF-8
+  std::unordered_map<std::string, int> str_levels;
+  std::unordered_map<uint64_t, int> num_levels; // values without label
+  char buf[32];
+
+  explicit FormatFactor(const SasFormat& fmt) : lookup(fmt) {
+    for (auto& label : fmt.labels)
+      level.push_back(add(label));
+    nlabels = levels.size();
+  }
 
-    created2 = readbin(created2, sas, swapit);
-    if (debug) Rcout << created2 << std::endl;
+  int add(const std::string& name) {
+    auto it = str_levels.emplace(name, (int)levels.size() + 1);
+    if (it.second) levels.push_back(name);
+    return it.first->second;
+  }
 
-    modified2 = readbin(modified2, sas, swapit);
-    if (debug) Rcout << modified2 << std::endl;
+  int num(double x) {
+    int64_t pos = lookup.find(x);
+    if (pos >= 0) return level[pos];
+    if (std::isnan(x)) return NA_INTEGER;
+
+    if (x == 0) x = 0;
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    auto it = num_levels.find(bits);
+    if (it != num_levels.end()) return it->second;
+
+    // a label may read like the value, levels are unique
+    std::snprintf(buf, sizeof(buf), "%.15g", x);
+    int lev = add(buf);
+    num_levels.emplace(bits, lev);
+    return lev;
+  }
 
-    uint32_t headersize = 0;
-    headersize = readbin(headersize, sas, swapit);
-    if (debug) Rcpp::Rcout << "headersize: " << headersize << std::endl;
-    if (headersize <= 0) stop("headersize <= 0");
+  int str(const char* p, size_t len) {
+    int64_t pos = lookup.find(p, len);
+    if (pos >= 0) return level[pos];
+    if (len == 0) return NA_INTEGER;
 
-    uint32_t pagesize = 0;
-    pagesize = readbin(pagesize, sas, swapit);
-    if (debug) Rcpp::Rcout << "pagesize: " << pagesize << std::endl;
-    if (pagesize <= 0) stop("pagesize <= 0");
+    return add(std::string(p, len));
+  }
+};
+
+// writes decoded cells directly into R vectors. Numerics are written as
+// double, integer, logical or integer64 (int64 stored in a double) and
+// character digits can be parsed into numbers. Narrowed columns start as
+// integer and are widened to double on the first value that does not fit.
+struct RSink {
+  std::vector<double*> dbl;
+  std::vector<int*> ints;
+  std::vector<int64_t*> i64;
+  std::vector<SEXP> chr;
+  std::vector<int> cls;
+  std::vector<bool> narrow;
+  std::vector<std::unique_ptr<FormatFactor>> factor;
+  SasSpecial special;
+  SEXP df;
+  size_t nn;
+  std::vector<bool>& valid;
+  bool convert, empty_to_na, debug;
+  int64_t coerced = 0;
+  std::string tmp;
+
+  RSink(size_t kk, size_t nn, SEXP df, std::vector<bool>& valid,
+        bool convert, bool empty_to_na, bool debug)
+    : dbl(kk, nullptr), ints(kk, nullptr), i64(kk, nullptr),
+      chr(kk, R_NilValue), cls(kk, CC_DEFAULT), narrow(kk, false),
+      factor(kk), special(kk), df(df),
+      nn(nn), valid(valid), convert(convert),
+      empty_to_na(empty_to_na), debug(debug) {}
+
+  // a narrowed column received a value that is not an integer
+  void widen(size_t j, size_t i) {
+    SEXP vec = PROTECT(Rf_allocVector(REALSXP, nn));
+    double* d = REAL(vec);
+    for (size_t k = 0; k < i; ++k)
+      d[k] = ints[j][k] == NA_INTEGER ? NA_REAL : ints[j][k];
+    SET_VECTOR_ELT(df, j, vec);
+    UNPROTECT(1);
+
+    dbl[j] = d;
+    ints[j] = nullptr;
+    narrow[j] = false;
+  }
 
-    int64_t pagecount = 0;
-    if (u64 == 4) {
-      pagecount = readbin(pagecount, sas, swapit);
-    } else {
-      pagecount = readbin((int32_t)pagecount, sas, swapit);
+  void num(size_t i, size_t j, double val_d) {
+    // labels of missings are found by their code
+    if (factor[j]) {
+      ints[j][i] = factor[j]->num(val_d);
+      if (ints[j][i] == NA_INTEGER && std::isnan(val_d))
+        special.add(j, i, val_d, false);
+      return;
     }
-    if (debug)
-      Rcpp::Rcout << "pagecount: " << pagecount << std::endl;
-
-    /*
-     * theoretically every page contains data and/or varnames. practically
-     * this must not be true. 1024 does not contain data, only varnames. 512
-     * might contain both or only varnames.
-     */
-
-    std::vector<uint64_t> data_pos(pagecount, 0);
-    std::vector<uint64_t> varname_pos;
-    std::vector<uint64_t> label_pos;
-    std::vector<int64_t>  rowsperpage(pagecount, 0);
-
-    unkdub = readbin(unkdub, sas, swapit); // 0
-    if (debug) Rcout << unkdub << std::endl;
-
-    sasrel = readstring(sasrel, sas);
-    if (debug) Rcout << "SAS release: " << sasrel << std::endl;
-
-    sasserv = readstring(sasserv, sas);
-    if (debug) Rcout << "SAS server: " << sasserv << std::endl;
-
-    // osversion
-    osver = readstring(osver, sas);
-    if (debug) Rcout << "OS ver: " <<  osver << std::endl;
-
-    // osmaker
-    osmaker = readstring(osmaker, sas);
-    if (debug) Rcout << "OS maker: " << osmaker << std::endl; // eg WIN
-
-    // osname
-    osname = readstring(osname, sas); // x86_64
-    if (debug) Rcout << "OS name: " << osname << std::endl;
-
-    uint32_t uunk32 = 0;
-
-    // unk
-    uunk32 = readbin(uunk32, sas, swapit);
-    if (debug) Rcout << uunk32 << std::endl;
-
-    // three identical unks
-    uunk32 = readbin(uunk32, sas, swapit);
-    if (debug) Rcout << uunk32 << std::endl;
-    uunk32 = readbin(uunk32, sas, swapit);
-    if (debug) Rcout << uunk32 << std::endl;
-    uunk32 = readbin(uunk32, sas, swapit);
-    if (debug) Rcout << uunk32 << std::endl;
-
-    unkdub = readbin(unkdub, sas, swapit); // 0
-    if (debug) Rcout << unkdub << std::endl;
-    unkdub = readbin(unkdub, sas, swapit); // 0
-    if (debug) Rcout << unkdub << std::endl;
-
-    // Rcout << sas.tellg() << std::endl;
-
-    // page seq num at 320|328
-    pageseqnum32 = readbin(pageseqnum32, sas, swapit);
-    if (debug) Rcout << "pageseqnum: " << pageseqnum32 << std::endl;
-
-    unk32 = readbin(unk32, sas, swapit); // 0 padding?
-    if (debug) Rprintf("unk32: %d \n", unk32);
-
-    // 3rd timestamp ? 0
-    double thrdts = 0;
-    thrdts = readbin(thrdts, sas, swapit);
-    if (debug) Rcout << "3. TS " << thrdts << std::endl;
 
-    // rest is filled with zeros. read it anyway.
-    uint64_t num_zeros = headersize - sas.tellg();
-
-    for (uint64_t i = 0; i < num_zeros; ++i) {
-      int8_t zero = 0;
-      zero = readbin(zero, sas, swapit);
-      if (zero!=0 && debug)
-        warning("debug: expected 0, is %d", zero);
+    if (std::isnan(val_d)) {
+      special.add(j, i, val_d, convert);
+      val_d = check_na(val_d, convert, debug);
     }
 
-    // debug
-    int64_t pagestart = sas.tellg();
-    if (debug) Rcpp::Rcout << "position: " << pagestart << std::endl;
-
-    // end of Header ---------------------------------------------------------//
-
-
-    uint8_t alignval = 8;
-    if (u64 != 4) alignval = 4;
-
-
-    uint64_t rowlength = 0, delobs = 0;
-    int64_t colf_p1 = 0, colf_p2 = 0;
-    int64_t n = 0, k = 0;
-    std::vector<std::string> stringvec(pagecount) ;
-
-    auto totalrows = 0;
-    std::vector<uint32_t> totalrowsvec(pagecount);
-    std::vector<uint32_t> pageseqnum(pagecount);
-
-    std::vector<std::string> pagedelmarker(pagecount);
-
-    int8_t PAGE_BIT_OFFSET = 0;
-    int8_t SUBHEADER_POINTER_LENGTH = 0;
-    int8_t SUBHEADER_POINTERS_OFFSET = 8;
-
-    if (u64 == 4) {
-      PAGE_BIT_OFFSET = 32;
-      SUBHEADER_POINTER_LENGTH = 24;
-    } else {
-      PAGE_BIT_OFFSET = 16;
-      SUBHEADER_POINTER_LENGTH = 12;
+    if (narrow[j]) {
+      if (ISNAN(val_d)) {
+        ints[j][i] = NA_INTEGER;
+        return;
+      }
+      if (val_d == std::trunc(val_d) && std::fabs(val_d) <= INT_MAX) {
+        ints[j][i] = (int)val_d;
+        return;
+      }
+      widen(j, i);
     }
 
-    uint64_t pre_pagenumx = 0;
-    uint64_t pagenumx = 0;
-
-    // begin reading pages ---------------------------------------------------//
-    for (auto pg = 0; pg < pagecount; ++pg) {
-      checkUserInterrupt();
-
-      // Rcout << "--- new page ------------------------------------" << std::endl;
-
-      /* should already be at this position for pg == 1 */
-      if (pagecount > 0) {
-        pre_pagenumx = pagenumx;
-        pagenumx = headersize + (double)pg * pagesize;
-
-        sas.seekg(pagenumx, sas.beg);
+    put(i, j, val_d);
+  }
 
-        if (pagenumx <= pre_pagenumx)
-          stop("pagenumx did not increase");
+  // store a double in the class of column j
+  void put(size_t i, size_t j, double val_d) {
+    switch (cls[j]) {
+    case CC_INTEGER:
+      if (ISNAN(val_d)) {
+        ints[j][i] = NA_INTEGER;
+      } else if (std::fabs(val_d) < 2147483648.0 && val_d > INT_MIN) {
+        ints[j][i] = (int)val_d;
+      } else {
+        ints[j][i] = NA_INTEGER;
+        ++coerced;
       }
-
-      int64_t unk1 = 0, unk2 = 0;
-      int32_t c5typ = 0; /* check if variable name, format or label */
-      int64_t PAGE_DELETED_POINTER_LENGTH = 0;
-
-      // Page Offset Table
-      if (u64 == 4) {
-        pageseqnum32 = readbin(pageseqnum32, sas, swapit);
-        unk32 = readbin(unk32, sas, swapit);
-        unk1 = readbin(unk1, sas, swapit);
-        unk2 = readbin(unk2, sas, swapit);
-        PAGE_DELETED_POINTER_LENGTH = readbin(PAGE_DELETED_POINTER_LENGTH, sas, swapit);
+      break;
+    case CC_LOGICAL:
+      ints[j][i] = ISNAN(val_d) ? NA_LOGICAL : val_d != 0;
+      break;
+    case CC_INTEGER64:
+      if (ISNAN(val_d)) {
+        i64[j][i] = NA_INTEGER64;
+      } else if (std::fabs(val_d) < 9223372036854775808.0 &&
+                 val_d > (double)NA_INTEGER64) {
+        i64[j][i] = (int64_t)val_d;
       } else {
-        pageseqnum32 = readbin(pageseqnum32, sas, swapit);
-        unk1 = readbin((int32_t)unk1, sas, swapit);
-        unk2 = readbin((int32_t)unk2, sas, swapit);
-        PAGE_DELETED_POINTER_LENGTH = readbin((int32_t)PAGE_DELETED_POINTER_LENGTH, sas, swapit);
+        i64[j][i] = NA_INTEGER64;
+        ++coerced;
       }
+      break;
+    default:
+      dbl[j][i] = val_d;
+    }
+  }
 
-      pageseqnum[pg] = pageseqnum32;
-
-      PAGE_TYPE       = readbin(PAGE_TYPE, sas, swapit);
-      BLOCK_COUNT     = readbin(BLOCK_COUNT, sas, swapit);
-      SUBHEADER_COUNT = readbin(SUBHEADER_COUNT, sas, swapit);
-      unk16           = readbin(unk16, sas, swapit);
-
-      page_type.push_back(PAGE_TYPE);
-
-      rowsperpage[pg] = BLOCK_COUNT - SUBHEADER_COUNT;
-      totalrows += rowsperpage[pg];
-      totalrowsvec[pg] = totalrows;
-
-      if (debug)
-        Rprintf("PAGE_TYPE: %d ; BC: %d ; SC: %d ; unk16: %d ---- \n",
-                PAGE_TYPE, BLOCK_COUNT, SUBHEADER_COUNT, unk16);
-
-      int16_t zero = 0;
-      // int64_t sh_tot_len = 0;
-      uint64_t dataoff = 0;
-
-      std::vector<PO_Tab> potabs(SUBHEADER_COUNT);
-
-
-      if ((
-          PAGE_TYPE == 16384 ||                   // PAGE_META_TYPE_2
-            PAGE_TYPE == 1024 ||                    // PAGE_AMD_TYPE
-            PAGE_TYPE == 640 || PAGE_TYPE == 512 || // PAGE_MIX_TYPE_2   PAGE_MIX_TYPE_1
-            PAGE_TYPE == 384 || PAGE_TYPE == 256 || // PAGE_DATA_TYPE_2  PAGE_DATA_TYPE
-            PAGE_TYPE == 128 ||                     // PAGE_CMETA_TYPE
-            PAGE_TYPE == 0))                        // PAGE_META_TYPE_1
-      {
-
-        for (auto i = 0; i < SUBHEADER_COUNT; ++i) {
-
-          if (u64 == 4) {
-
-            potabs[i].SH_OFF = readbin(potabs[i].SH_OFF, sas, swapit);           // 8
-            potabs[i].SH_LEN = readbin(potabs[i].SH_LEN, sas, swapit);           // 16
-            potabs[i].COMPRESSION = readbin(potabs[i].COMPRESSION, sas, swapit); // 20
-            potabs[i].SH_TYPE = readbin(potabs[i].SH_TYPE, sas, swapit);         // 24
-
-            zero = readbin(zero, sas, swapit);
-            // Rcout << zero << std::endl;
-            zero = readbin(zero, sas, swapit);
-            // Rcout << zero << std::endl;
-            zero = readbin(zero, sas, swapit);
-            // Rcout << zero << std::endl;
-
-          } else {
-
-            potabs[i].SH_OFF = readbin((uint32_t)potabs[i].SH_OFF, sas, swapit); // 4
-            potabs[i].SH_LEN = readbin((uint32_t)potabs[i].SH_LEN, sas, swapit); // 8
-            potabs[i].COMPRESSION = readbin(potabs[i].COMPRESSION, sas, swapit); // 10
-            potabs[i].SH_TYPE = readbin(potabs[i].SH_TYPE, sas, swapit);         // 12
-
-            zero = readbin(zero, sas, swapit);
-            // Rcout << zero << std::endl;
-          }
-
-          if (debug)
-            Rcpp::Rcout << "SH_OFF: " << potabs[i].SH_OFF
-                        << "SH_LEN: " << potabs[i].SH_LEN
-                        << "COMPR.: " << potabs[i].COMPRESSION
-                        << "SH_TYPE: " << potabs[i].SH_TYPE << std::endl;
-
-          dataoff = potabs[i].SH_OFF - ((double)rowsperpage[pg] * rowlength);
-
-        }
-
-        if (debug) {
-          Rcout << "data offset " << dataoff << std::endl;
-          Rcout << "data offset ------------------------------- " << std::endl;
-        }
-
-        uint64_t sh_end_pos = 0;
-
-        if (PAGE_TYPE != 0) sh_end_pos = sas.tellg();
-
-        data_pos[pg] = sh_end_pos;
-
-        if (debug)
-          // Rprintf("sh_end_pos: %d\n", sh_end_pos);
-          Rcout << "sh_end_pos: " << sh_end_pos << std::endl;
-
-
-        // from now on, we will seek to every position inside the sas file
-        for (auto sc = 0; sc < SUBHEADER_COUNT; ++sc)
-        {
-
-          if (debug)
-            Rcout << "Subheader Count: " << sc << std::endl;
-
-          uint64_t pagepos = (headersize + (double)pg * pagesize) + potabs[sc].SH_OFF;
-
-          // 2 files, where this is a problem
-          if(potabs[sc].SH_OFF == 0 || potabs[sc].SH_LEN == 0)
-            break;
-
-          sas.seekg(pagepos, sas.beg);
-
-          // not sure yet, whats the right thing to do here
-          bool page0not = 0;
-          if ((pg == 0) && (sc != 3))
-            page0not = (PAGE_TYPE == 0) &&  (potabs[sc].SH_LEN == rowlength);
-
-          // there can be uncompressed rows in the data
-          if (potabs[sc].COMPRESSION == 0 && potabs[sc].SH_TYPE == 1 && potabs[sc].SH_LEN == rowlength && compr > 0) {
-
-            if (debug)
-              Rcout << "-------- case 0 "<< sas.tellg()  << std::endl;
-
-            std::string ustr(rowlength, '\0');
-            ustr = readstring(ustr, sas);
-            writestr(ustr, ustr.size(), out);
-            continue;
-          }
-
-          int64_t sas_offset = alignval;
-          if (! ((potabs[sc].COMPRESSION == 4) |
-              (PAGE_TYPE == -28672) | page0not ) ) {
-            if (u64 == 4) {
-              sas_offset = readbin(sas_offset, sas, swapit);
-            } else {
-              sas_offset = readbin((int32_t)sas_offset, sas, swapit);
-            }
-          }
-
-          std::string sas_hex = int_to_hex(sas_offset);
-
-          if (debug)
-            Rcout << "SAS Hex: " << sas_hex << std::endl;
-
-          auto sas_offset_table = 0;
-          if (sas_hex.compare("f7f7f7f7") == 0 ||
-              sas_hex.compare("fffffffff7f7f7f7") == 0 ||
-              sas_hex.compare("f7f7f7f700000000") == 0 ||
-              sas_hex.compare("f7f7f7f7fffffbfe") == 0 )
-            sas_offset_table = 1;
-          if (sas_hex.compare("fffffc00") == 0 ||
-              sas_hex.compare("fffffffffffffc00") == 0 )
-            sas_offset_table = 2;
-          if (sas_hex.compare("fffffbfe") == 0 ||
-              sas_hex.compare("fffffffffffffbfe") == 0)
-            sas_offset_table = 3;
-          if (sas_hex.compare("f6f6f6f6") == 0 ||
-              sas_hex.compare("fffffffff6f6f6f6") == 0 ||
-              sas_hex.compare("f6f6f6f600000000") == 0 ||
-              sas_hex.compare("f6f6f6f6fffffbfe") == 0 )
-            sas_offset_table = 4;
-          if (sas_hex.compare("fffffffd") == 0 ||
-              sas_hex.compare("fffffffffffffffd") == 0)
-            sas_offset_table = 5;
-          if (sas_hex.compare("ffffffff") == 0 ||
-              sas_hex.compare("ffffffffffffffff") == 0)
-            sas_offset_table = 6;
-          if (sas_hex.compare("fffffffc") == 0 ||
-              sas_hex.compare("fffffffffffffffc") == 0)
-            sas_offset_table = 7;
-          if (sas_hex.compare("fffffffe") == 0 ||
-              sas_hex.compare("fffffffffffffffe") == 0)
-            sas_offset_table = 8;
-          if (potabs[sc].COMPRESSION == 4)
-            sas_offset_table = 9;
-          if (page0not)
-            sas_offset_table = 10;
-
-
-          switch(sas_offset_table)
-          {
-
-            // new offset --------------------------------------------------- //
-          case 1:
-            {
-
-              /* Row Size */
-
-              int16_t pgwpossh = 0, pgwpossh2 = 0, numzeros = 37,
-                sh_num = 0, cn_maxlen = 0, l_maxlen = 0,
-                rowsonpg = 0;
-              int32_t pgidx = 0;
-              int64_t pgsize = 0, pgc = 0, rcmix = 0, pgwsh = 0, pgwsh2 = 0;
-
-              if (debug)
-                Rcout << "-------- case 1 "<< sas.tellg() << std::endl;
-
-
-
-              if (u64 == 4) {
-
-                /* */
-
-
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl;
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl;
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl;
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl;
-
-                rowlength = readbin(rowlength, sas, swapit);
-                if (debug) Rcout << "rowlength " << rowlength << std::endl;
-                n = readbin(n, sas, swapit);
-                if (debug) Rcout << "n " << n << std::endl;
-                delobs = readbin(delobs, sas, swapit);
-                if (debug) Rcout << "delobs " << delobs << std::endl;
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl;
-
-                colf_p1 = readbin(colf_p1, sas, swapit);
-                if (debug) Rcout << colf_p1 << std::endl;
-                colf_p2 = readbin(colf_p2, sas, swapit);
-                if (debug) Rcout << colf_p2 << std::endl;
-                unk64 = readbin(unk64, sas, swapit); // p3 and p4?
-                if (debug) Rcout << unk64 << std::endl;
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl;
-                pgsize = readbin(pgsize, sas, swapit);
-                unk64 = readbin(unk64, sas, swapit);
-                rcmix =  readbin(rcmix, sas, swapit);
-
-                /* next two indicate the end of the initial header ? */
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl; // -1
-                unk64 = readbin(unk64, sas, swapit);
-                if (debug) Rcout << unk64 << std::endl; // -1
-
-                for (int z = 0; z < numzeros; ++z) {
-                  unk64 = readbin(unk64, sas, swapit);
-                  if (unk64 != 0)
-                    warning("val is %d. expected a zero", unk64);
-                }
-
-                pgidx = readbin(pgidx, sas, swapit);
-
-                // padding? 68 bytes: zeros
-                for (int z = 0; z < 8; ++z) {
-                  unk64 = readbin(unk64, sas, swapit);
-                  if (unk64 != 0)
-                    warning("val0 is %d. expected a zero", unk64);
-                }
-                unk32 = readbin(unk32, sas, swapit);
-
-                unk64 = readbin(unk64, sas, swapit); // val 1?
-                unk16 = readbin(unk16, sas, swapit); // val 2?
-
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-
-                pgwsh = readbin(pgwsh, sas, swapit);
-                pgwpossh = readbin(pgwpossh, sas, swapit);
-
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-
-                pgwsh2 = readbin(pgwsh2, sas, swapit);
-                pgwpossh2 = readbin(pgwpossh2, sas, swapit);
-
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-
-                pgc = readbin(pgc, sas, swapit);
-
-                unk16 = readbin(unk16, sas, swapit); // val ?
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-
-                unk64 = readbin(unk64, sas, swapit); // val 1?
-
-                addtextoff = readbin(addtextoff, sas, swapit); // val 7 | 8?
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-                unk16 = readbin(unk16, sas, swapit); // padding
-
-                for (int z = 0; z < 10; ++z) {
-                  unk64 = readbin(unk64, sas, swapit); // 0
-                  if (unk64 != 0 && debug)
-                    warning("val1 is %d. expected a zero", unk64);
-                }
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // val
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 0|8 ?
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 4
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 0
-                if (debug) Rcout << unk16 << std::endl;
-                todata = readbin(unk16, sas, swapit); // val 12,32|0?
-                if (debug) Rcout << todata << std::endl;
-
-                if (todata == 12)
-                  hasproc = false;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                swlen = readbin(swlen, sas, swapit);
-                if (debug) Rcout << swlen << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 0
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 20 | 28
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 8
-                if (debug) Rcout << unk16 << std::endl;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // 0
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 12
-                if (debug) Rcout << unk16 << std::endl;
-                comprlen = readbin(unk16, sas, swapit); // 8
-                if (debug) Rcout << comprlen << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 0
-                if (debug) Rcout << unk16 << std::endl;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // 12 | 20
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 8
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 0
-                if (debug) Rcout << unk16 << std::endl;
-                textoff = readbin(textoff, sas, swapit); // 28 | 36
-                if (debug) Rcout << textoff << std::endl;
-                proclen = readbin(proclen, sas, swapit);
-                if (debug) Rcout << "proclen " << proclen << std::endl;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                for (int z = 0; z < 8; ++z) {
-                  unk32 = readbin(unk32, sas, swapit); // 0
-                  if (unk64 != 0)
-                    warning("val2 is %d. expected a zero", unk64);
-                }
-
-                unk16 = readbin(unk16, sas, swapit); // 4
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 1
-                if (debug) Rcout << unk16 << std::endl;
-
-                sh_num = readbin(sh_num, sas, swapit);
-                if (debug) Rcout << sh_num << std::endl;
-                cn_maxlen = readbin(cn_maxlen, sas, swapit);
-                if (debug) Rcout << cn_maxlen << std::endl;
-                l_maxlen = readbin(l_maxlen, sas, swapit);
-                if (debug) Rcout << l_maxlen << std::endl;
-
-                /* maybe SAS version information at o131018 ? */
-                unk32 = readbin(unk32, sas, swapit); // 1
-                // Rcout << "1 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 2
-                // if (unk32 != 0) stop("unk32 1. expected 0 is %d", unk32);
-                unk32 = readbin(unk32, sas, swapit); // 3
-                // if (unk32 != 0) stop("unk32 1. expected 0 is %d", unk32);
-
-                rowsonpg = readbin(rowsonpg, sas, swapit);
-
-
-                unk16 = readbin(unk16, sas, swapit); // 1
-                if (unk16 != 0) stop("unk16 01. expected 0 is %d", unk16);
-                unk32 = readbin(unk32, sas, swapit); // 2
-                // Rcout << "2 " << unk32 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 4
-                if (unk16 != 0) stop("unk16 04. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 5
-                if (unk16 != 0) stop("unk16 05. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 6
-                if (unk16 != 0) stop("unk16 06. expected 0 is %d", unk16);
-                unk32 = readbin(unk32, sas, swapit); // 7
-                // Rcout << "7 " << unk32 << std::endl; // nrows
-                unk16 = readbin(unk16, sas, swapit); // 9
-                if (unk16 != 0) stop("unk16 09. expected 0 is %d", unk16);
-                unk32 = readbin(unk32, sas, swapit); // 10
-                // Rcout << "10 "<< unk32 << std::endl; // delobs
-                unk16 = readbin(unk16, sas, swapit); // 12
-                if (unk16 != 0) stop("unk16 12. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 13
-                if (unk16 != 0) stop("unk16 13. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 14
-                if (unk16 != 0) stop("unk16 14. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 15
-                if (unk16 != 0) stop("unk16 15. expected 0 is %d", unk16);
-                dataoffset = readbin(dataoffset, sas, swapit); // 16
-                // Rcout << dataoffset << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 17
-                if (unk16 != 0) stop("unk16 17. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit);// 18
-                if (unk16 != 0) stop("unk16 18. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 19
-                if (unk16 != 0) stop("unk16 19. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 20
-                if (unk16 != 0) stop("unk16 20. expected 0 is %d", unk16);
-
-
-                /* */
-
-              } else {
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-
-                rowlength = readbin((int32_t)rowlength, sas, swapit);
-                if (debug) Rcout << "rowlength " << rowlength << std::endl;
-                n = readbin((int32_t)n, sas, swapit);
-                if (debug) Rcout << "rowcount " << n << std::endl;
-                delobs = readbin((int32_t)delobs, sas, swapit); // deleted obs?
-                if (debug) Rcout << "delobs " << delobs << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                colf_p1 = readbin((int32_t)colf_p1, sas, swapit);
-                if (debug) Rcout << "colfp1 " << colf_p1 << std::endl;
-                colf_p2 = readbin((int32_t)colf_p2, sas, swapit);
-                if (debug) Rcout << "colfp2 " << colf_p2 << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                pgsize = readbin((int32_t)pgsize, sas, swapit);
-                if (debug) Rcout << "pgsize " << pgsize << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                rcmix =  readbin((int32_t)rcmix, sas, swapit);
-                if (debug) Rcout << "rcmix " << rcmix << std::endl;
-                uunk32 = readbin(uunk32, sas, swapit);
-                if (debug) Rcout << uunk32 << std::endl;
-                uunk32 = readbin(uunk32, sas, swapit);
-                if (debug) Rcout << uunk32 << std::endl;
-
-                for (int z = 0; z < numzeros; ++z) {
-                  unk64 = readbin((int32_t)unk64, sas, swapit);
-                  if (unk64 != 0 && debug)
-                    warning("val1 is %d. expected a zero", unk64);
-                }
-
-                pgidx = readbin(pgidx, sas, swapit);
-
-
-                for (int z = 0; z < 8; ++z) {
-                  unk64 = readbin((int32_t)unk64, sas, swapit);
-                  if (debug) Rcout << unk64 << std::endl;
-                }
-
-                // padding?
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                if (debug) Rcout << unk32 << std::endl;
-
-                unk32 = readbin(unk32, sas, swapit); // val 1?
-                if (debug) Rcout << unk32 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 2?
-                if (debug) Rcout << unk16 << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // padding
-                if (debug) Rcout << unk16 << std::endl;
-
-                pgwsh = readbin((int32_t)pgwsh, sas, swapit);
-                if (debug) Rcout << "pgwsh " << pgwsh << std::endl;
-                pgwpossh = readbin(pgwpossh, sas, swapit);
-                if (debug) Rcout << "pgwpossh " << pgwpossh << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // padding
-                if (debug) Rcout << unk16 << std::endl;
-
-                pgwsh2 = readbin((int32_t)pgwsh2, sas, swapit);
-                if (debug) Rcout << "pgwsh2 " << pgwsh2 << std::endl;
-                pgwpossh2 = readbin(pgwpossh2, sas, swapit);
-                if (debug) Rcout << "pgwpossh2 " << pgwpossh2 << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // padding
-                if (debug) Rcout << unk16 << std::endl;
-
-                pgc = readbin((int32_t)pgc, sas, swapit);
-                if (debug) Rcout << "pgc " << pgc << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // val ?
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // padding
-
-                unk64 = readbin((int32_t)unk64, sas, swapit); // val 1?
-                if (debug) Rcout << unk64 << std::endl;
-
-                addtextoff = readbin(addtextoff, sas, swapit); // val 7 | 8?
-                if (debug) Rcout << addtextoff << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // padding
-
-                for (int z = 0; z < 10; ++z) {
-                  unk64 = readbin((int32_t)unk64, sas, swapit); // 0
-                  if (unk64 != 0)
-                    warning("val2 is %d. expected a zero", unk64);
-                }
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // val
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 0|8 ?
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 4
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 0
-                if (debug) Rcout << unk16 << std::endl;
-                todata = readbin(todata, sas, swapit); // val 12,32|0? //
-                if (debug) Rcout << todata << std::endl;
-
-                if (todata == 12)
-                  hasproc = false;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                swlen = readbin(swlen, sas, swapit);
-                if (debug) Rcout << "swlen " << swlen << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 0?
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // val 20?
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); //
-                if (debug) Rcout << unk16 << std::endl;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // 0
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 12
-                if (debug) Rcout << unk16 << std::endl;
-                comprlen = readbin(unk16, sas, swapit); // 8 compr. code length?
-                if (debug) Rcout << comprlen << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 0
-                if (debug) Rcout << unk16 << std::endl;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // 12
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 8
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 0
-                if (debug) Rcout << unk16 << std::endl;
-                textoff = readbin(textoff, sas, swapit); // 28
-                if (debug) Rcout << textoff << std::endl;
-                proclen = readbin(proclen, sas, swapit);
-                if (debug) Rcout << "proclen " << proclen << std::endl;
-
-                if (debug) Rcout << "###############" << std::endl;
-
-
-                unk32 = readbin(unk32, sas, swapit); // 1
-                // Rcout << "1 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 2
-                // Rcout << "2 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 3
-                // Rcout << "3 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 4
-                // Rcout << "4 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 5
-                // Rcout << "5 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 6
-                // Rcout << "6 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 7
-                // Rcout << "7 " << unk32 << std::endl;
-                unk32 = readbin(unk32, sas, swapit); // 8
-                // Rcout << "8 " << unk32 << std::endl;
-
-                unk16 = readbin(unk16, sas, swapit); // 4
-                if (debug) Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 1
-                if (debug) Rcout << unk16 << std::endl;
-
-                sh_num = readbin(sh_num, sas, swapit);
-                if (debug) Rcout << sh_num << std::endl;
-                cn_maxlen = readbin(cn_maxlen, sas, swapit);
-                if (debug) Rcout << cn_maxlen << std::endl;
-                l_maxlen = readbin(l_maxlen, sas, swapit);
-                if (debug) Rcout << l_maxlen << std::endl;
-
-                for (int z = 0; z < 3; ++z) {
-                  unk32 = readbin(unk32, sas, swapit); // 0
-                }
-
-                rowsonpg = readbin(rowsonpg, sas, swapit);
-
-
-                unk16 = readbin(unk16, sas, swapit); // 1
-                if (unk16 != 0) stop("unk16 01. expected 0 is %d", unk16);
-                unk32 = readbin(unk32, sas, swapit); // 2
-                // Rcout << "2 " << unk32 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 4
-                if (unk16 != 0) stop("unk16 04. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 5
-                if (unk16 != 0) stop("unk16 05. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 6
-                if (unk16 != 0) stop("unk16 06. expected 0 is %d", unk16);
-                unk32 = readbin(unk32, sas, swapit); // 7
-                // Rcout << "7 " << unk32 << std::endl; // nrows
-                unk16 = readbin(unk16, sas, swapit); // 9
-                if (unk16 != 0) stop("unk16 09. expected 0 is %d", unk16);
-                unk64 = readbin((int32_t)unk64, sas, swapit); // 10
-                if (debug) Rcout << "delobs "<< unk64 << std::endl; // delobs?
-                // if (unk16 != 0) stop("unk16 11. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 12
-                if (unk16 != 0) stop("unk16 12. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 13
-                if (unk16 != 0) stop("unk16 13. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 14
-                if (unk16 != 0) stop("unk16 14. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 15
-                if (unk16 != 0) stop("unk16 15. expected 0 is %d", unk16);
-                dataoffset = readbin(dataoffset, sas, swapit); // 16
-                // Rcout << dataoffset << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 17
-                if (unk16 != 0) stop("unk16 17. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit);// 18
-                if (unk16 != 0) stop("unk16 18. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 19
-                if (unk16 != 0) stop("unk16 19. expected 0 is %d", unk16);
-                unk16 = readbin(unk16, sas, swapit); // 20
-                if (unk16 != 0) stop("unk16 20. expected 0 is %d", unk16);
-              }
-
-              if (debug)
-                Rprintf("swlen = %d, todata %d, textoff %d\n",
-                        swlen, todata, textoff);
-
-
-              if (!((dataoffset == 1) ||(dataoffset == 256) || (dataoffset == 1280)))
-                warning("debug: dataoffset is unexpectedly %d\n",
-                        dataoffset);
-
-              break;
-            }
-
-
-
-            // new offset --------------------------------------------------- //
-          case 2:
-            {
-
-              if (debug)
-                Rcout << "-------- case 2 "<< sas.tellg() << std::endl;
-
-              int64_t off = 0;
-
-              if (u64 == 4) {
-                off = readbin(off, sas, swapit);
-                // Rcout << off << std::endl;
-                unk64 = readbin(unk64, sas, swapit);
-                // Rcout << unk64 << std::endl;
-              } else {
-                off = readbin((int32_t)off, sas, swapit);
-                // Rcout << off << std::endl;
-                unk32 = readbin(unk32, sas, swapit);
-                // Rcout << unk32 << std::endl;
-              }
-
-              int16_t num_nonzero = 0;
-              num_nonzero = readbin(num_nonzero, sas, swapit);
-              // Rcout << "numzeros " <<  num_nonzero << std::endl;
-
-              int8_t unklen = 94; // should be 94
-              if (u64 != 4) unklen = 50;
-              for (int jj = 0; jj < unklen/2; ++jj) {
-                unk16 = readbin(unk16, sas, swapit);
-                // 4th from the end is 1804 meaning is unknown
-              }
-
-              std::vector<SCV> scv(12);
-
-              for (int8_t i = 0; i < 12; ++i) {
-
-                if (u64 == 4) {
-                  scv[i].SIG = readbin(scv[i].SIG, sas, swapit);
-                  scv[i].FIRST = readbin(scv[i].FIRST, sas, swapit);
-                  scv[i].F_POS = readbin(scv[i].F_POS, sas, swapit);
-
-                  if ((i == 0) && (scv[i].SIG != -4))
-                    warning("first SIG is not -4");
-
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-
-                  scv[i].LAST = readbin(scv[i].LAST, sas, swapit);
-                  scv[i].L_POS = readbin(scv[i].L_POS, sas, swapit);
-
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-
-                } else {
-                  scv[i].SIG = readbin((int32_t)scv[i].SIG, sas, swapit);
-                  scv[i].FIRST = readbin((int32_t)scv[i].FIRST, sas, swapit);
-                  scv[i].F_POS = readbin(scv[i].F_POS, sas, swapit);
-
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-
-                  scv[i].LAST = readbin((int32_t)scv[i].LAST, sas, swapit);
-                  scv[i].L_POS = readbin(scv[i].L_POS, sas, swapit);
-
-                  unk16 = readbin(unk16, sas, swapit);
-                  // Rcout << unk16 << std::endl;
-                }
-
-                if (debug)
-                  Rcpp::Rcout << "Sig: " << scv[i].SIG
-                              << "FIRST " << scv[i].FIRST
-                              << "F_POS " << scv[i].F_POS
-                              << "LAST " << scv[i].LAST
-                              << "L_POS " << scv[i].L_POS
-                              << std::endl;
-
-              }
-
-              break;
-            }
-
-
-            // new offset --------------------------------------------------- //
-          case 3:
-            {
-
-              if (debug)
-                Rcout << "-------- case 3 "<< sas.tellg() << std::endl;
-
-              hasattributes = 1;
-
-              unk16 = readbin(unk16, sas, swapit);           // 1
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 2
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 3
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 4
-              // Rcout << unk16 << std::endl;
-              fmt32 = readbin(fmt32, sas, swapit);           // 5
-              // Rcout << fmt32 << std::endl;
-              fmt322 = readbin(fmt322, sas, swapit);         // 6
-              // Rcout << fmt322 << std::endl;
-              ifmt32 = readbin(ifmt32, sas, swapit);         // 7
-              // Rcout << ifmt32 << std::endl;
-              ifmt322 = readbin(ifmt322, sas, swapit);       // 8
-              // Rcout << ifmt322 << std::endl;
-              fmtkey = readbin(fmtkey, sas, swapit);         // 9
-              // Rcout << fmtkey << std::endl;
-              fmtkey2 = readbin(fmtkey2, sas, swapit);       // 10
-              // Rcout << fmtkey2 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 11
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 12
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 13
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 14 off + len
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit);           // 15 1 w char
-              // Rcout << unk16 << std::endl;
-
-              if (u64 == 4) {
-                unk16 = readbin(unk16, sas, swapit);
-                // Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit);
-                // Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit);
-                // Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit);
-                // Rcout << unk16 << std::endl;
-              }
-
-              fmt32s.push_back(  fmt32  + (double)fmt322/10);
-              ifmt32s.push_back( ifmt32 + (double)ifmt322/10);
-              fmtkeys.push_back( fmtkey + (double)fmtkey2/10);
-
-              idxofflen fmts, lbls, unks;
-
-              fmts.IDX = readbin(fmts.IDX, sas, swapit);
-              fmts.OFF = readbin(fmts.OFF, sas, swapit);
-              fmts.LEN = readbin(fmts.LEN, sas, swapit);
-
-              if (debug)
-                Rcout << fmts.IDX << ", " << fmts.OFF <<
-                  ", " << fmts.LEN << std::endl;
-
-              fmt.push_back(fmts);
-
-              lbls.IDX = readbin(lbls.IDX, sas, swapit);
-              lbls.OFF = readbin(lbls.OFF, sas, swapit);
-              lbls.LEN = readbin(lbls.LEN, sas, swapit);
-
-              if (debug)
-                Rcout << lbls.IDX << ", " << lbls.OFF <<
-                  ", " << lbls.LEN << std::endl;
-
-              lbl.push_back(lbls);
-
-              unks.IDX = readbin(unks.IDX, sas, swapit);
-              unks.OFF = readbin(unks.OFF, sas, swapit);
-              unks.LEN = readbin(unks.LEN, sas, swapit);
-
-
-              unk.push_back(unks);
-
-              if ((unks.IDX != 0) | (unks.OFF != 0) | (unks.LEN != 0)) {
-                warning("case3: unk is not 0 as expected, but %d %d %d\n",
-                        unks.IDX, unks.OFF, unks.LEN);
-              }
-
-              break;
-            }
-
-
-            // new offset --------------------------------------------------- //
-          case 4:
-            {
-              /* Column Size */
-
-              if (debug)
-                Rcout << "-------- case 4 "<< sas.tellg() << std::endl;
-
-              uint64_t uunk64 = 0;
-
-              if (u64 == 4) {
-                k = readbin(k, sas, swapit);
-                uunk64 = readbin(uunk64, sas, swapit);
-              } else {
-                k = readbin((int32_t)k, sas, swapit);
-                uunk64 = readbin((int32_t)uunk64, sas, swapit);
-              }
-
-              if (debug)
-                Rcpp::Rcout << "k " << k << "; uunk64 " << uunk64 << std::endl;
-
-              break;
-            }
-
-            // new offset --------------------------------------------------- //
-
-          case 5:
-            {
-              /* Column Text */
-
-              if (debug)
-                Rcout << "-------- case 5 "<< sas.tellg() << std::endl;
-
-              int16_t len = 0;
-
-              varname_pos.push_back( sas.tellg() );
-
-              len = readbin(len, sas, swapit);
-              // Rcout << len << std::endl;
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-
-              if ((PAGE_TYPE != 1024) && (c5first == 0)) {
-                unk16 = readbin(unk16, sas, swapit); // 0 |     0 | 27977
-                // Rcout << unk16 << std::endl;
-                unk16 = readbin(unk16, sas, swapit); // 0 | 15872 | 30064
-                // Rcout << unk16 << std::endl;
-              }
-
-              if ((c5typ == 0) && (pg == 0)) {
-
-                uint64_t pos_beg = sas.tellg();
-                int8_t tmp = 16; // always 16?
-                if (!hasproc) tmp = 0;
-
-                if (debug)
-                  Rcpp::Rcout << comprlen << ", "
-                              << tmp << ", "
-                              << proclen << ", "
-                              << swlen << "; "
-                              << varname_pos[0]
-                              << std::endl;
-
-                uint64_t txtpos = varname_pos[0] + 12;
-
-                sas.seekg(txtpos, sas.beg);
-
-                // compression
-                if (comprlen > 0) {
-                  compression.resize(comprlen, '\0');
-                  compression = readstring(compression, sas);
-
-                  if (compression.compare("SASYZCRL") == 0)
-                    compr = 1;
-
-                  if (compression.compare("SASYZCR2") == 0)
-                    compr = 2;
-                  // Rcout << compression << std::endl;
-                }
-
-                // 16 whitespaces
-                std::string empty (tmp, '\0');
-                if (tmp > 0) {
-                  empty = readstring(empty, sas);
-                  if (!(empty.compare("                ") == 0))
-                    warning("non empty 'empty' string found %s \n",
-                            empty);
-                }
-
-                // proc that created the file
-                if (proclen > 0) {
-                  proc.resize(proclen, '\0');
-                  proc = readstring(proc, sas);
-                }
-
-                // additional software string
-                if (swlen > 0) {
-                  sw.resize(swlen, '\0');
-                  sw = readstring(sw, sas);
-                }
-
-
-                if (debug)
-                  Rcout << "here we go!\n" <<
-                    compression << "\n" <<
-                      empty << "\n" <<
-                        proc << "\n" <<
-                          sw << std::endl;
-
-                sas.seekg(pos_beg, sas.beg);
-              }
-
-              if (debug)
-                Rcpp::Rcout << "SH_LEN " << potabs[sc].SH_LEN
-                            << "; len " << len << std::endl;
-
-              ++c5typ;
-
-              break;
-            }
-
-
-            // new offset --------------------------------------------------- //
-          case 6:
-            {
-              /* Column Name */
-
-              if (debug)
-                Rcout << "-------- case 6 "<< sas.tellg() << std::endl;
-
-
-              int16_t lenremain = 0;
-
-              lenremain = readbin(lenremain, sas, swapit);
-              if (debug) Rprintf("lenremain %d \n", lenremain);
-
-              int8_t div = 8;
-              lenremain -= 8;
-
-              auto cmax = lenremain / div;
-
-
-              unk16 = readbin(unk16, sas, swapit); // 0
-              if (unk16 != 0) stop("unk16 1. expected 0 is %d", unk16);
-              unk16 = readbin(unk16, sas, swapit); // 0
-              if (unk16 != 0) stop("unk16 2. expected 0 is %d", unk16);
-              unk16 = readbin(unk16, sas, swapit); // 0
-              if (unk16 != 0) stop("unk16 3. expected 0 is %d", unk16);
-
-              /* Column Name Pointers */
-              CN_Poi cnpoi;
-
-              for (auto cn = 0; cn < cmax; ++cn) {
-
-                cnpoi.CN_IDX    = readbin(cnpoi.CN_IDX, sas, swapit);
-                cnpoi.CN_OFF    = readbin(cnpoi.CN_OFF, sas, swapit);
-                cnpoi.CN_LEN    = readbin(cnpoi.CN_LEN, sas, swapit);
-                cnpoi.zeros     = readbin(cnpoi.zeros,  sas, swapit);
-
-                cnpois.push_back( cnpoi );
-
-                cnidx.push_back( cnpoi.CN_IDX );
-                cnoff.push_back( cnpoi.CN_OFF );
-                cnlen.push_back( cnpoi.CN_LEN );
-                cnzer.push_back( cnpoi.zeros );
-
-                if (debug) {
-                  Rcpp::Rcout << "CN_IDX " << cnpois[cn].CN_IDX
-                              << "; CN_OFF " << cnpois[cn].CN_OFF
-                              << "; CN_LEN " << cnpois[cn].CN_LEN
-                              << "; zeros " << cnpois[cn].zeros
-                              << "; len " << cn
-                              << std::endl;
-                }
-
-
-              }
-
-              break;
-            }
-
-
-            // new offset --------------------------------------------------- //
-          case 7:
-            {
-              /* Column Attributes */
-
-              if (debug)
-                Rcout << "-------- case 7 "<< sas.tellg()  << std::endl;
-
-              int16_t lenremain = 0;
-              lenremain = readbin(lenremain, sas, swapit);
-              if (debug) Rprintf("lenremain %d \n", lenremain);
-
-              // zeros as padding?
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-
-              int8_t divs = 16;
-              if (u64 != 4) divs = 12;
-
-              lenremain -= 8;
-
-              auto cmax = lenremain / divs;
-
-              /* Column Attributes Pointers */
-              std::vector<CN_Att> capois(cmax);
-
-              for (auto i = 0; i < cmax; ++i) {
-
-                if (u64 == 4) {
-                  capois[i].CN_OFF     = readbin(capois[i].CN_OFF, sas, swapit);
-                } else {
-                  capois[i].CN_OFF     = readbin((int32_t)capois[i].CN_OFF,
-                                                 sas, swapit);
-                }
-                capois[i].CN_WID     = readbin(capois[i].CN_WID, sas, swapit);
-                capois[i].NM_FLAG    = readbin(capois[i].NM_FLAG, sas, swapit);
-                capois[i].CN_TYP     = readbin(capois[i].CN_TYP, sas, swapit);
-                capois[i].UNK8       = readbin(capois[i].UNK8, sas, swapit);
-
-
-                if ((capois[i].CN_TYP >= 1) && (capois[i].CN_TYP <= 2) &&
-                    (capois[i].CN_WID >= 0) && // just > ?
-                    ((uint32_t)capois[i].CN_WID <= pagesize)) {
-                  if (debug)
-                    Rcpp::Rcout << "OFF " << capois[i].CN_OFF
-                                << "; WID: " << capois[i].CN_WID
-                                << "; FLAG " << capois[i].NM_FLAG
-                                << "; TYP " << capois[i].CN_TYP
-                                << "; UNK8 " << capois[i].UNK8
-                                << std::endl;
-
-                  coloffset.push_back( capois[i].CN_OFF );
-                  colwidth.push_back( capois[i].CN_WID );
-                  vartyps.push_back( capois[i].CN_TYP );
-                }
-
-              }
+  // character digits read as numbers
+  void parse(size_t i, size_t j, const char* p, size_t len) {
+    while (len > 0 && std::isspace((unsigned char)*p)) {
+      ++p;
+      --len;
+    }
+    while (len > 0 && std::isspace((unsigned char)p[len - 1])) --len;
 
-              break;
-            }
+    if (len == 0) {
+      put(i, j, NA_REAL);
+      return;
+    }
 
-          case 8:
-            {
+    tmp.assign(p, len);
+    char* end = nullptr;
 
-              if (debug)
-                Rcout << "-------- case 8 "<< sas.tellg() << std::endl;
-
-              int16_t cls = 0;
-              int64_t lenremain = 0;
-
-              unk32 = readbin(unk32, sas, swapit); // unkown large number
-              // Rcout << unk32 << std::endl;
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin(unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-
-              if (u64 == 4) {  // lenremain
-                lenremain = readbin(lenremain, sas, swapit);
-              } else {
-                lenremain = readbin((int32_t)lenremain, sas, swapit);
-              }
-
-              if (debug)
-                Rcout << "lenremain "<< lenremain << std::endl; // 92
+    // integer64 keeps all digits
+    if (cls[j] == CC_INTEGER64) {
+      errno = 0;
+      long long v = std::strtoll(tmp.c_str(), &end, 10);
+      if (errno == 0 && *end == '\0' && v != NA_INTEGER64) {
+        i64[j][i] = v;
+        return;
+      }
+    }
 
-              unk16 = readbin(unk16, sas, swapit);
-              // Rcout << unk16 << std::endl; // number of varnames?
-              cls = readbin(cls, sas, swapit);
-              // Rcout << cls << std::endl;   // counter for unk loop below
-              unk16 = readbin(unk16, sas, swapit);
-              // Rcout << unk16 << std::endl; // 1
-              unk16 = readbin(unk16, sas, swapit);
-              // Rcout << unk16 << std::endl; // number of varnames?
-              unk16 = readbin(unk16, sas, swapit);  // 3233
-              // Rcout << unk16 << std::endl; // 0
-              unk16 = readbin(unk16, sas, swapit);  // 3233
-              // Rcout << unk16 << std::endl; // 0
-              unk16 = readbin(unk16, sas, swapit);  // 3233
-              // Rcout << unk16 << std::endl; // 0
-
-              lenremain -= 14;
-
-              // Rcout << lenremain << " " << cls << std::endl;
-
-              for (auto cl = 0; cl < cls; ++cl) {
-                int16_t res = 0;
-                res = readbin(res, sas, swapit);
-                c8vec.push_back(res);
-              }
-
-
-              // Rcout << "---------------------------" << std::endl;
-
-              // 8
-              unk16 = readbin((int8_t)unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin((int8_t)unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin((int8_t)unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-              unk16 = readbin((int8_t)unk16, sas, swapit); // 0
-              // Rcout << unk16 << std::endl;
-
-              // Rcout << "---------------------------" << std::endl;
-
-              break;
-
-            }
-
-          case 9:
-            {
-
-              if (debug)
-                Rcout << "-------- case 9 "<< sas.tellg()  << std::endl;
-
-
-              auto clen = potabs[sc].SH_LEN;
-              std::string cstr(clen, '\0');
-              std::string ustr(rowlength, '\0');
-              cstr = readstring(cstr, sas);
-
-              if (compr == 1)
-                ustr = SASYZCRL(clen, rowlength, cstr, debug);
-
-              if (compr == 2)
-                ustr = SASYZCR2(clen, rowlength, cstr, debug);
+    double v = std::strtod(tmp.c_str(), &end);
+    if (*end != '\0') {
+      v = NA_REAL;
+      ++coerced;
+    }
+    put(i, j, v);
+  }
 
-              writestr(ustr, ustr.size(), out);
+  void str(size_t i, size_t j, const char* p, size_t len) {
+    if (factor[j]) {
+      ints[j][i] = factor[j]->str(p, len);
+    } else if (cls[j] != CC_CHARACTER && cls[j] != CC_DEFAULT) {
+      parse(i, j, p, len);
+    } else if (empty_to_na && len == 0) {
+      SET_STRING_ELT(chr[j], i, NA_STRING);
+    } else {
+      SET_STRING_ELT(chr[j], i, Rf_mkCharLen(p, len));
+    }
+  }
 
-              break;
-            }
+  void missing(size_t i) {
+    for (size_t j = 0; j < chr.size(); ++j) {
+      if (chr[j] != R_NilValue)
+        SET_STRING_ELT(chr[j], i, NA_STRING);
+      else if (narrow[j] || factor[j])
+        ints[j][i] = NA_INTEGER;
+      else
+        put(i, j, NA_REAL);
+    }
+    valid[i] = false;
+  }
+};
 
-          case 10:
-            {
-              if (debug)
-                Rcout << "-------- case 10 "<< sas.tellg()  << std::endl;
+// timings and counters of a read, see readsas_profile()
+Rcpp::List profile_list(const SasProfile& prof, const SasFile& f)
+{
+  // decode is reported without the time spent reading rows and creating
+  // strings. Both are measured per call, their cpu time is unknown.
+  double decode = prof.wall[SAS_PHASE_DECODE] - prof.wall[SAS_PHASE_READ] -
+    prof.wall[SAS_PHASE_STRINGS];
+
+  Rcpp::DataFrame phases = Rcpp::DataFrame::create(
+    _["phase"] = CharacterVector::create("header", "pages", "read", "decode",
+                                         "strings"),
+    _["wall"] = NumericVector::create(prof.wall[SAS_PHASE_HEADER],
+                                      prof.wall[SAS_PHASE_PAGES],
+                                      prof.wall[SAS_PHASE_READ],
+                                      std::max(decode, 0.0),
+                                      prof.wall[SAS_PHASE_STRINGS]),
+    _["cpu"] = NumericVector::create(prof.cpu[SAS_PHASE_HEADER],
+                                     prof.cpu[SAS_PHASE_PAGES], NA_REAL,
+                                     prof.cpu[SAS_PHASE_DECODE], NA_REAL),
+    _["stringsAsFactors"] = false);
+
+  // pages by PAGE_TYPE
+  std::vector<int> types;
+  for (auto& pg : f.pages)
+    if (std::find(types.begin(), types.end(), pg.type) == types.end())
+      types.push_back(pg.type);
+  std::sort(types.begin(), types.end());
+
+  IntegerVector page_types(types.size());
+  CharacterVector page_names(types.size());
+  for (size_t i = 0; i < types.size(); ++i) {
+    page_types[i] = std::count_if(f.pages.begin(), f.pages.end(),
+                                  [&](const SasPage& pg) {
+                                    return pg.type == types[i];
+                                  });
+    page_names[i] = std::to_string(types[i]);
+  }
+  page_types.attr("names") = page_names;
+
+  return Rcpp::List::create(
+    _["phases"] = phases,
+    _["bytes_read"] = (double)prof.bytes_read,
+    _["seeks"] = (double)prof.seeks,
+    _["page_types"] = page_types,
+    _["compressed_bytes"] = (double)prof.compressed_bytes,
+    _["uncompressed_bytes"] = (double)prof.uncompressed_bytes,
+    _["peak_buffer"] = (double)prof.peak_buffer
+  );
+}
 
-              if ((potabs[sc].SH_LEN > alignval) &&
-                  (potabs[sc].SH_LEN < pagesize))
-              {
-                // uncompressed row containing data
-                auto unklen = potabs[sc].SH_LEN;
-                std::string unkstr(unklen, '\0');
-                unkstr = readstring(unkstr, sas);
-                writestr(unkstr, unkstr.size(), out);
-              }
 
-              break;
-            }
+// decodes the rows and columns of an opened file, see readsas() for the
+// arguments. Shared with sas_read(), which decodes from an open handle.
+Rcpp::List sas_data(const std::shared_ptr<SasLazy>& lazy,
+                    SEXP input,
+                    SasProfile* prof,
+                    const bool debug,
+                    Nullable<NumericVector> selectrows_,
+                    Nullable<CharacterVector> selectcols_,
+                    const bool empty_to_na,
+                    const bool convert,
+                    Nullable<CharacterVector> col_classes_,
+                    const bool narrow,
+                    Nullable<List> where_,
+                    Nullable<CharacterVector> zonemap_,
+                    Nullable<CharacterVector> index_,
+                    Nullable<List> sample_,
+                    const double n_max,
+                    Nullable<List> lazy_,
+                    const bool pagemap,
+                    Nullable<List> formats_)
+{
+  SasReader& reader = lazy->reader;
+  const SasFile& f = reader.meta();
 
-            // not implemented ---------------------------------------------- //
-          default:
-            {
+  int64_t n = f.n;
 
-              if (debug) {
-              Rcout << "---- unimplemented "<< sas.tellg() << std::endl;
-              Rcout << "SAS HEX STRING: "  << sas_hex << std::endl;
-              Rcout << "rowlength is " << rowlength << std::endl;
 
-              Rcpp::Rcout << "SH_OFF: " << potabs[sc].SH_OFF
-                          << "; SH_LEN: " << potabs[sc].SH_LEN
-                          << "; COMPR.: " << (int32_t)potabs[sc].COMPRESSION
-                          << "; SH_TYPE: " << (int32_t)potabs[sc].SH_TYPE
-                          << std::endl;
+  // check if vars are selected
+  bool selectvars = selectcols_.isNotNull();
 
-            }
+  // select vars: either select every var or only matched cases. This will
+  // return index positions of the selected variables. If non are selected the
+  // index position is cvec
 
-              // some subheaders are pointers to positions inside the file.
-              // their use for SAS is unknown and they are not required for R.
-              // if SC_LEN == alignval it is just padding?
-              if ((potabs[sc].SH_LEN > alignval) &&
-                  (potabs[sc].SH_LEN < pagesize) &&
-                  (potabs[sc].COMPRESSION != 4) )
-              {
-                auto unklen = potabs[sc].SH_LEN;
-                std::string unkstr(unklen, '\0');
-              }
+  std::unordered_set<std::string> select_cols = select_set(selectcols_);
 
-              break;
-            }
+  // requested column classes by name
+  std::vector<std::string> cc_names, cc_values;
+  if (col_classes_.isNotNull()) {
+    CharacterVector col_classes(col_classes_);
+    cc_values = Rcpp::as<std::vector<std::string>>(col_classes);
+    cc_names = Rcpp::as<std::vector<std::string>>(col_classes.names());
+  }
+  std::unordered_map<std::string, size_t> cc_pos; // last class of a name
+  for (size_t k = 0; k < cc_names.size(); ++k) cc_pos[cc_names[k]] = k;
+  std::unordered_set<std::string> cc_found;
 
-          }
-        }
+  std::vector<int64_t> cvec, select;
+  std::vector<int> classes;
+  std::vector<std::string> varnames;
 
+  auto ii = 0;
+  for (size_t i = 0; i < f.varnames.size(); ++i) {
 
+    const std::string& varname = f.varnames[i];
 
-        /*
-         * The code to detect removed rows is based on the parso library
-         * Licensed under the Apache License, Version 2.0. Copyright 2015 EPAM
-         *
-         */
+    // columns without attributes can not be decoded
+    bool keepc = i < f.vartyps.size();
 
-        // check for deleted rows
-        if (PAGE_TYPE == 384 || PAGE_TYPE == 640 || PAGE_TYPE == 1024) {
+    if (keepc && selectvars)
+      keepc = select_cols.count(varname) > 0;
 
-          uint64_t start_pos = sas.tellg();
+    int cls = CC_DEFAULT;
+    auto cc = cc_pos.find(varname);
+    if (cc != cc_pos.end()) {
+      cls = col_class(cc_values[cc->second]);
+      cc_found.insert(varname);
+    }
 
-          // TODO this calculation should be replaced with alignval assignment
-          auto alignCorrection = (
-            (PAGE_BIT_OFFSET + 8) +
-              SUBHEADER_POINTERS_OFFSET +
-              (int64_t)((double)SUBHEADER_COUNT * SUBHEADER_POINTER_LENGTH)
-          ) % 8;
+    if (keepc && cls == CC_CHARACTER && f.vartyps[i] == 1)
+      stop("numeric column %s can not be read as character", varname);
 
-          if (debug)
-            Rcout << "alignCorrection: " << alignCorrection << std::endl;
+    if (cls == CC_SKIP) keepc = false;
 
-          uint64_t deletedMapOffset = (PAGE_BIT_OFFSET + 8) +
-            PAGE_DELETED_POINTER_LENGTH +
-            alignCorrection + // alignval?
-            ((double)SUBHEADER_COUNT * SUBHEADER_POINTER_LENGTH) +
-            ((double)rowsperpage[pg] * rowlength);
+    if (keepc) {
+      cvec.push_back(ii);
+      select.push_back(i);
+      classes.push_back(cls);
+      varnames.push_back(varname);
+      ++ii;
+    } else {
+      cvec.push_back(-1);
+    }
 
-          uint64_t dmo_pos = (headersize + (double)pg * pagesize) + deletedMapOffset;
+    if (debug)
+      Rcout << keepc << " : " << i << " : " << varname << std::endl;
+  }
 
-          if (debug) {
-            Rcout << "SUBHEADER_COUNT " << SUBHEADER_COUNT << std::endl;
-            Rcout << "rowlength " << rowlength << std::endl;
-            Rcout << "dMO " << deletedMapOffset << std::endl;
-            Rcout << "read from: " << dmo_pos << std::endl;
-          }
+  for (size_t k = 0; k < cc_names.size(); ++k)
+    if (!cc_found.count(cc_names[k]))
+      Rcpp::warning("col_classes: column %s not found", cc_names[k]);
 
-          sas.seekg(dmo_pos, sas.beg);
 
+  // --- begin select rows or cols ----------------------------------- //
 
-          // every byte contains information for 8 rows
-          int32_t dm_len = (int32_t)std::ceil((double)rowsperpage[pg] / 8);
-          if (debug) Rcout << "dm_len: " << dm_len << std::endl;
+  int64_t nmin = 0, nmax = 0;
+  uint64_t nn   = 0;
 
-          std::string delmarker = "";
-          for (auto dm = 0; dm < dm_len; ++dm) {
-            unk8 = readbin(unk8, sas, swapit);
-            if (debug) Rprintf("unk8: %d\n", unk8);
+  // row positions are doubles, files may hold more than 2^31 rows
+  NumericVector rvec;
+  if (selectrows_.isNull()) {
+    nmin = 0;
+    nmax = n -1;
+    // sequences of column and row. Replaced by n_max and sample.
+    if (nmax >= nmin && n_max < 0 && sample_.isNull()) {
+      rvec = NumericVector(no_init(n));
+      for (int64_t r = 0; r < n; ++r) rvec[r] = r;
+    }
+  } else {
+    NumericVector selectrows(selectrows_);
 
-            delmarker += std::bitset<8>(unk8).to_string(); //to binary
-            if (debug) Rcout << delmarker << std::endl;
-          }
+    // all rows must be available
+    if (any_keepr(selectrows, n))
+      Rcpp::warning("row > %d selected. Reducing select.rows", n);
 
-          pagedelmarker[pg] = delmarker;
+    if (!any_keepr(selectrows, -1)) {
+      rvec = selectrows[selectrows < n];
+      nmin = min(rvec);
+      nmax = max(rvec);
+    } else {
+      nmin = -1;
+      nmax = -1;
+    }
+  }
 
-          sas.seekg(start_pos, sas.beg);
+  // first rows. Deleted rows are kept, they are removed in R.
+  if (n_max >= 0 && selectrows_.isNull()) {
+    std::vector<int64_t> first;
+    int64_t avail = std::min(n, sas_rows_available(f)), live = 0;
+    for (int64_t r = 0; r < avail && live < n_max; ++r) {
+      first.push_back(r);
+      if (!sas_row_deleted(f, r)) ++live;
+    }
 
-        }
+    rvec = NumericVector(first.begin(), first.end());
+    nmax = first.size() - 1;
+  }
 
-      }
+  // random rows, drawn from the page row counts
+  if (sample_.isNotNull()) {
+    List smp(sample_);
+    bool skip_deleted = as<bool>(smp["skip_deleted"]);
+    // a whole number in [0, 2^53), checked in R
+    uint64_t seed = (int64_t)as<double>(smp["seed"]);
+
+    int64_t k;
+    if (smp.containsElementNamed("frac")) {
+      std::vector<int64_t> live = sas_live_rows(f, sas_zone_ends_clipped(f),
+                                                skip_deleted);
+      int64_t total = 0;
+      for (auto l : live) total += l;
+      k = std::llround(as<double>(smp["frac"]) * total);
+    } else {
+      // finite and at most 2^53, checked in R
+      k = as<double>(smp["n"]);
     }
 
-    out.close();
-
+    std::vector<int64_t> smpl = as<bool>(smp["pages"]) ?
+      sas_sample_pages(f, k, seed, skip_deleted) :
+      sas_sample_rows(f, k, seed, skip_deleted);
 
-    if (debug)
-      Rcout << "varnames ----------------------------" << std::endl;
+    rvec = NumericVector(smpl.begin(), smpl.end());
+    if (!smpl.empty()) {
+      nmin = smpl.front();
+      nmax = smpl.back();
+    }
+  }
 
+  // otherwise if n == 0 nn would be 1
+  if (rvec.size() > 0) nn = rvec.size();
+
+  if (debug)
+    Rcout << "reading n/nn/nmin/nmax: " << n << "/" << nn << "/" << nmin << "/" << nmax << std::endl;
+
+  std::vector<int64_t> rows(rvec.begin(), rvec.begin() + nn);
+
+  // predicates are evaluated before decoding. Rows that can not match
+  // according to the index or the zone map are dropped before.
+  std::vector<SasPredicate> where;
+  if (where_.isNotNull()) {
+    List w(where_);
+    CharacterVector wcol = w["col"];
+    IntegerVector wop = w["op"];
+    NumericVector wval = w["value"];
+
+    for (R_xlen_t i = 0; i < wcol.size(); ++i) {
+      SasPredicate pred;
+      pred.col = reader.column(Rcpp::as<std::string>(wcol[i]));
+      if (pred.col < 0)
+        stop("where: column %s not found", Rcpp::as<std::string>(wcol[i]));
+      pred.op = wop[i];
+      pred.value = wval[i];
+      where.push_back(pred);
+    }
 
-    // check if vars are selected
-    bool selectvars = selectcols_.isNotNull();
+    // a sorted column limits the rows to a span found by binary search
+    if (w.containsElementNamed("sorted")) {
+      std::string name = Rcpp::as<std::string>(w["sorted"]);
+      int64_t col = reader.column(name);
+      if (col < 0)
+        stop("sorted: column %s not found", name);
 
-    // select vars: either select every var or only matched cases. This will
-    // return index positions of the selected variables. If non are selected the
-    // index position is cvec
+      int64_t first = 0, last = 0, probes = 0;
+      sas_check(reader, reader.sorted_span(col, where, first, last, probes));
+      auto lo = std::lower_bound(rows.begin(), rows.end(), first);
+      auto hi = std::lower_bound(lo, rows.end(), last);
+      rows = std::vector<int64_t>(lo, hi);
+      nn = rows.size();
 
-    std::vector<std::string> select_cols;
-    if (selectvars) {
-      CharacterVector selectcols(selectcols_);
-      select_cols = Rcpp::as<std::vector<std::string>>(selectcols);
+      if (debug)
+        Rcout << "sorted: rows " << first << " to " << last << ", " <<
+          probes << " probes, " << nn << " candidate rows" << std::endl;
     }
 
-    std::vector<int64_t> cvec, select;
+    // columns compared with a constant are looked up in the index
+    if (index_.isNotNull()) {
+      std::vector<int64_t> icols;
+      for (auto& w : where)
+        if (w.op != SAS_NE) icols.push_back(w.col);
 
-    auto ii = 0;
-    for (size_t i = 0; i < cnpois.size(); ++i) {
+      std::string path = Rcpp::as<std::string>(CharacterVector(index_)[0]);
+      SasIndex idx;
+      sas_check(reader, reader.index(path, icols, idx));
+      rows = sas_index_filter(idx, rows, where);
+      nn = rows.size();
 
       if (debug)
-        Rcpp::Rcout << "CN_IDX " << cnpois[i].CN_IDX
-                    << "; CN_OFF " << cnpois[i].CN_OFF
-                    << "; CN_LEN " << cnpois[i].CN_LEN
-                    << "; zeros " << cnpois[i].zeros
-                    << std::endl;
-
-      uint64_t vpos = (varname_pos[cnpois[i].CN_IDX] + cnpois[i].CN_OFF);
-      sas.seekg(vpos, sas.beg);
-
-      std::string varname(cnpois[i].CN_LEN, '\0');
-      varname = readstring(varname, sas);
-
-      bool keepc = true;
-
-      if(selectvars)  {
-        if (std::find(select_cols.begin(), select_cols.end(), varname) != select_cols.end()) {
-          keepc = true;
-          cvec.push_back(ii);
-          select.push_back(i);
-          ++ii;
-        } else {
-          keepc = false;
-          cvec.push_back(-1);
-        }
-      } else {
-        keepc = true;
-        cvec.push_back(i);
-        select.push_back(i);
-      }
+        Rcout << "index: " << idx.keys.size() << " columns, " << nn <<
+          " candidate rows" << std::endl;
+    }
 
-      if (keepc && (int16_t)varname.size() == cnpois[i].CN_LEN)
-        varnames.push_back(varname);
+    if (zonemap_.isNotNull()) {
+      std::string path = Rcpp::as<std::string>(CharacterVector(zonemap_)[0]);
+      SasZoneMap zm;
+      sas_check(reader, reader.zonemap(path, zm));
+      rows = sas_zone_filter(zm, rows, where);
+      nn = rows.size();
 
       if (debug)
-        Rcout << keepc << " : " << i << " : " << vpos << " : " << varname << std::endl;
-
+        Rcout << "zone map: " << zm.ends.size() << " zones, " << nn <<
+          " candidate rows" << std::endl;
     }
 
+    // late materialization: the first pass decodes only the where columns,
+    // all selected columns are decoded for the surviving rows afterwards
+    std::vector<int64_t> matched;
+    sas_check(reader, reader.select(rows, where, matched));
+    rows.swap(matched);
+    nn = rows.size();
+    rvec = NumericVector(rows.begin(), rows.end());
 
-    // --- begin select rows or cols ----------------------------------- //
+    if (debug)
+      Rcout << "where: " << nn << " matching rows" << std::endl;
+  }
 
-    int64_t nmin = 0, nmax = 0;
-    uint64_t nn   = 0;
+  uint32_t kk = select.size();
+
+  // shrink variables to selected size
+  std::vector<int16_t> c8vec;
+  std::vector<int32_t> vartyps, colwidth;
+  std::vector<double> fmt32s, ifmt32s, fmtkeys;
+  std::vector<std::string> formats, labels;
+
+  for (auto i : select) {
+    vartyps.push_back(f.vartyps[i]);
+    colwidth.push_back(f.colwidth[i]);
+    if ((size_t)i < f.c8vec.size()) c8vec.push_back(f.c8vec[i]);
+    if ((size_t)i < f.fmt32s.size()) fmt32s.push_back(f.fmt32s[i]);
+    if ((size_t)i < f.ifmt32s.size()) ifmt32s.push_back(f.ifmt32s[i]);
+    if ((size_t)i < f.fmtkeys.size()) fmtkeys.push_back(f.fmtkeys[i]);
+    if ((size_t)i < f.formats.size()) formats.push_back(f.formats[i]);
+    if ((size_t)i < f.labels.size()) labels.push_back(f.labels[i]);
+  }
 
-    // if  selectrows is c(0,0) use full data
-    IntegerVector rvec;
-    if (selectrows_.isNull()) {
-      nmin = 0;
-      nmax = n -1;
-      // sequences of column and row
-      if (nmax >= nmin) rvec = seq(nmin, nmax);
-    } else {
-      IntegerVector selectrows(selectrows_);
+  // --- end select rows or cols ------------------------------------- //
+
+  // lazy columns: deleted rows are dropped now, subsetting in R would decode
+  // every column
+  bool is_lazy = lazy_.isNotNull();
+  if (is_lazy) {
+    List lz(lazy_);
+
+    if (as<bool>(lz["skip_deleted"])) {
+      int64_t avail = sas_rows_available(f);
+      rows.erase(std::remove_if(rows.begin(), rows.end(), [&](int64_t r) {
+        return r >= avail || sas_row_deleted(f, r);
+      }), rows.end());
+      nn = rows.size();
+      rvec = NumericVector(rows.begin(), rows.end());
+    }
 
-      // all rows must be available
-      if (any_keepr(selectrows, n))
-        Rcpp::warning("row > %d selected. Reducing select.rows", n);
+    lazy->rows = rows;
+    lazy->convert = convert;
+    lazy->empty_to_na = empty_to_na;
+    if (as<bool>(lz["recode"])) lazy->encoding = f.enc;
+  }
 
-      if (!any_keepr(selectrows, -1)) {
-        rvec = selectrows[selectrows < n];
-        nmin = min(rvec);
-        nmax = max(rvec);
-      } else {
-        nmin = -1;
-        nmax = -1;
-      }
+  // flags of the returned rows
+  std::vector<bool> deleted(nn), valid(nn, true);
+  for (size_t i = 0; i < nn; ++i)
+    deleted[i] = sas_row_deleted(f, rows[i]);
+
+  // 1. Create Rcpp::List
+  Rcpp::List df(kk);
+  RSink sink(kk, nn, df, valid, convert, empty_to_na, debug);
+
+  // user defined formats, matched by column name or by the format name of a
+  // column. Columns with a format are decoded into factors.
+  if (formats_.isNotNull()) {
+    List fmts(formats_);
+    std::vector<std::string> names = as<std::vector<std::string>>(fmts.names());
+
+    std::unordered_map<std::string, size_t> by_name, by_format;
+    for (size_t k = 0; k < names.size(); ++k) {
+      if (names[k].empty()) continue;
+      by_name.emplace(names[k], k);
+      std::string upper = names[k];
+      for (auto& c : upper) c = std::toupper((unsigned char)c);
+      by_format.emplace(upper, k);
     }
 
-    // make sure that n is not greater than nmax or nmin
-    if (n < nmax)
-      nmax = n;
-    if (n < nmin)
-      nmin = n;
-
-    // otherwise if n == 0 nn would be 1
-    if (rvec.size() > 0) nn = rvec.size();
+    for (uint32_t i = 0; i < kk; ++i) {
+      if (classes[i] != CC_DEFAULT) continue;
+
+      auto it = by_name.find(varnames[i]);
+      if (it == by_name.end() && i < formats.size()) {
+        std::string upper = formats[i];
+        for (auto& c : upper) c = std::toupper((unsigned char)c);
+        it = by_format.find(upper);
+        if (it == by_format.end()) continue;
+      } else if (it == by_name.end()) {
+        continue;
+      }
 
-    if (debug)
-      Rcout << "reading n/nn/nmin/nmax: " << n << "/" << nn << "/" << nmin << "/" << nmax << std::endl;
-
-
-    /* this is dangerous, the length is correct, but the position in the file
-     * differs. right now it is not always exactly this. To make this working
-     * modifications to the import process are required.
-     */
-    // rowlength
-    IntegerVector rlen = rowlength;
-
-    uint32_t kk = select.size();
-
-    // shrink variables to selected size
-
-    std::vector<int16_t> c8vec_kk;
-    std::vector<int32_t> vartyps_kk, colwidth_kk;
-    std::vector<double> fmt32s_kk, ifmt32s_kk, fmtkeys_kk;
-
-    if (selectcols_.isNotNull()) {
-      // reduce to selected
-      // keep both vartyps and vartyps_kk
-      for(std::size_t i = 0; i < vartyps.size(); ++i) {
-        if(cvec[i] >= 0) {
-          c8vec_kk.push_back(c8vec[i]);
-          vartyps_kk.push_back(vartyps[i]);
-          colwidth_kk.push_back(vartyps[i]);
-          fmt32s_kk.push_back(fmt32s[i]);
-          ifmt32s_kk.push_back(ifmt32s[i]);
-          fmtkeys_kk.push_back(fmtkeys[i]);
-        }
+      SasFormat fmt = format_from(fmts[it->second]);
+      if (fmt.numeric != (vartyps[i] == 1)) {
+        Rcpp::warning("format %s does not match the type of column %s",
+                      names[it->second], varnames[i]);
+        continue;
       }
-      c8vec  = std::move(c8vec_kk);
-      fmt32s  = std::move(fmt32s_kk);
-      ifmt32s = std::move(ifmt32s_kk);
-      fmtkeys = std::move(fmtkeys_kk);
 
-    } else {
-      vartyps_kk = vartyps;
-      colwidth_kk = colwidth;
+      sink.factor[i].reset(new FormatFactor(fmt));
     }
+  }
 
-    // --- end select rows or cols ------------------------------------- //
-
-    if (hasattributes) {
-
-      for (auto i = 0; i < k; ++i) {
-
-        if (cvec[i] >= 0) {
-
-          /* read formats and labels */
-          std::string format = "";
-          if ((size_t)i < fmt.size() && fmt[i].LEN > 0) {
-            uint64_t fpos = (varname_pos[fmt[i].IDX] + fmt[i].OFF);
-            sas.seekg(fpos, sas.beg);
-            format.resize(fmt[i].LEN, '\0');
-            format = readstring(format, sas);
-          }
-
-          std:: string label = "";
-          if ((size_t)i < lbl.size() && lbl[i].LEN > 0) {
-            uint64_t lpos = (varname_pos[lbl[i].IDX] + lbl[i].OFF);
-            sas.seekg(lpos, sas.beg);
-            label.resize(lbl[i].LEN, '\0');
-            label = readstring(label, sas);
-          }
+  for (uint32_t i = 0; i < kk; ++i)
+  {
+    if (is_lazy) {
+      SET_VECTOR_ELT(df, i, sas_lazy_column(lazy, select[i], input));
+      continue;
+    }
 
-          if (debug)
-            Rcout << format << " : " << label << std::endl;
+    int32_t const type = vartyps[i];
+    int cls = classes[i];
+    sink.cls[i] = cls;
 
-          formats.push_back( format );
-          labels.push_back( label );
-        }
-      }
+    if (sink.factor[i]) {
+      SET_VECTOR_ELT(df, i, IntegerVector(no_init(nn)));
+      sink.ints[i] = INTEGER(VECTOR_ELT(df, i));
+      continue;
     }
 
-    // 2. fill it with data
+    // narrowed columns start as integer
+    if (cls == CC_DEFAULT && type == 1 && narrow) {
+      cls = CC_INTEGER;
+      sink.narrow[i] = true;
+    }
 
-    // 1. Create Rcpp::List
-    Rcpp::List df(kk);
-    for (uint32_t i = 0; i < kk; ++i)
+    switch(cls)
     {
-      int32_t const type = vartyps_kk[i];
-
-      switch(type)
-      {
-      case 1:
-        SET_VECTOR_ELT(df, i, NumericVector(no_init(nn)));
-        break;
-
-      default:
-        SET_VECTOR_ELT(df, i, CharacterVector(no_init(nn)));
+    case CC_INTEGER:
+      SET_VECTOR_ELT(df, i, IntegerVector(no_init(nn)));
+      sink.ints[i] = INTEGER(VECTOR_ELT(df, i));
       break;
-      }
-    }
 
-    auto ordered = order_(coloffset);
+    case CC_LOGICAL:
+      SET_VECTOR_ELT(df, i, LogicalVector(no_init(nn)));
+      sink.ints[i] = LOGICAL(VECTOR_ELT(df, i));
+      break;
 
-    if (debug)
-    {
-      Rcout << "vartyps " << std::endl;
-      Rf_PrintValue(wrap(vartyps));
-      Rcout << "vartyps_kk " << std::endl;
-      Rf_PrintValue(wrap(vartyps_kk));
-      Rcout << "coloffset " << std::endl;
-      Rf_PrintValue(wrap(coloffset));
-      Rcout << "ordered " << std::endl;
-      Rf_PrintValue(wrap(ordered));
-      Rcout << "cvec " << std::endl;
-      Rf_PrintValue(wrap(cvec));
+    case CC_INTEGER64: {
+      NumericVector vec(no_init(nn));
+      vec.attr("class") = "integer64";
+      SET_VECTOR_ELT(df, i, vec);
+      sink.i64[i] = (int64_t*)REAL(VECTOR_ELT(df, i));
+      break;
     }
 
-    // new offset ----------------------------------------------------------- //
-
-    std::vector<bool> deleted(n);
-    std::vector<bool> valid(n);
-
-    bool firstpage = 0;
-
-    // sas provides two modes, compressed and uncompressed data. compressed
-    // data has to be uncompressed and consists of always single rows. un-
-    // compressed data is unordered aka might have gaps. So we have to be more
-    // careful and handle certain offsets.
-    // uncompressed data might contain deleted rows. most likely these are not
-    // available in compressed data. BUT THIS IS A GUESS.
-    if (compr == 0) {
-
-      if (debug)
-        Rcout << "no compression" << std::endl;
-
-      auto page = 0;
-      sas.seekg(data_pos[0], sas.beg);
-
-      auto i = -1;  // counter output data frame
-      uint64_t ii = 0;  // row on the selected page
-      for (int64_t iii = 0; iii < n; ++iii) {
-
-
-        /* nmin is not a c vector starting at 0. i is initialized at -1 so will
-         * be 0 once its bigger than nmin. This allows to import only the
-         * selected rows. Once nmax is reached, import will stop.
-         */
-
-        bool keepr = false;
-        if (any_keepr(rvec, iii)) {
-          keepr = true;
-          ++i;
-        }
-
-        if (iii > nmax) break;
-
-        // Rcout << "---------------------" << std::endl;
-        // Rcout << iii << " " << nmin << std::endl;
-        if (debug && i == 0)
-          Rcout << "row i / ii / iii / keepr: " << i << " " << ii << " " << iii <<" " << keepr << std::endl;
-
-        if (pagecount > 0) {
-
-          while (totalrowsvec[page] == 0) {
-            ++page;
-            ii = 0;
-
-            if (page == pagecount)
-              break;
-          }
-
-          if (debug && i == 0)
-            Rcout << "page: " << page << std::endl;
-
-          // beg handle delmarker
-          std::string page_pagedelmarker = pagedelmarker[page];
-
-          // Rcout << page_pagedelmarker << " : " << ii << std::endl;
-
-
-          std::string delmarked = "";
-          if (!page_pagedelmarker.empty() && (uint64_t)page_pagedelmarker.size() > 0 && ii < page_pagedelmarker.size()) {
-            delmarked = page_pagedelmarker[ii];
-            // Rcout << page_pagedelmarker[ii] << std::endl;
-          }
-          if (delmarked == "1")
-            deleted[iii] = true;
-          else
-            deleted[iii] = false;
-
-          valid[iii] = true;
-          // end handle delmarker
-
-
-          if (totalrowsvec[page] == iii) {
-            ++page;
-            ii = 0;
-            firstpage = 1;
-          }
-        }
-
-        uint64_t pp = data_pos[page];
-        uint64_t pos = pp + (double)rowlength * ii;
-
-        /* unknown */
-        if (!(dataoffset == 1 || dataoffset == 256) && (firstpage == 0)) {
-          pos += alignval;
-        }
-
-
-        // check if position is equal to expected position
-        if (pos != (uint64_t)sas.tellg()) {
-          // Rcout << "shift" << std::endl;
-          sas.seekg(pos, sas.beg);
-        }
-
-        pos = 0;
-
-        auto skipahead = 0;
-        for (auto j = 0; j < k; ++j) {
-
-          auto ord = ordered[j];
-          auto wid = colwidth[ord];
-          auto typ = vartyps[ord];
-          auto col = cvec[ord];
-
-          if (debug && i == 0)
-            Rcout << "ord/wid/typ: " << ord << " : " << wid << " : " << typ << std::endl;
-
-          bool keepc = col >= 0;
-
-          // Rcout << "---------------------" << std::endl;
-          if (debug && i == 0)
-            Rcout << "  --col j / ord / keepc: " << j << " " << ord << " "<< keepc << std::endl;
-
-          if (debug && i == 0)
-            Rcout << ord << std::endl;
-
-          if ((wid < 8) && (typ == 1)) {
-
-            if (keepr && keepc) {
-              if (skipahead > 0) {
-                sas.seekg(skipahead, sas.cur);
-                skipahead = 0;
-              }
-
-              double val_d = 0.0;
-              val_d = readbinlen(val_d, sas, 0, wid);
-
-              if (debug && i == 0)
-                Rcout << val_d << std::endl;
-
-              if (debug && i == 0)
-                Rcout << "writing: " << i << "/" << col << std::endl;
-
-              if (std::isnan(val_d))
-                REAL(VECTOR_ELT(df,col))[i] = check_na(val_d, convert, debug);
-              else
-                REAL(VECTOR_ELT(df,col))[i] = val_d;
-            } else {
-              skipahead += wid;
-            }
-
-          }
-
-          if ((wid == 8) && (typ == 1)) {
-
-            if (keepr && keepc) {
-              if (skipahead > 0) {
-                sas.seekg(skipahead, sas.cur);
-                skipahead = 0;
-              }
-
-              double val_d = 0.0;
-              val_d = readbin(val_d, sas, swapit);
-
-              if (debug && i == 0)
-                Rcout << val_d << std::endl;
-
-              if (debug && i == 0)
-                Rcout << "writing: " << i << "/" << col << std::endl;
-
-              if (std::isnan(val_d))
-                REAL(VECTOR_ELT(df,col))[i] = check_na(val_d, convert, debug);
-              else
-                REAL(VECTOR_ELT(df,col))[i] = val_d;
-            } else {
-              skipahead += wid;
-            }
-
-          }
-
-          if ((wid > 0) && (typ == 2)) {
-
-            if (keepr && keepc) {
-              if (skipahead > 0) {
-                sas.seekg(skipahead, sas.cur);
-                skipahead = 0;
-              }
-
-              std::string val_s(wid, ' ');
-              val_s = readstring(val_s, sas);
-
-              val_s = std::regex_replace(val_s,
-                                         std::regex(" +$"), "$1");
-
-              if (debug && i == 0)
-                Rcout << val_s << std::endl;
-
-              if (debug && i == 0)
-                Rcout << "writing: " << i << "/" << col << std::endl;
-
-              if (empty_to_na && val_s.empty())
-                as<CharacterVector>(df[col])[i] = NA_STRING;
-              else
-                as<CharacterVector>(df[col])[i] = val_s;
-
-            } else {
-              skipahead += wid;
-            }
-          }
-
-        }
-
-        // end of row reached, skip to end if required
-        if (skipahead > 0) {
-          sas.seekg(skipahead, sas.cur);
-          skipahead = 0;
-        }
-
-        // check if eof is reached sas.eof() did not work
-        if ((sas_size - sas.tellg()) == 0) {
-          // Rcout << "eof reached" << std::endl;
-          break;
-        }
+    case CC_NUMERIC:
+      SET_VECTOR_ELT(df, i, NumericVector(no_init(nn)));
+      sink.dbl[i] = REAL(VECTOR_ELT(df, i));
+      break;
 
-        ++ii;
+    default:
+      if (type == 1) {
+        SET_VECTOR_ELT(df, i, NumericVector(no_init(nn)));
+        sink.dbl[i] = REAL(VECTOR_ELT(df, i));
+      } else {
+        SET_VECTOR_ELT(df, i, CharacterVector(no_init(nn)));
+        sink.chr[i] = VECTOR_ELT(df, i);
       }
+      break;
     }
+  }
 
-    // close file. compressed data is imported from a different file
-    sas.close();
-
-
-    if ((compr == 1) || (compr == 2)) {
-
-      if (debug)
-        Rcout << "compression" << std::endl;
-
-      std::ifstream sas(tempstr, std::ios::in | std::ios::binary | std::ios::ate);
-
-      if (sas) {
-
-        sas_size = sas.tellg();
-        sas.seekg(0, std::ios_base::beg);
-
-        auto i = -1;
-        for (int64_t iii = 0; iii < n; ++iii) {
-
-          if (debug && i == 0)
-            Rcout << "row: " << i << " --------------------" <<std::endl;
-
-
-          /* nmin is not a c vector starting at 0. i is initialized at -1 so will
-           * be 0 once its bigger than nmin. This allows to import only the
-           * selected rows. Once nmax is reached, import will stop.
-           */
-
-          bool keepr = false;
-          if (any_keepr(rvec, iii)) {
-            keepr = true;
-            ++i;
-          }
-
-          if (iii > nmax) break;
-
-          // for completeness
-          valid[iii] = true;
-          deleted[iii] = false;
-
-          auto skipahead = 0;
-          for (auto j = 0; j < k; ++j) {
-
-            auto ord = ordered[j];
-            auto wid = colwidth[ord];
-            auto typ = vartyps[ord];
-            auto col = cvec[ord];
-
-            bool keepc = col >= 0;
-
-            if (debug && i == 0) {
-              Rcout << col << " : " << wid << " : " << typ << std::endl;
-              Rcout << "row i / iii / keepr: " << i << " " << iii <<" " << keepr << std::endl;
-            }
-
-            if ((wid > 0) && (wid < 8) && (typ == 1)) {
-
-
-              if (keepc) {
-
-                double val_d = 0.0;
-                val_d = readbinlen(val_d, sas, 0, wid);
-
-                if (debug && i == 0)
-                  Rcout << val_d << std::endl;
-
-                if (std::isnan(val_d))
-                  REAL(VECTOR_ELT(df,col))[i] = NA_REAL;
-                else
-                  REAL(VECTOR_ELT(df,col))[i] = val_d;
-              } else {
-                skipahead += wid;
-              }
-
-            }
-
-            if ((wid == 8) && (typ == 1)) {
-
-              if (keepc) {
-
-                if (skipahead > 0) {
-                  sas.seekg(skipahead, std::ios_base::cur);
-                  skipahead = 0;
-                }
-
-                double val_d = 0.0;
-                val_d = readbin(val_d, sas, swapit);
-
-                if (debug && i == 0)
-                  Rcout << val_d << std::endl;
-
-                if (std::isnan(val_d))
-                  REAL(VECTOR_ELT(df,col))[i] = NA_REAL;
-                else
-                  REAL(VECTOR_ELT(df,col))[i] = val_d;
-              } else {
-                skipahead += wid;
-              }
-
-            }
+  // 2. fill it with data
 
-            if ((wid > 0) && (typ == 2)) {
+  // sas provides two modes, compressed and uncompressed data. compressed
+  // data consists of single rows stored in subheaders, these are looked up in
+  // rowrefs. uncompressed data is stored in pages and might contain deleted
+  // rows.
+  if (debug)
+    Rcout << (f.compr > 0 ? "compression" : "no compression") << std::endl;
 
-              if (keepc) {
+  int64_t badrows = 0;
 
-                if (skipahead > 0) {
-                  sas.seekg(skipahead, std::ios_base::cur);
-                  skipahead = 0;
-                }
+  if (!is_lazy)
+    sas_check(reader, reader.decode(rows, select, sink, badrows));
 
-                std::string val_s(wid, ' ');
-                val_s = readstring(val_s, sas);
+  if (badrows > 0)
+    warning("%d rows had an unexpected size after decompression", badrows);
 
-                val_s = std::regex_replace(val_s,
-                                           std::regex(" +$"), "$1");
+  // labels of the format are UTF-8, values without label are recoded in R
+  for (uint32_t i = 0; i < kk; ++i) {
+    FormatFactor* fac = sink.factor[i].get();
+    if (!fac) continue;
 
-                if (debug && i == 0)
-                  Rcout << val_s << std::endl;
+    CharacterVector levels(fac->levels.size());
+    for (size_t l = 0; l < fac->levels.size(); ++l)
+      levels[l] = Rf_mkCharCE(fac->levels[l].c_str(),
+                              l < fac->nlabels ? CE_UTF8 : CE_NATIVE);
 
-                if (empty_to_na && val_s.empty())
-                  as<CharacterVector>(df[col])[i] = NA_STRING;
-                else
-                  as<CharacterVector>(df[col])[i] = val_s;
+    SEXP vec = VECTOR_ELT(df, i);
+    Rf_setAttrib(vec, R_LevelsSymbol, levels);
+    Rf_setAttrib(vec, R_ClassSymbol, Rf_mkString("factor"));
+  }
 
-              } else {
-                skipahead += wid;
-              }
+  for (uint32_t i = 0; i < kk && !is_lazy; ++i)
+    sink.special.attach(VECTOR_ELT(df, i), i);
 
-            }
-          }
+  if (sink.coerced > 0)
+    warning("%d values could not be converted to the requested class and are NA",
+            sink.coerced);
 
-          // end of row reached, skip to end if required
-          if (skipahead > 0) {
-            sas.seekg(skipahead, sas.cur);
-            skipahead = 0;
-          }
+  if (debug) {
+    Rcpp::Rcout << nn << " " << kk << std::endl;
+  }
 
-          // check if eof is reached sas.eof() did not work
-          if ((sas_size - sas.tellg()) == 0) {
-            // Rcout << "eof reached" << std::endl;
-            break;
-          }
+  // 3. Create a data.frame
+  if (nn > 0)
+    df.attr("row.names") = rvec;
+
+  if (varnames.size() == kk)
+    df.attr("names") = varnames;
+
+  df.attr("class") = "data.frame";
+
+  if (varnames.size() > kk)
+    df.attr("varnames") = varnames;
+
+  df.attr("labels") = labels;
+  df.attr("formats") = formats;
+  df.attr("created") = f.created;
+  df.attr("created2") = f.created2;
+  df.attr("modified") = f.modified;
+  df.attr("modified2") = f.modified2;
+  df.attr("thrdts") = f.thrdts;
+
+  df.attr("sasfile") = f.sasfile;
+  df.attr("dataset") = f.dataset;
+  df.attr("filetype") = f.filetype;
+  df.attr("compression") = f.compression;
+  df.attr("proc") = f.proc;
+  df.attr("sw") = f.sw;
+  df.attr("sasrel") = f.sasrel;
+  df.attr("sasserv") = f.sasserv;
+  df.attr("osver") = f.osver;
+  df.attr("osmaker") = f.osmaker;
+  df.attr("osname") = f.osname;
+  df.attr("encoding") = f.enc;
+  df.attr("fmtkeys") = fmtkeys;
+  df.attr("fmt32") = fmt32s;
+  df.attr("ifmt32") = ifmt32s;
+
+  df.attr("rowcount") = nn;
+  df.attr("rowlength") = f.rowlength;
+  df.attr("deleted_rows") = f.delobs;
+  df.attr("colwidth") = colwidth;
+  df.attr("vartyps") = vartyps;
+  df.attr("c8vec") = c8vec;
+
+  df.attr("headersize") = f.headersize;
+  df.attr("pagesize") = f.pagesize;
+
+  df.attr("cvec") = cvec;
+  df.attr("rvec") = rvec;
+  df.attr("deleted") = deleted;
+  df.attr("valid") = valid;
+
+  if (debug) {
+    df.attr("cnidx") = f.cnidx;
+    df.attr("cnoff") = f.cnoff;
+    df.attr("cnlen") = f.cnlen;
+    df.attr("cnzer") = f.cnzer;
+  }
 
-        }
+  if (pagemap) {
+    if (f.partial) stop("page maps require a full page scan");
+    df.attr("pagemap") = pagemap_list(sas_pagemap(f));
+  }
 
-        sas.close();
+  // the profile ends here, columns decoded later are not counted
+  if (is_lazy) {
+    reader.log().profile = nullptr;
+    df.attr("lazy") = true;
+  }
 
-      } else {
-        warning("could not read from compressed pages");
-      }
+  if (prof)
+    df.attr("profile") = profile_list(*prof, f);
 
-    }
 
-    // Rf_PrintValue(df);
+  return(df);
+}
 
-    if (!debug) {
-      if ( remove(tempstr.c_str()) != 0 )
-        warning("Could not remove temporary file containing",
-                "uncompressed data");
-    }
+//' Reads SAS data files
+//'
+//' @param input The full systempath to the sas7bdat file you want to import
+//' or a raw vector containing the file.
+//' @param debug print debug information
+//' @param selectrows_ integer vector of selected rows
+//' @param selectcols_ character vector of selected rows
+//' @param empty_to_na logical convert '' to NA_character_
+//' @param convert logical convert missings `.I` and `.M` to Inf and -Inf
+//' @param profile logical attach timings and I/O counters
+//' @param col_classes_ named character vector of column classes
+//' @param narrow logical read integer valued numerics as integer
+//' @param where_ list of predicates with elements col, op and value, and
+//' the name of a column sorted in ascending order in sorted
+//' @param zonemap_ path of the zone map file, "" for a zone map in memory
+//' @param index_ path of the index file, "" for an index in memory
+//' @param sample_ list with elements n or frac, seed, pages and skip_deleted
+//' @param n_max numeric read the first n_max rows that are not deleted, -1
+//' reads all rows
+//' @param lazy_ list with elements skip_deleted and recode. Columns are
+//' decoded on first access
+//' @param pagemap logical attach the page map, see sas_refresh()
+//' @param pages_ numeric vector with the first and last page to read,
+//' starting at 0. Replaces selectrows_
+//' @param formats_ named list of user defined formats, see read.sas7bcat()
+//' @import Rcpp
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas(SEXP input,
+                   const bool debug,
+                   Nullable<NumericVector> selectrows_,
+                   Nullable<CharacterVector> selectcols_,
+                   const bool empty_to_na,
+                   const bool convert,
+                   const bool profile,
+                   Nullable<CharacterVector> col_classes_,
+                   const bool narrow,
+                   Nullable<List> where_,
+                   Nullable<CharacterVector> zonemap_,
+                   Nullable<CharacterVector> index_,
+                   Nullable<List> sample_,
+                   const double n_max,
+                   Nullable<List> lazy_,
+                   const bool pagemap,
+                   Nullable<NumericVector> pages_,
+                   Nullable<List> formats_)
+{
+  // lazy columns keep the reader after return
+  std::shared_ptr<SasLazy> lazy = std::make_shared<SasLazy>();
+  SasReader& reader = lazy->reader;
+
+  // the page scan stops once enough rows are found
+  if (n_max >= 0) reader.max_rows(n_max);
+
+  // or after the last page of the range
+  int64_t from = -1, to = -1;
+  if (pages_.isNotNull()) {
+    // whole numbers below 2^53, checked in R
+    std::vector<double> pages = as<std::vector<double>>(pages_);
+    from = pages[0];
+    to = pages[1];
+    reader.max_pages(to + 1);
+  }
 
-    if (debug) {
-      Rcpp::Rcout << nn << " " << kk << std::endl;
-    }
+  SasProfile prof;
+  if (profile) reader.log().profile = &prof;
 
-    // 3. Create a data.frame
-    if (nn > 0)
-      df.attr("row.names") = rvec;
-
-    if (varnames.size() == kk)
-      df.attr("names") = varnames;
-
-    df.attr("class") = "data.frame";
-
-    if (varnames.size() > kk)
-      df.attr("varnames") = varnames;
-
-    df.attr("labels") = labels;
-    df.attr("formats") = formats;
-    df.attr("created") = created;
-    df.attr("created2") = created2;
-    df.attr("modified") = modified;
-    df.attr("modified2") = modified2;
-    df.attr("thrdts") = thrdts;
-
-    df.attr("sasfile") = sasfile;
-    df.attr("dataset") = dataset;
-    df.attr("filetype") = filetype;
-    df.attr("compression") = compression;
-    df.attr("proc") = proc;
-    df.attr("sw") = sw;
-    df.attr("sasrel") = sasrel;
-    df.attr("sasserv") = sasserv;
-    df.attr("osver") = osver;
-    df.attr("osmaker") = osmaker;
-    df.attr("osname") = osname;
-    df.attr("encoding") = enc;
-    df.attr("fmtkeys") = fmtkeys;
-    df.attr("fmt32") = fmt32s;
-    df.attr("ifmt32") = ifmt32s;
-
-    df.attr("rowcount") = nn;
-    df.attr("rowlength") = rowlength;
-    df.attr("deleted_rows") = delobs;
-    df.attr("colwidth") = colwidth_kk;
-    // df.attr("coloffset") = coloffset;
-    df.attr("vartyps") = vartyps_kk;
-    df.attr("c8vec") = c8vec;
-
-    df.attr("headersize") = headersize;
-    df.attr("pagesize") = pagesize;
-
-    // if (kk >= 0 && (uint64_t)kk == nn) {
-    //   // deleted needs to be reduced if we ever skip the first row
-    //   deleted.resize(nn);
-    // }
-
-    df.attr("cvec") = cvec;
-    df.attr("rvec") = rvec;
-    df.attr("deleted") = deleted;
-    df.attr("valid") = valid;
-
-    if (debug) {
-      df.attr("cnidx") = cnidx;
-      df.attr("cnoff") = cnoff;
-      df.attr("cnlen") = cnlen;
-      df.attr("cnzer") = cnzer;
-    }
+  // raw vectors are parsed in place, everything else is a path on disk
+  sas_open_input(reader, input, debug);
 
+  // rows of a page range are consecutive. Row positions are counted from the
+  // start of the file, partitions of a file return distinct row names.
+  if (pages_.isNotNull()) {
+    int64_t first = 0, count = 0;
+    sas_page_rows(reader.meta(), from, to, first, count);
 
-    return(df);
+    if (debug)
+      Rcout << "pages " << from << " to " << to << ": " << count <<
+        " rows starting at " << first << std::endl;
 
-  } else {
-    return (-1);
+    // row -1 selects no rows
+    NumericVector rows(count > 0 ? count : 1, -1.0);
+    for (int64_t i = 0; i < count; ++i) rows[i] = first + i;
+    selectrows_ = rows;
   }
+
+  return sas_data(lazy, input, profile ? &prof : nullptr, debug, selectrows_,
+                  selectcols_, empty_to_na, convert, col_classes_, narrow,
+                  where_, zonemap_, index_, sample_, n_max, lazy_, pagemap,
+                  formats_);
 }
+
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sas.h"
+#include "sasarrow.h"
+
+using namespace Rcpp;
+
+// structs are passed either as external pointers (nanoarrow, arrow >= 6) or
+// as addresses stored in a double or a character string (older arrow)
+template <typename T>
+T* arrow_ptr(SEXP x, const char* what)
+{
+  void* ptr = nullptr;
+
+  switch (TYPEOF(x)) {
+  case EXTPTRSXP:
+    ptr = R_ExternalPtrAddr(x);
+    break;
+  case REALSXP:
+    if (XLENGTH(x) == 1) ptr = (void*)(uintptr_t)REAL(x)[0];
+    break;
+  case STRSXP:
+    if (XLENGTH(x) == 1)
+      ptr = (void*)(uintptr_t)std::strtoull(CHAR(STRING_ELT(x, 0)), nullptr, 10);
+    break;
+  }
+
+  if (!ptr)
+    stop("%s must be a pointer to an allocated struct", what);
+
+  return (T*)ptr;
+}
+
+
+//' Exports SAS data files through the Arrow C Data Interface
+//'
+//' @param input The full systempath to the sas7bdat file you want to import
+//' or a raw vector containing the file.
+//' @param array_ptr,schema_ptr pointers to ArrowArray and ArrowSchema
+//' @param selectrows_ integer vector of selected rows
+//' @param selectcols_ character vector of selected rows
+//' @param remove_deleted logical skip deleted rows
+//' @param empty_to_na logical export '' as null
+//' @param convert logical convert missings `.I` and `.M` to Inf and -Inf
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+double readsas_arrow(SEXP input, SEXP array_ptr, SEXP schema_ptr,
+                     Nullable<NumericVector> selectrows_,
+                     Nullable<CharacterVector> selectcols_,
+                     const bool remove_deleted,
+                     const bool empty_to_na,
+                     const bool convert)
+{
+  ArrowArray* array = arrow_ptr<ArrowArray>(array_ptr, "array");
+  ArrowSchema* schema = arrow_ptr<ArrowSchema>(schema_ptr, "schema");
+
+  if (array->release || schema->release)
+    stop("array and schema must not contain data");
+
+  SasReader reader;
+  sas_open_input(reader, input, false);
+  const SasFile& f = reader.meta();
+
+  // columns
+  std::vector<int64_t> cols;
+  bool selectvars = selectcols_.isNotNull();
+  std::unordered_set<std::string> select_cols = select_set(selectcols_);
+
+  for (size_t i = 0; i < f.varnames.size() && i < f.vartyps.size(); ++i) {
+    if (selectvars && !select_cols.count(f.varnames[i]))
+      continue;
+    cols.push_back(i);
+  }
+
+  // rows. Deleted rows and rows not found in the file are skipped.
+  std::vector<int64_t> rows;
+  int64_t avail = std::min(f.n, sas_rows_available(f));
+
+  if (selectrows_.isNull()) {
+    for (int64_t r = 0; r < avail; ++r)
+      if (!remove_deleted || !sas_row_deleted(f, r)) rows.push_back(r);
+  } else {
+    NumericVector selectrows(selectrows_);
+
+    // row 0 selects no rows
+    if (any_keepr(selectrows, -1)) selectrows = NumericVector(0);
+
+    for (R_xlen_t i = 0; i < selectrows.size(); ++i) {
+      int64_t r = selectrows[i];
+      if (r < 0 || r >= avail) continue;
+      if (!remove_deleted || !sas_row_deleted(f, r)) rows.push_back(r);
+    }
+  }
+
+  std::vector<SasArrowColumn> out;
+  std::unique_ptr<std::streambuf> buf = f.src.open();
+  std::istream sas(buf.get());
+  int64_t badrows = sas_arrow_decode(f, sas, rows, cols, convert, empty_to_na,
+                                     out);
+
+  if (badrows > 0)
+    warning("%d rows had an unexpected size after decompression", badrows);
+
+  sas_arrow_export(out, rows.size(), array, schema);
+
+  return rows.size();
+}
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Columns of read.sas(cache = ...). A cache is written once after a read and
+ * memory mapped by later reads. Numeric columns point into the mapping and
+ * are copied only when modified, character columns are created from the
+ * mapped bytes on first access.
+ */
+
+#include <memory>
+
+#include "sas.h"
+#include "sasaltrep.h"
+#include "sascache.h"
+
+using namespace Rcpp;
+
+#ifdef SAS_ALTREP
+
+// data1 of a cached column points to this, data2 holds a private copy
+struct CacheColumn {
+  std::shared_ptr<SasCache> cache;
+  size_t j;
+};
+
+static R_altrep_class_t cache_real, cache_string;
+
+static CacheColumn* cache_column(SEXP x)
+{
+  return static_cast<CacheColumn*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+static void cache_finalize(SEXP ptr)
+{
+  delete static_cast<CacheColumn*>(R_ExternalPtrAddr(ptr));
+  R_ClearExternalPtr(ptr);
+}
+
+static SEXP cache_new(const std::shared_ptr<SasCache>& cache, size_t j)
+{
+  SEXP ptr = PROTECT(R_MakeExternalPtr(new CacheColumn{cache, j}, R_NilValue,
+                                       R_NilValue));
+  R_RegisterCFinalizerEx(ptr, cache_finalize, TRUE);
+
+  SEXP x = R_new_altrep(cache->cols[j].type == 0 ? cache_real : cache_string,
+                        ptr, R_NilValue);
+  UNPROTECT(1);
+
+  return x;
+}
+
+// copy of the column, kept in data2
+static SEXP cache_data(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return data;
+
+  CacheColumn* cc = cache_column(x);
+  const SasCache& cache = *cc->cache;
+  size_t j = cc->j;
+  R_xlen_t n = cache.nrow();
+
+  if (cache.cols[j].type == 0) {
+    data = PROTECT(Rf_allocVector(REALSXP, n));
+    std::memcpy(REAL(data), cache.num(j), n * sizeof(double));
+  } else {
+    const int64_t* off = cache.offsets(j);
+    const char* na = cache.na(j);
+    const char* chars = cache.chars(j);
+    cetype_t ce = cache.cols[j].utf8 ? CE_UTF8 : CE_NATIVE;
+
+    data = PROTECT(Rf_allocVector(STRSXP, n));
+    for (R_xlen_t i = 0; i < n; ++i) {
+      if (off[i] > off[i + 1] || off[i + 1] > off[n]) {
+        UNPROTECT(1);
+        Rf_error("damaged cache");
+      }
+      if (na[i])
+        SET_STRING_ELT(data, i, NA_STRING);
+      else
+        SET_STRING_ELT(data, i, Rf_mkCharLenCE(chars + off[i],
+                                               off[i + 1] - off[i], ce));
+    }
+  }
+
+  R_set_altrep_data2(x, data);
+  UNPROTECT(1);
+
+  return data;
+}
+
+static R_xlen_t cache_length(SEXP x)
+{
+  return cache_column(x)->cache->nrow();
+}
+
+static Rboolean cache_inspect(SEXP x, int, int, int,
+                              void (*)(SEXP, int, int, int))
+{
+  Rprintf("readsas cached column %d (%s)\n", (int)cache_column(x)->j,
+          R_altrep_data2(x) == R_NilValue ? "mapped" : "copied");
+  return TRUE;
+}
+
+// saved as an ordinary vector
+static SEXP cache_serialized_state(SEXP x)
+{
+  return cache_data(x);
+}
+
+static SEXP cache_unserialize(SEXP, SEXP state)
+{
+  return state;
+}
+
+// unmodified columns share the mapping
+static SEXP cache_duplicate(SEXP x, Rboolean)
+{
+  if (R_altrep_data2(x) != R_NilValue) return nullptr;
+  CacheColumn* cc = cache_column(x);
+  return cache_new(cc->cache, cc->j);
+}
+
+static void* cache_real_dataptr(SEXP x, Rboolean writeable)
+{
+  if (!writeable && R_altrep_data2(x) == R_NilValue) {
+    CacheColumn* cc = cache_column(x);
+    return (void*)cc->cache->num(cc->j);
+  }
+  return REAL(cache_data(x));
+}
+
+static const void* cache_real_dataptr_or_null(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return REAL(data);
+  CacheColumn* cc = cache_column(x);
+  return cc->cache->num(cc->j);
+}
+
+static double cache_real_elt(SEXP x, R_xlen_t i)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return REAL(data)[i];
+  CacheColumn* cc = cache_column(x);
+  return cc->cache->num(cc->j)[i];
+}
+
+static R_xlen_t cache_real_get_region(SEXP x, R_xlen_t i, R_xlen_t n,
+                                      double* buf)
+{
+  const double* p = (const double*)cache_real_dataptr_or_null(x);
+  R_xlen_t k = std::max<R_xlen_t>(0, std::min(n, cache_length(x) - i));
+  std::memcpy(buf, p + i, k * sizeof(double));
+  return k;
+}
+
+static void* cache_string_dataptr(SEXP x, Rboolean)
+{
+  return (void*)STRING_PTR_RO(cache_data(x));
+}
+
+static const void* cache_string_dataptr_or_null(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+  return data == R_NilValue ? nullptr : (const void*)STRING_PTR_RO(data);
+}
+
+static SEXP cache_string_elt(SEXP x, R_xlen_t i)
+{
+  return STRING_ELT(cache_data(x), i);
+}
+
+static void cache_string_set_elt(SEXP x, R_xlen_t i, SEXP v)
+{
+  SET_STRING_ELT(cache_data(x), i, v);
+}
+
+static void cache_methods(R_altrep_class_t cls)
+{
+  R_set_altrep_Length_method(cls, cache_length);
+  R_set_altrep_Inspect_method(cls, cache_inspect);
+  R_set_altrep_Serialized_state_method(cls, cache_serialized_state);
+  R_set_altrep_Unserialize_method(cls, cache_unserialize);
+  R_set_altrep_Duplicate_method(cls, cache_duplicate);
+}
+
+#endif
+
+//' Open a column cache
+//'
+//' @param path path of the cache
+//' @param source path of the sas7bdat file
+//' @return NULL if the cache is missing, damaged or belongs to another
+//' version of source. Otherwise a list with the meta data as raw vector and
+//' the mapped columns.
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+SEXP readsas_cache_open(std::string path, std::string source)
+{
+#ifdef SAS_ALTREP
+  std::shared_ptr<SasCache> cache = std::make_shared<SasCache>();
+  if (!cache->open(path, source)) return R_NilValue;
+
+  RawVector meta(cache->header->meta_size);
+  std::copy(cache->meta(), cache->meta() + meta.size(), meta.begin());
+
+  List cols(cache->ncol());
+  for (uint32_t j = 0; j < cache->ncol(); ++j)
+    cols[j] = cache_new(cache, j);
+
+  return List::create(_["meta"] = meta, _["cols"] = cols);
+#else
+  return R_NilValue;
+#endif
+}
+
+//' Write a column cache
+//'
+//' @param path path of the cache
+//' @param source path of the sas7bdat file
+//' @param data list of numeric and character vectors of equal length
+//' @param meta raw vector stored with the columns
+//' @return TRUE if the cache was written
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+bool readsas_cache_write(std::string path, std::string source, List data,
+                         RawVector meta)
+{
+  R_xlen_t n = data.size() ? Rf_xlength(data[0]) : 0;
+
+  for (R_xlen_t j = 0; j < data.size(); ++j) {
+    int type = TYPEOF(data[j]);
+    if ((type != REALSXP && type != STRSXP) || Rf_xlength(data[j]) != n)
+      return false;
+  }
+
+  SasCacheWriter out;
+  if (!out.open(path, source, n, data.size())) return false;
+
+  std::vector<int64_t> offsets;
+  std::vector<char> na;
+  std::string chars;
+
+  for (R_xlen_t j = 0; j < data.size(); ++j) {
+    SEXP x = data[j];
+
+    if (TYPEOF(x) == REALSXP) {
+      out.num(REAL(x));
+      continue;
+    }
+
+    offsets.assign(1, 0);
+    na.assign(n, 0);
+    chars.clear();
+    bool utf8 = false;
+
+    for (R_xlen_t i = 0; i < n; ++i) {
+      SEXP s = STRING_ELT(x, i);
+      if (s == NA_STRING) {
+        na[i] = 1;
+      } else {
+        chars.append(CHAR(s), LENGTH(s));
+        if (Rf_getCharCE(s) == CE_UTF8) utf8 = true;
+      }
+      offsets.push_back(chars.size());
+    }
+
+    out.str(offsets, na, chars, utf8);
+  }
+
+  return out.finish((const char*)RAW(meta), meta.size());
+}
+
+// [[Rcpp::init]]
+void readsas_cache_init(DllInfo* dll)
+{
+#ifdef SAS_ALTREP
+  cache_real = R_make_altreal_class("cache_real", "readsas", dll);
+  cache_methods(cache_real);
+  R_set_altvec_Dataptr_method(cache_real, cache_real_dataptr);
+  R_set_altvec_Dataptr_or_null_method(cache_real, cache_real_dataptr_or_null);
+  R_set_altreal_Elt_method(cache_real, cache_real_elt);
+  R_set_altreal_Get_region_method(cache_real, cache_real_get_region);
+
+  cache_string = R_make_altstring_class("cache_string", "readsas", dll);
+  cache_methods(cache_string);
+  R_set_altvec_Dataptr_method(cache_string, cache_string_dataptr);
+  R_set_altvec_Dataptr_or_null_method(cache_string,
+                                      cache_string_dataptr_or_null);
+  R_set_altstring_Elt_method(cache_string, cache_string_elt);
+  R_set_altstring_Set_elt_method(cache_string, cache_string_set_elt);
+#else
+  (void)dll;
+#endif
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sas.h"
+
+using namespace Rcpp;
+
+//' Reads the formats of a SAS catalog
+//'
+//' @param input The full systempath to the sas7bcat file or a raw vector
+//' containing the file.
+//' @param debug print debug information
+//' @return named list of data.frames with start, end and label, see
+//' format_list(). The attribute encoding holds the catalog encoding.
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_formats(SEXP input, const bool debug)
+{
+  SasSource src;
+  if (TYPEOF(input) == RAWSXP) {
+    src.data = (const char*)RAW(input);
+    src.size = XLENGTH(input);
+  } else {
+    src.path = Rcpp::as<std::string>(input);
+  }
+
+  std::unique_ptr<std::streambuf> buf = src.open();
+  if (!buf) stop("could not open file");
+  std::istream sas(buf.get());
+
+  SasLog log;
+  if (debug) log.debug = &Rcout;
+
+  SasCatalog cat;
+  try {
+    readsas_catalog(sas, log, cat);
+  } catch (SasError& e) {
+    stop(e.what());
+  }
+
+  for (auto& msg : log.warnings)
+    warning(msg);
+
+  List formats(cat.formats.size());
+  CharacterVector names(cat.formats.size());
+  for (size_t i = 0; i < cat.formats.size(); ++i) {
+    formats[i] = format_list(cat.formats[i]);
+    names[i] = cat.formats[i].name;
+  }
+
+  formats.attr("names") = names;
+  formats.attr("encoding") = cat.enc;
+
+  return formats;
+}
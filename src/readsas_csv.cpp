@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sas.h"
+#include "sascsv.h"
+
+using namespace Rcpp;
+
+//' Writes SAS data files to csv
+//'
+//' @param input The full systempath to the sas7bdat file you want to import
+//' or a raw vector containing the file.
+//' @param out output file
+//' @param selectcols_ character vector of selected columns
+//' @param sep field separator
+//' @param quote logical quote all strings
+//' @param na string written for missing values
+//' @param convert_dates logical format dates, datetimes and times
+//' @param remove_deleted logical skip deleted rows
+//' @param convert logical convert missings `.I` and `.M` to Inf and -Inf
+//' @param nthreads number of threads used for formatting
+//' @param chunk rows decoded at once
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+double readsas_csv(SEXP input, std::string out,
+                   Nullable<CharacterVector> selectcols_,
+                   std::string sep, const bool quote, std::string na,
+                   const bool convert_dates, const bool remove_deleted,
+                   const bool convert, int nthreads, double chunk)
+{
+  SasReader reader;
+  sas_open_input(reader, input, false);
+
+  std::vector<int64_t> cols;
+  if (selectcols_.isNotNull()) {
+    CharacterVector selectcols(selectcols_);
+    for (R_xlen_t i = 0; i < selectcols.size(); ++i) {
+      std::string name = Rcpp::as<std::string>(selectcols[i]);
+      int64_t c = reader.column(name);
+      if (c < 0)
+        stop("Variable %s was not found in sas-file.", name);
+      cols.push_back(c);
+    }
+  } else {
+    for (int64_t i = 0; i < reader.ncol(); ++i) cols.push_back(i);
+  }
+
+  SasCsvOptions opt;
+  opt.sep = sep.empty() ? ',' : sep[0];
+  opt.quote = quote;
+  opt.na = na;
+  opt.dates = convert_dates;
+  opt.skip_deleted = remove_deleted;
+  opt.convert = convert;
+  opt.nthreads = nthreads;
+  opt.chunk = chunk;
+
+  std::ofstream file(out, std::ios::binary);
+  if (!file)
+    stop("could not open %s", out);
+
+  int64_t rows = 0;
+  int status = sas_write_csv(reader, cols, file, opt, rows);
+
+  if (status == SAS_ERROR_WRITE)
+    stop("could not write %s", out);
+  sas_check(reader, status);
+
+  return rows;
+}
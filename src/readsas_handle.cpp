@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Handles of sas_open(). A handle keeps the reader of a file: the meta data,
+ * the page map and a cache of the most recently read pages. Queries with
+ * sas_read() skip the header and page scan and read cached pages from memory.
+ */
+
+#include "sas.h"
+
+using namespace Rcpp;
+
+// address of an external pointer created by readsas_open()
+struct SasHandle {
+  std::shared_ptr<SasLazy> lazy;
+};
+
+static void handle_finalize(SEXP ptr)
+{
+  delete static_cast<SasHandle*>(R_ExternalPtrAddr(ptr));
+  R_ClearExternalPtr(ptr);
+}
+
+static SasHandle* sas_handle(SEXP handle)
+{
+  if (TYPEOF(handle) != EXTPTRSXP || !R_ExternalPtrAddr(handle))
+    stop("invalid or closed handle, see sas_open()");
+  return static_cast<SasHandle*>(R_ExternalPtrAddr(handle));
+}
+
+//' Open a file for repeated reads
+//'
+//' @param input The full systempath to the sas7bdat file or a raw vector
+//' containing the file.
+//' @param debug print debug information
+//' @param pages number of pages kept in memory
+//' @return external pointer with attributes nrow and varnames
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+SEXP readsas_open(SEXP input, const bool debug, const double pages)
+{
+  std::unique_ptr<SasHandle> h(new SasHandle{std::make_shared<SasLazy>()});
+  SasReader& reader = h->lazy->reader;
+
+  reader.page_cache(pages > 0 ? (size_t)pages : 0);
+  sas_open_input(reader, input, debug);
+  const SasFile& f = reader.meta();
+
+  // raw input is parsed in place and must stay alive
+  SEXP ptr = PROTECT(R_MakeExternalPtr(h.release(), R_NilValue,
+                                       TYPEOF(input) == RAWSXP ? input :
+                                       R_NilValue));
+  R_RegisterCFinalizerEx(ptr, handle_finalize, TRUE);
+
+  Rf_setAttrib(ptr, Rf_install("nrow"), wrap((double)f.n));
+  Rf_setAttrib(ptr, Rf_install("varnames"), wrap(f.varnames));
+  UNPROTECT(1);
+
+  return ptr;
+}
+
+//' Reads SAS data from an open handle
+//'
+//' @param handle external pointer of readsas_open()
+//' @param debug print debug information
+//' @param selectrows_ integer vector of selected rows
+//' @param selectcols_ character vector of selected rows
+//' @param empty_to_na logical convert '' to NA_character_
+//' @param convert logical convert missings `.I` and `.M` to Inf and -Inf
+//' @param col_classes_ named character vector of column classes
+//' @param narrow logical read integer valued numerics as integer
+//' @param where_ list of predicates with elements col, op and value, and
+//' the name of a column sorted in ascending order in sorted
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_read(SEXP handle,
+                        const bool debug,
+                        Nullable<NumericVector> selectrows_,
+                        Nullable<CharacterVector> selectcols_,
+                        const bool empty_to_na,
+                        const bool convert,
+                        Nullable<CharacterVector> col_classes_,
+                        const bool narrow,
+                        Nullable<List> where_)
+{
+  SasHandle* h = sas_handle(handle);
+  h->lazy->reader.log().debug = debug ? &Rcout : nullptr;
+
+  return sas_data(h->lazy, R_ExternalPtrProtected(handle), nullptr, debug,
+                  selectrows_, selectcols_, empty_to_na, convert, col_classes_,
+                  narrow, where_, R_NilValue, R_NilValue, R_NilValue, -1,
+                  R_NilValue, false, R_NilValue);
+}
+
+//' Close a handle
+//'
+//' @param handle external pointer of readsas_open()
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+void readsas_close(SEXP handle)
+{
+  if (TYPEOF(handle) == EXTPTRSXP) handle_finalize(handle);
+}
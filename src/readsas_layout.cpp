@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sas.h"
+
+using namespace Rcpp;
+
+//' Page layout of a file
+//'
+//' @param input The full systempath to the sas7bdat file or a raw vector
+//' containing the file.
+//' @param debug print debug information
+//' @return data.frame with page, type, rows and first_row. Pages and rows
+//' start at 0.
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_layout(SEXP input, const bool debug)
+{
+  // only the header, the meta data and the page headers are read
+  SasReader reader;
+  sas_open_input(reader, input, debug);
+  const SasFile& f = reader.meta();
+
+  R_xlen_t np = f.pages.size();
+  NumericVector page(no_init(np)), rows(no_init(np)), first_row(no_init(np));
+  IntegerVector type(no_init(np));
+
+  for (R_xlen_t pg = 0; pg < np; ++pg) {
+    int64_t first = 0, count = 0;
+    sas_page_rows(f, pg, pg, first, count);
+
+    page[pg] = pg;
+    type[pg] = f.pages[pg].type;
+    rows[pg] = count;
+    first_row[pg] = first;
+  }
+
+  List df = List::create(
+    _["page"] = page,
+    _["type"] = type,
+    _["rows"] = rows,
+    _["first_row"] = first_row
+  );
+
+  df.attr("row.names") = IntegerVector::create(NA_INTEGER, -(int)np);
+  df.attr("class") = "data.frame";
+
+  df.attr("nrow") = (double)f.n;
+  df.attr("ncol") = (double)f.vartyps.size();
+  df.attr("pagecount") = (double)f.pagecount;
+  df.attr("pagesize") = f.pagesize;
+  df.attr("headersize") = f.headersize;
+  df.attr("compression") = f.compression;
+
+  return df;
+}
+
+//' Row addressing of a synthetic uncompressed file
+//'
+//' Pages and row counts are made up, no file is read. Allows to check the
+//' 64 bit row and page addressing without a file with billions of rows.
+//'
+//' @param pagerows rows on each page
+//' @param rowlength row length in bytes
+//' @param rows_ rows to look up, start at 0
+//' @param from,to page range passed to sas_page_rows()
+//' @return list with page, row on the page and file position of each row,
+//' NA if the row is not found, and first and count of the page range
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_rowpos(NumericVector pagerows, const double rowlength,
+                          NumericVector rows_, const double from,
+                          const double to)
+{
+  SasFile f;
+  f.headersize = 65536;
+  f.pagesize = 65536;
+  f.rowlength = (uint64_t)rowlength;
+  f.dataoffset = 256;
+
+  int64_t total = 0;
+  for (R_xlen_t pg = 0; pg < pagerows.size(); ++pg) {
+    SasPage p;
+    p.rows = (int64_t)pagerows[pg];
+    p.data_pos = f.headersize + f.pagesize * (uint64_t)pg + 40;
+    f.pages.push_back(p);
+
+    total += p.rows;
+    f.totalrowsvec.push_back(total);
+  }
+  f.pagecount = f.pages.size();
+  f.n = total;
+
+  R_xlen_t n = rows_.size();
+  NumericVector page(no_init(n)), row(no_init(n)), pos(no_init(n));
+
+  for (R_xlen_t i = 0; i < n; ++i) {
+    uint64_t p = 0;
+    int64_t pg = 0, ii = 0;
+    if (sas_row_pos(f, (int64_t)rows_[i], p, pg, ii)) {
+      page[i] = pg;
+      row[i] = ii;
+      pos[i] = p;
+    } else {
+      page[i] = row[i] = pos[i] = NA_REAL;
+    }
+  }
+
+  int64_t first = 0, count = 0;
+  sas_page_rows(f, (int64_t)from, (int64_t)to, first, count);
+
+  return List::create(
+    _["page"] = page,
+    _["row"] = row,
+    _["pos"] = pos,
+    _["first"] = (double)first,
+    _["count"] = (double)count
+  );
+}
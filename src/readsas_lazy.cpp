@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Lazy columns of read.sas(lazy = TRUE). Every column is an ALTREP vector
+ * holding the reader of its file. The length is known from the row selection,
+ * the cells are decoded on first access and kept afterwards.
+ */
+
+#include "sas.h"
+#include "sasaltrep.h"
+
+#include <R_ext/Riconv.h>
+
+using namespace Rcpp;
+
+#ifdef SAS_ALTREP
+
+// data1 of a lazy column points to this, data2 holds the decoded vector
+struct LazyColumn {
+  std::shared_ptr<SasLazy> lazy;
+  int64_t col;
+};
+
+static R_altrep_class_t lazy_real, lazy_string;
+
+static LazyColumn* lazy_column(SEXP x)
+{
+  return static_cast<LazyColumn*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+static void lazy_finalize(SEXP ptr)
+{
+  delete static_cast<LazyColumn*>(R_ExternalPtrAddr(ptr));
+  R_ClearExternalPtr(ptr);
+}
+
+// writes the cells of a single column
+struct LazySink {
+  SEXP vec;
+  bool numeric, convert, empty_to_na, utf8;
+  void* cd; // converter from the file encoding to UTF-8 or nullptr
+  std::string out;
+
+  void num(size_t i, size_t, double val_d) {
+    if (std::isnan(val_d)) val_d = check_na(val_d, convert, false);
+    REAL(vec)[i] = val_d;
+  }
+
+  void str(size_t i, size_t, const char* p, size_t len) {
+    if (empty_to_na && len == 0) {
+      SET_STRING_ELT(vec, i, NA_STRING);
+      return;
+    }
+
+    if (cd) {
+      // at most four bytes per character
+      out.resize(len * 4 + 4);
+      const char* in = p;
+      char* o = &out[0];
+      size_t inleft = len, outleft = out.size();
+
+      Riconv(cd, nullptr, nullptr, nullptr, nullptr);
+      if (Riconv(cd, &in, &inleft, &o, &outleft) != (size_t)-1) {
+        SET_STRING_ELT(vec, i, Rf_mkCharLenCE(out.data(), out.size() - outleft,
+                                              CE_UTF8));
+        return;
+      }
+    }
+
+    SET_STRING_ELT(vec, i, Rf_mkCharLenCE(p, len, utf8 ? CE_UTF8 : CE_NATIVE));
+  }
+
+  void missing(size_t i) {
+    if (numeric)
+      REAL(vec)[i] = NA_REAL;
+    else
+      SET_STRING_ELT(vec, i, NA_STRING);
+  }
+};
+
+// decodes the column on first access
+static SEXP lazy_data(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return data;
+
+  LazyColumn* lc = lazy_column(x);
+  SasLazy& lazy = *lc->lazy;
+  SasReader& reader = lazy.reader;
+  bool numeric = reader.meta().vartyps[lc->col] == 1;
+
+  data = PROTECT(Rf_allocVector(numeric ? REALSXP : STRSXP,
+                                lazy.rows.size()));
+
+  // R errors are raised once the C++ objects are gone
+  int status;
+  char msg[256];
+  {
+    LazySink sink{data, numeric, lazy.convert, lazy.empty_to_na,
+                  lazy.encoding == "UTF-8", nullptr, std::string()};
+
+    if (!numeric && !lazy.encoding.empty() && lazy.encoding != "UTF-8") {
+      sink.cd = Riconv_open("UTF-8", lazy.encoding.c_str());
+      if (sink.cd == (void*)-1) sink.cd = nullptr;
+    }
+
+    int64_t badrows = 0;
+    status = reader.decode(lazy.rows, std::vector<int64_t>(1, lc->col), sink,
+                           badrows);
+
+    if (sink.cd) Riconv_close(sink.cd);
+
+    std::vector<std::string>& warnings = reader.log().warnings;
+    for (auto& w : warnings) Rf_warning("%s", w.c_str());
+    warnings.clear();
+
+    std::snprintf(msg, sizeof(msg), "%s", reader.error().c_str());
+  }
+
+  if (status != SAS_OK) {
+    UNPROTECT(1);
+    Rf_error("%s", msg);
+  }
+
+  R_set_altrep_data2(x, data);
+  UNPROTECT(1);
+
+  return data;
+}
+
+static R_xlen_t lazy_length(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return XLENGTH(data);
+  return lazy_column(x)->lazy->rows.size();
+}
+
+static Rboolean lazy_inspect(SEXP x, int, int, int,
+                             void (*)(SEXP, int, int, int))
+{
+  LazyColumn* lc = lazy_column(x);
+  Rprintf("readsas lazy column %s (%s)\n",
+          lc->lazy->reader.meta().varnames[lc->col].c_str(),
+          R_altrep_data2(x) == R_NilValue ? "not decoded" : "decoded");
+  return TRUE;
+}
+
+// saved as an ordinary vector
+static SEXP lazy_serialized_state(SEXP x)
+{
+  return lazy_data(x);
+}
+
+static SEXP lazy_unserialize(SEXP, SEXP state)
+{
+  return state;
+}
+
+static const void* lazy_dataptr_or_null(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data == R_NilValue) return nullptr;
+  return TYPEOF(data) == REALSXP ? (const void*)REAL(data) :
+    (const void*)STRING_PTR_RO(data);
+}
+
+static void* lazy_real_dataptr(SEXP x, Rboolean)
+{
+  return REAL(lazy_data(x));
+}
+
+static double lazy_real_elt(SEXP x, R_xlen_t i)
+{
+  return REAL(lazy_data(x))[i];
+}
+
+static R_xlen_t lazy_real_get_region(SEXP x, R_xlen_t i, R_xlen_t n,
+                                     double* buf)
+{
+  SEXP data = lazy_data(x);
+  R_xlen_t len = XLENGTH(data);
+  R_xlen_t k = 0;
+  for (; k < n && i + k < len; ++k) buf[k] = REAL(data)[i + k];
+  return k;
+}
+
+static void* lazy_string_dataptr(SEXP x, Rboolean)
+{
+  return (void*)STRING_PTR_RO(lazy_data(x));
+}
+
+static SEXP lazy_string_elt(SEXP x, R_xlen_t i)
+{
+  return STRING_ELT(lazy_data(x), i);
+}
+
+static void lazy_string_set_elt(SEXP x, R_xlen_t i, SEXP v)
+{
+  SET_STRING_ELT(lazy_data(x), i, v);
+}
+
+static void lazy_methods(R_altrep_class_t cls)
+{
+  R_set_altrep_Length_method(cls, lazy_length);
+  R_set_altrep_Inspect_method(cls, lazy_inspect);
+  R_set_altrep_Serialized_state_method(cls, lazy_serialized_state);
+  R_set_altrep_Unserialize_method(cls, lazy_unserialize);
+  R_set_altvec_Dataptr_or_null_method(cls, lazy_dataptr_or_null);
+}
+
+#endif
+
+SEXP sas_lazy_column(const std::shared_ptr<SasLazy>& lazy, int64_t col,
+                     SEXP input)
+{
+#ifdef SAS_ALTREP
+  bool numeric = lazy->reader.meta().vartyps[col] == 1;
+
+  // raw input is parsed in place and must stay alive
+  SEXP ptr = PROTECT(R_MakeExternalPtr(new LazyColumn{lazy, col}, R_NilValue,
+                                       TYPEOF(input) == RAWSXP ? input :
+                                       R_NilValue));
+  R_RegisterCFinalizerEx(ptr, lazy_finalize, TRUE);
+
+  SEXP x = R_new_altrep(numeric ? lazy_real : lazy_string, ptr, R_NilValue);
+  UNPROTECT(1);
+
+  return x;
+#else
+  Rcpp::stop("lazy columns require R >= 3.5.0");
+#endif
+}
+
+// [[Rcpp::init]]
+void readsas_lazy_init(DllInfo* dll)
+{
+#ifdef SAS_ALTREP
+  lazy_real = R_make_altreal_class("lazy_real", "readsas", dll);
+  lazy_methods(lazy_real);
+  R_set_altvec_Dataptr_method(lazy_real, lazy_real_dataptr);
+  R_set_altreal_Elt_method(lazy_real, lazy_real_elt);
+  R_set_altreal_Get_region_method(lazy_real, lazy_real_get_region);
+
+  lazy_string = R_make_altstring_class("lazy_string", "readsas", dll);
+  lazy_methods(lazy_string);
+  R_set_altvec_Dataptr_method(lazy_string, lazy_string_dataptr);
+  R_set_altstring_Elt_method(lazy_string, lazy_string_elt);
+  R_set_altstring_Set_elt_method(lazy_string, lazy_string_set_elt);
+#else
+  (void)dll;
+#endif
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "sas.h"
+
+using namespace Rcpp;
+
+// character cells decoded by a worker thread. R strings can only be created
+// on the main thread, therefore the cells are collected here first.
+struct StrArena {
+  std::string data;
+  std::vector<int32_t> len; // -1 is NA
+};
+
+// writes cells of a single file into the preallocated output
+struct MultiSink {
+  const std::vector<int64_t>& outcol; // j -> output column
+  std::vector<double*> dbl;           // per output column
+  std::vector<StrArena>& str_;        // per output column
+  int64_t base;
+  std::vector<char>& valid;
+  SasSpecial& special;                // per output column
+  bool convert, empty_to_na;
+
+  MultiSink(const std::vector<int64_t>& outcol, std::vector<double*> dbl,
+            std::vector<StrArena>& str_, int64_t base, std::vector<char>& valid,
+            SasSpecial& special, bool convert, bool empty_to_na)
+    : outcol(outcol), dbl(dbl), str_(str_), base(base), valid(valid),
+      special(special), convert(convert), empty_to_na(empty_to_na) {}
+
+  void num(size_t i, size_t j, double val_d) {
+    if (std::isnan(val_d)) {
+      special.add(outcol[j], base + i, val_d, convert);
+      val_d = check_na(val_d, convert, false);
+    }
+    dbl[outcol[j]][base + i] = val_d;
+  }
+
+  void str(size_t i, size_t j, const char* p, size_t len) {
+    StrArena& a = str_[outcol[j]];
+    if (empty_to_na && len == 0) {
+      a.len[i] = -1;
+    } else {
+      a.data.append(p, len);
+      a.len[i] = len;
+    }
+  }
+
+  void missing(size_t i) {
+    for (size_t j = 0; j < outcol.size(); ++j) {
+      if (dbl[outcol[j]])
+        dbl[outcol[j]][base + i] = NA_REAL;
+      else
+        str_[outcol[j]].len[i] = -1;
+    }
+    valid[base + i] = false;
+  }
+};
+
+
+//' Reads multiple SAS data files into a single data frame
+//'
+//' @param files character vector of file paths
+//' @param debug print debug information
+//' @param selectcols_ character vector of selected columns
+//' @param empty_to_na logical convert '' to NA_character_
+//' @param convert logical convert missings `.I` and `.M` to Inf and -Inf
+//' @param nthreads number of threads used for decoding
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_multi(CharacterVector files,
+                         const bool debug,
+                         Nullable<CharacterVector> selectcols_,
+                         const bool empty_to_na,
+                         const bool convert,
+                         int nthreads)
+{
+  size_t nf = files.size();
+  if (nf == 0)
+    stop("no files to read");
+
+  std::vector<SasReader> readers(nf);
+
+  // 1. read all headers and page maps
+  for (size_t f = 0; f < nf; ++f) {
+    sas_log(readers[f], debug);
+    int status = readers[f].open(Rcpp::as<std::string>(files[f]));
+    if (status != SAS_OK && status != SAS_ERROR_INTERRUPT)
+      stop("%s: %s", Rcpp::as<std::string>(files[f]), readers[f].error());
+    sas_check(readers[f], status);
+
+    // workers open their own streams
+    readers[f].close();
+  }
+
+  bool selectvars = selectcols_.isNotNull();
+  std::unordered_set<std::string> select_cols = select_set(selectcols_);
+
+  // 2. reconcile the columns. Columns are matched by name in order of first
+  // appearance. Types must agree, character widths are the maximum width.
+  std::vector<std::string> varnames, formats, labels;
+  std::vector<int32_t> vartyps, colwidth;
+  std::vector<int16_t> c8vec;
+  std::vector<double> fmtkeys, fmt32s, ifmt32s;
+
+  // per file: file column -> output column
+  std::vector<std::vector<int64_t>> cols(nf), outcols(nf);
+  std::unordered_map<std::string, int64_t> outpos;
+
+  for (size_t f = 0; f < nf; ++f) {
+    const SasFile& sf = readers[f].meta();
+
+    // strings are recoded from a single encoding in R
+    if (sf.enc != readers[0].meta().enc)
+      stop("%s is encoded in %s, %s in %s", sf.src.path,
+           sf.enc.empty() ? "an unknown encoding" : sf.enc,
+           readers[0].meta().src.path,
+           readers[0].meta().enc.empty() ? "an unknown encoding" :
+           readers[0].meta().enc);
+
+    for (size_t i = 0; i < sf.varnames.size() && i < sf.vartyps.size(); ++i) {
+      const std::string& varname = sf.varnames[i];
+
+      if (selectvars && !select_cols.count(varname))
+        continue;
+
+      auto it = outpos.find(varname);
+      int64_t pos = it == outpos.end() ? varnames.size() : it->second;
+
+      if (it == outpos.end()) {
+        outpos.emplace(varname, pos);
+        varnames.push_back(varname);
+        vartyps.push_back(sf.vartyps[i]);
+        colwidth.push_back(sf.colwidth[i]);
+        formats.push_back(i < sf.formats.size() ? sf.formats[i] : "");
+        labels.push_back(i < sf.labels.size() ? sf.labels[i] : "");
+        c8vec.push_back(i < sf.c8vec.size() ? sf.c8vec[i] : 0);
+        fmtkeys.push_back(i < sf.fmtkeys.size() ? sf.fmtkeys[i] : 0);
+        fmt32s.push_back(i < sf.fmt32s.size() ? sf.fmt32s[i] : 0);
+        ifmt32s.push_back(i < sf.ifmt32s.size() ? sf.ifmt32s[i] : 0);
+      } else {
+        if ((vartyps[pos] == 1) != (sf.vartyps[i] == 1))
+          stop("column %s is numeric in one file and character in %s",
+               varname, sf.src.path);
+
+        colwidth[pos] = std::max(colwidth[pos], sf.colwidth[i]);
+      }
+
+      cols[f].push_back(i);
+      outcols[f].push_back(pos);
+    }
+  }
+
+  uint32_t kk = varnames.size();
+
+  // 3. row ranges of the files in the output
+  std::vector<int64_t> base(nf + 1, 0);
+  for (size_t f = 0; f < nf; ++f)
+    base[f + 1] = base[f] + readers[f].meta().n;
+
+  int64_t nn = base[nf];
+
+  if (debug)
+    Rcout << "reading " << nf << " files with " << nn << " rows and " <<
+      kk << " columns" << std::endl;
+
+  // 4. allocate the output once
+  Rcpp::List df(kk);
+  std::vector<double*> dbl(kk, nullptr);
+
+  for (uint32_t i = 0; i < kk; ++i) {
+    if (vartyps[i] == 1) {
+      SET_VECTOR_ELT(df, i, NumericVector(no_init(nn)));
+      dbl[i] = REAL(VECTOR_ELT(df, i));
+    } else {
+      SET_VECTOR_ELT(df, i, CharacterVector(no_init(nn)));
+    }
+  }
+
+  // columns missing in a file are NA
+  std::vector<std::vector<bool>> has(nf, std::vector<bool>(kk, false));
+  for (size_t f = 0; f < nf; ++f) {
+    for (auto pos : outcols[f]) has[f][pos] = true;
+
+    for (uint32_t i = 0; i < kk; ++i) {
+      if (!has[f][i] && dbl[i])
+        std::fill(dbl[i] + base[f], dbl[i] + base[f + 1], NA_REAL);
+    }
+  }
+
+  std::vector<char> deleted(nn, 0), valid(nn, 1);
+  std::vector<int64_t> badrows(nf, 0);
+  std::vector<std::vector<StrArena>> arenas(nf);
+  std::vector<SasSpecial> specials(nf, SasSpecial(kk));
+  std::vector<std::string> errors(nf);
+
+  // 5. decode the files into their row ranges
+  std::atomic<size_t> next(0);
+
+  auto worker = [&]() {
+    size_t f;
+    while ((f = next++) < nf) {
+      try {
+        const SasFile& sf = readers[f].meta();
+
+        std::unique_ptr<std::streambuf> buf = sf.src.open();
+        if (!buf) {
+          errors[f] = "could not open file";
+          continue;
+        }
+        std::istream sas(buf.get());
+
+        std::vector<int64_t> rows(sf.n);
+        for (int64_t r = 0; r < sf.n; ++r) {
+          rows[r] = r;
+          deleted[base[f] + r] = sas_row_deleted(sf, r);
+        }
+
+        arenas[f].resize(kk);
+        for (auto pos : outcols[f]) {
+          if (!dbl[pos]) arenas[f][pos].len.resize(sf.n, -1);
+        }
+
+        MultiSink sink(outcols[f], dbl, arenas[f], base[f], valid,
+                       specials[f], convert, empty_to_na);
+
+        badrows[f] = sas_decode(sf, sas, rows, cols[f], sink);
+
+      } catch (std::exception& e) {
+        errors[f] = e.what();
+      }
+    }
+  };
+
+  if (nthreads < 1) nthreads = 1;
+  if ((size_t)nthreads > nf) nthreads = nf;
+
+  if (nthreads <= 1) {
+    worker();
+  } else {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < nthreads; ++t)
+      pool.emplace_back(worker);
+    for (auto& t : pool)
+      t.join();
+  }
+
+  for (size_t f = 0; f < nf; ++f) {
+    if (!errors[f].empty())
+      stop("%s: %s", readers[f].meta().src.path, errors[f]);
+    if (badrows[f] > 0)
+      warning("%s: %d rows had an unexpected size after decompression",
+              readers[f].meta().src.path, badrows[f]);
+  }
+
+  // 6. convert collected character cells to R strings
+  for (size_t f = 0; f < nf; ++f) {
+    for (uint32_t i = 0; i < kk; ++i) {
+      if (dbl[i]) continue;
+
+      SEXP col = VECTOR_ELT(df, i);
+
+      if (!has[f][i]) {
+        for (int64_t r = base[f]; r < base[f + 1]; ++r)
+          SET_STRING_ELT(col, r, NA_STRING);
+        continue;
+      }
+
+      StrArena& a = arenas[f][i];
+      const char* p = a.data.data();
+
+      for (int64_t r = 0; r < readers[f].meta().n; ++r) {
+        if (a.len[r] < 0) {
+          SET_STRING_ELT(col, base[f] + r, NA_STRING);
+        } else {
+          SET_STRING_ELT(col, base[f] + r, Rf_mkCharLen(p, a.len[r]));
+          p += a.len[r];
+        }
+      }
+
+      // release memory early
+      std::string().swap(a.data);
+      std::vector<int32_t>().swap(a.len);
+    }
+  }
+
+  // special missings of all files in file order
+  SasSpecial special(kk);
+  for (size_t f = 0; f < nf; ++f) {
+    for (uint32_t i = 0; i < kk; ++i) {
+      special.rows[i].insert(special.rows[i].end(),
+                             specials[f].rows[i].begin(),
+                             specials[f].rows[i].end());
+      special.tags[i].insert(special.tags[i].end(),
+                             specials[f].tags[i].begin(),
+                             specials[f].tags[i].end());
+    }
+  }
+  for (uint32_t i = 0; i < kk; ++i)
+    special.attach(VECTOR_ELT(df, i), i);
+
+  // 7. Create a data.frame
+  NumericVector rvec(no_init(nn));
+  for (int64_t r = 0; r < nn; ++r) rvec[r] = r;
+
+  if (nn > 0)
+    df.attr("row.names") = rvec;
+
+  df.attr("names") = varnames;
+  df.attr("class") = "data.frame";
+
+  std::vector<double> created(nf), created2(nf), modified(nf), modified2(nf),
+    thrdts(nf), nrows(nf);
+  std::vector<std::string> paths(nf);
+  uint64_t delobs = 0;
+
+  for (size_t f = 0; f < nf; ++f) {
+    created[f] = readers[f].meta().created;
+    created2[f] = readers[f].meta().created2;
+    modified[f] = readers[f].meta().modified;
+    modified2[f] = readers[f].meta().modified2;
+    thrdts[f] = readers[f].meta().thrdts;
+    nrows[f] = readers[f].meta().n;
+    paths[f] = readers[f].meta().src.path;
+    delobs += readers[f].meta().delobs;
+  }
+
+  std::vector<int64_t> cvec(kk);
+  for (uint32_t i = 0; i < kk; ++i) cvec[i] = i;
+
+  // file information is taken from the first file
+  const SasFile& f0 = readers[0].meta();
+
+  df.attr("labels") = labels;
+  df.attr("formats") = formats;
+  df.attr("created") = created;
+  df.attr("created2") = created2;
+  df.attr("modified") = modified;
+  df.attr("modified2") = modified2;
+  df.attr("thrdts") = thrdts;
+
+  df.attr("sasfile") = f0.sasfile;
+  df.attr("dataset") = f0.dataset;
+  df.attr("filetype") = f0.filetype;
+  df.attr("compression") = f0.compression;
+  df.attr("proc") = f0.proc;
+  df.attr("sw") = f0.sw;
+  df.attr("sasrel") = f0.sasrel;
+  df.attr("sasserv") = f0.sasserv;
+  df.attr("osver") = f0.osver;
+  df.attr("osmaker") = f0.osmaker;
+  df.attr("osname") = f0.osname;
+  df.attr("encoding") = f0.enc;
+  df.attr("fmtkeys") = fmtkeys;
+  df.attr("fmt32") = fmt32s;
+  df.attr("ifmt32") = ifmt32s;
+
+  df.attr("rowcount") = nn;
+  df.attr("deleted_rows") = delobs;
+  df.attr("colwidth") = colwidth;
+  df.attr("vartyps") = vartyps;
+  df.attr("c8vec") = c8vec;
+
+  df.attr("files") = paths;
+  df.attr("nrows") = nrows;
+
+  df.attr("cvec") = cvec;
+  df.attr("rvec") = rvec;
+  df.attr("deleted") = LogicalVector(deleted.begin(), deleted.end());
+  df.attr("valid") = LogicalVector(valid.begin(), valid.end());
+
+  return(df);
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sas.h"
+
+using namespace Rcpp;
+
+//' Rows added to a file since a page map was taken
+//'
+//' @param input The full systempath to the sas7bdat file or a raw vector
+//' containing the file.
+//' @param pagemap_ page map of an earlier read
+//' @param debug print debug information
+//' @return list with the current page map and the new rows starting at 0.
+//' rows is NULL if the file has to be read again.
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_refresh(SEXP input, List pagemap_, const bool debug)
+{
+  SasReader reader;
+  sas_open_input(reader, input, debug);
+  const SasFile& f = reader.meta();
+
+  SasPageMap cur = sas_pagemap(f);
+
+  std::vector<int64_t> rows;
+  bool ok = sas_new_rows(pagemap_from(pagemap_), cur, rows);
+
+  if (debug) {
+    if (ok)
+      Rcout << "refresh: " << rows.size() << " new rows" << std::endl;
+    else
+      Rcout << "refresh: file changed, full reload" << std::endl;
+  }
+
+  return List::create(
+    _["pagemap"] = pagemap_list(cur),
+    _["rows"] = ok ? (SEXP)NumericVector(rows.begin(), rows.end()) : R_NilValue
+  );
+}
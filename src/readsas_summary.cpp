@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sas.h"
+#include "sassummary.h"
+
+using namespace Rcpp;
+
+//' Column statistics of SAS data files
+//'
+//' @param input The full systempath to the sas7bdat file or a raw vector
+//' containing the file.
+//' @param selectcols_ character vector of selected columns
+//' @param remove_deleted logical skip deleted rows
+//' @param top number of frequent values per column
+//' @param nthreads number of threads used for decoding
+//' @param debug print debug information
+//' @return list with one element per statistic and the file encoding
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_summary(SEXP input, Nullable<CharacterVector> selectcols_,
+                           const bool remove_deleted, int top, int nthreads,
+                           const bool debug)
+{
+  SasReader reader;
+  sas_open_input(reader, input, debug);
+  const SasFile& f = reader.meta();
+
+  std::vector<int64_t> cols;
+  if (selectcols_.isNotNull()) {
+    CharacterVector selectcols(selectcols_);
+    for (R_xlen_t i = 0; i < selectcols.size(); ++i) {
+      std::string name = Rcpp::as<std::string>(selectcols[i]);
+      int64_t c = reader.column(name);
+      if (c < 0)
+        stop("Variable %s was not found in sas-file.", name);
+      cols.push_back(c);
+    }
+  } else {
+    for (int64_t i = 0; i < reader.ncol(); ++i) cols.push_back(i);
+  }
+
+  std::vector<SasStats> stats;
+  int64_t badrows = 0;
+  try {
+    badrows = sas_summary(f, cols, remove_deleted, nthreads, stats);
+  } catch (SasError& e) {
+    stop(e.what());
+  }
+
+  if (badrows > 0)
+    warning("%d rows had an unexpected size after decompression", badrows);
+
+  size_t kk = cols.size();
+  CharacterVector variable(kk);
+  LogicalVector numeric(kk);
+  NumericVector n(kk), nmiss(kk), min(kk), max(kk), mean(kk), sd(kk),
+    distinct(kk);
+  List top_values(kk), top_counts(kk);
+
+  for (size_t j = 0; j < kk; ++j) {
+    const SasStats& s = stats[j];
+    bool isnum = f.vartyps[cols[j]] == 1;
+
+    variable[j] = f.varnames[cols[j]];
+    numeric[j] = isnum;
+    n[j] = s.n;
+    nmiss[j] = s.nmiss;
+    min[j] = isnum && s.n > 0 ? s.min : NA_REAL;
+    max[j] = isnum && s.n > 0 ? s.max : NA_REAL;
+    mean[j] = isnum && s.n > 0 ? s.mean : NA_REAL;
+    sd[j] = isnum && s.n > 1 ? std::sqrt(s.m2 / (s.n - 1)) : NA_REAL;
+    distinct[j] = s.distinct();
+
+    std::vector<double> counts;
+    if (isnum) {
+      std::vector<double> values;
+      for (auto& kv : s.num.top(top)) {
+        values.push_back(kv.first);
+        counts.push_back(kv.second);
+      }
+      top_values[j] = wrap(values);
+    } else {
+      std::vector<std::string> values;
+      for (auto& kv : s.str.top(top)) {
+        values.push_back(kv.first);
+        counts.push_back(kv.second);
+      }
+      top_values[j] = wrap(values);
+    }
+    top_counts[j] = wrap(counts);
+  }
+
+  return List::create(
+    _["variable"] = variable,
+    _["numeric"] = numeric,
+    _["n"] = n,
+    _["nmiss"] = nmiss,
+    _["min"] = min,
+    _["max"] = max,
+    _["mean"] = mean,
+    _["sd"] = sd,
+    _["distinct"] = distinct,
+    _["top_values"] = top_values,
+    _["top_counts"] = top_counts,
+    _["encoding"] = f.enc
+  );
+}
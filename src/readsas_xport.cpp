@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sas.h"
+
+using namespace Rcpp;
+
+//' Reads a member of a SAS transport file
+//'
+//' @param input The full systempath to the xpt file or a raw vector
+//' containing the file.
+//' @param debug print debug information
+//' @param offset position of the member header, 0 for the first member
+//' @param selectrows_ integer vector of selected rows
+//' @param selectcols_ character vector of selected columns
+//' @param empty_to_na logical convert '' to NA_character_
+//' @param convert logical convert missings `.I` and `.M` to Inf and -Inf
+//' @return data.frame as returned by readsas(). The attribute next holds the
+//' offset of the next member, 0 after the last one.
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_xpt(SEXP input,
+                       const bool debug,
+                       const double offset,
+                       Nullable<NumericVector> selectrows_,
+                       Nullable<CharacterVector> selectcols_,
+                       const bool empty_to_na,
+                       const bool convert)
+{
+  std::shared_ptr<SasLazy> lazy = std::make_shared<SasLazy>();
+  SasReader& reader = lazy->reader;
+
+  reader.xport_member(offset);
+  sas_open_input(reader, input, debug);
+
+  if (!reader.meta().ibm)
+    stop("not a SAS transport file");
+
+  Rcpp::List df = sas_data(lazy, input, nullptr, debug, selectrows_,
+                           selectcols_, empty_to_na, convert, R_NilValue,
+                           false, R_NilValue, R_NilValue, R_NilValue,
+                           R_NilValue, -1, R_NilValue, false, R_NilValue);
+
+  df.attr("next") = (double)reader.xport_next();
+
+  return df;
+}
+
+//' Lists the members of a SAS transport file
+//'
+//' @param input The full systempath to the xpt file or a raw vector
+//' containing the file.
+//' @param debug print debug information
+//' @return data.frame with name, offset, rows and cols of every member
+//' @keywords internal
+//' @noRd
+// [[Rcpp::export]]
+Rcpp::List readsas_xpt_members(SEXP input, const bool debug)
+{
+  std::vector<std::string> names;
+  std::vector<double> offsets, rows, cols;
+
+  // every member ends where the next one starts
+  uint64_t offset = 0;
+  do {
+    SasReader reader;
+    reader.xport_member(offset);
+    sas_open_input(reader, input, debug);
+
+    if (!reader.meta().ibm)
+      stop("not a SAS transport file");
+
+    names.push_back(reader.meta().dataset);
+    offsets.push_back(offset);
+    rows.push_back(reader.nrow());
+    cols.push_back(reader.ncol());
+
+    offset = reader.xport_next();
+  } while (offset > 0);
+
+  Rcpp::List df = Rcpp::List::create(
+    _["name"] = Rcpp::wrap(names),
+    _["offset"] = Rcpp::wrap(offsets),
+    _["rows"] = Rcpp::wrap(rows),
+    _["cols"] = Rcpp::wrap(cols)
+  );
+
+  df.attr("row.names") = Rcpp::IntegerVector::create(NA_INTEGER,
+                                                     -(int)names.size());
+  df.attr("class") = "data.frame";
+
+  return df;
+}
@@ -9,47 +9,25 @@
 #endif
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
+#include <unordered_set>
 
-#include "swap_endian.h"
+#include "sascore.h"
 
-inline void writestr(std::string val_s, int32_t len, std::fstream& sas)
+// selected column names. Wide files have tens of thousands of columns, the
+// selection is looked up in constant time.
+inline std::unordered_set<std::string>
+  select_set(Rcpp::Nullable<Rcpp::CharacterVector> selectcols_)
 {
-
-  std::stringstream val_stream;
-  val_stream << std::left << std::setw(len) << std::setfill(' ') << val_s;
-  std::string val_strl = val_stream.str();
-
-  sas.write(val_strl.c_str(), val_strl.length());
-
-}
-
-// return only the matched positions. Either Rcpps in() can't handle Character-
-// Vectors or I could not make it work. Wanted to select the selected varname
-// position from the varnames vector.
-inline Rcpp::IntegerVector choose(Rcpp::CharacterVector x,
-                                  std::vector<std::string> y_)
-{
-
-  Rcpp::CharacterVector y = Rcpp::wrap(y_);
-
-  Rcpp::IntegerVector mm = Rcpp::match(x, y);
-
-  if (Rcpp::any(Rcpp::is_na(mm))) {
-    Rcpp::LogicalVector ll = !Rcpp::is_na(mm);
-
-    Rcpp::CharacterVector ms = x[ll==0];
-
-    // does not work if ms contains multiple names: Rcpp::as<std::string>(ms)
-    Rcpp::Rcout << "Variable " << ms <<
-      " was not found in sas-file." << std::endl;
+  std::unordered_set<std::string> set;
+  if (selectcols_.isNotNull()) {
+    Rcpp::CharacterVector selectcols(selectcols_);
+    for (R_xlen_t i = 0; i < selectcols.size(); ++i)
+      set.insert(Rcpp::as<std::string>(selectcols[i]));
   }
-
-  // report position for found cases
-  mm = Rcpp::match(y, x);
-
-  return(mm);
+  return set;
 }
 
 inline Rcpp::IntegerVector order(Rcpp::IntegerVector x) {
@@ -57,484 +35,202 @@ inline Rcpp::IntegerVector order(Rcpp::IntegerVector x) {
   return match(sorted, x) -1;
 }
 
-template <typename T>
-T readbin( T t , std::istream& sas, bool swapit)
-{
-  if (!sas.read ((char*)&t, sizeof(t)))
-    Rcpp::stop("readbin: a binary read error occurred");
-  if (swapit==0)
-    return(t);
-  else
-    return(swap_endian(t));
+inline bool any_keepr(Rcpp::NumericVector rvec, double idx) {
+  return std::find(rvec.begin(), rvec.end(), idx) != rvec.end();
 }
 
-double readbinlen(double d, std::istream& sas, bool swapit, int len)
+// core reader output goes to the R console. Warnings are collected and passed
+// on with sas_check(), interrupts abort the parser.
+inline void sas_log(SasReader& reader, bool debug)
 {
+  if (debug) reader.log().debug = &Rcpp::Rcout;
 
-  unsigned char buffer[sizeof d] = {0};
-
-  for (int i = 0; i < len; ++i) {
-
-    unsigned char tmp;
-    if(!sas.read ((char*)&tmp, sizeof(tmp)))
-      Rcpp::stop("readbin: a binary read error occurred");
-
-    int pos = 8 - (len-i);
-    buffer[pos] = tmp;
-
-  }
-
-  memcpy(&d , buffer, sizeof(d));
-
-  if (swapit==0)
-    return(d);
-  else
-    return(swap_endian(d));
+  reader.log().interrupt = []() {
+    try {
+      Rcpp::checkUserInterrupt();
+    } catch (Rcpp::internal::InterruptedException&) {
+      return true;
+    }
+    return false;
+  };
 }
 
+inline void sas_check(SasReader& reader, int status)
+{
+  std::vector<std::string>& warnings = reader.log().warnings;
+  for (auto& msg : warnings)
+    Rcpp::warning(msg);
+  warnings.clear();
+
+  if (status == SAS_ERROR_INTERRUPT)
+    throw Rcpp::internal::InterruptedException();
+  if (status != SAS_OK)
+    Rcpp::stop(reader.error());
+}
 
-template <typename T>
-inline std::string readstring(std::string &mystring, T& sas)
+// open a path or a raw vector
+inline void sas_open_input(SasReader& reader, SEXP input, bool debug)
 {
+  sas_log(reader, debug);
 
-  if (!sas.read(&mystring[0], mystring.size()))
-    Rcpp::stop("char: a binary read error occurred");
+  int status;
+  if (TYPEOF(input) == RAWSXP)
+    status = reader.open((const char*)RAW(input), XLENGTH(input));
+  else
+    status = reader.open(Rcpp::as<std::string>(input));
 
-  return(mystring);
+  sas_check(reader, status);
 }
 
-// PAGE_OFFSET_TABLE
-struct PO_Tab {
-  uint64_t SH_OFF = 0;
-  uint64_t SH_LEN = 0;
-  uint8_t COMPRESSION = 0;
-  uint8_t SH_TYPE = 0;
-};
+// page map as R list. The schema hash is kept as hex string, R has no 64 bit
+// integers.
+inline Rcpp::List pagemap_list(const SasPageMap& pm)
+{
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)pm.schema);
+
+  return Rcpp::List::create(
+    Rcpp::_["schema"] = std::string(hex),
+    Rcpp::_["seqnum"] = Rcpp::NumericVector(pm.seqnum.begin(), pm.seqnum.end()),
+    Rcpp::_["type"] = Rcpp::IntegerVector(pm.type.begin(), pm.type.end()),
+    Rcpp::_["rows"] = Rcpp::NumericVector(pm.rows.begin(), pm.rows.end()),
+    Rcpp::_["delmarker"] = Rcpp::wrap(pm.delmarker)
+  );
+}
 
-// COLUMN_NAME_POINTER
-struct CN_Poi {
-  int16_t CN_IDX = 0;
-  int16_t CN_OFF = 0;
-  int16_t CN_LEN = 0;
-  int16_t zeros  = 0;
-};
+inline SasPageMap pagemap_from(Rcpp::List x)
+{
+  SasPageMap pm;
 
-struct CN_Att {
-  int64_t CN_OFF  = 0;
-  int32_t CN_WID  = 0;
-  int16_t NM_FLAG = 0;
-  int8_t  CN_TYP  = 0;
-  int8_t  UNK8    = 0;
-};
+  std::string hex = Rcpp::as<std::string>(x["schema"]);
+  pm.schema = std::strtoull(hex.c_str(), nullptr, 16);
+  pm.seqnum = Rcpp::as<std::vector<uint32_t>>(x["seqnum"]);
+  pm.type = Rcpp::as<std::vector<int16_t>>(x["type"]);
+  pm.rows = Rcpp::as<std::vector<int64_t>>(x["rows"]);
+  pm.delmarker = Rcpp::as<std::vector<std::string>>(x["delmarker"]);
 
+  return pm;
+}
 
-struct SCV {
-  int64_t SIG = 0;
-  int64_t FIRST = 0;
-  int16_t F_POS = 0; // why is this pos not int64_?
-  int64_t LAST = 0;
-  int16_t L_POS = 0;
-};
+// a user defined format as data.frame with start, end and label. Missings
+// of numeric formats are NA with their SAS name in the column missing.
+inline Rcpp::List format_list(const SasFormat& fmt)
+{
+  R_xlen_t n = fmt.labels.size();
+  Rcpp::List df;
+
+  if (fmt.numeric) {
+    Rcpp::NumericVector start(n), end(n);
+    Rcpp::CharacterVector missing(n);
+    bool tagged = false;
+
+    for (R_xlen_t i = 0; i < n; ++i) {
+      if (std::isnan(fmt.start[i])) {
+        start[i] = end[i] = NA_REAL;
+        missing[i] = sas_missing_name(sas_missing_tag(fmt.start[i]));
+        tagged = true;
+      } else {
+        start[i] = fmt.start[i];
+        end[i] = fmt.end[i];
+        missing[i] = NA_STRING;
+      }
+    }
 
-struct idxofflen {
-  int16_t IDX = 0;
-  int16_t OFF = 0;
-  int16_t LEN = 0;
-};
+    if (tagged)
+      df = Rcpp::List::create(Rcpp::_["start"] = start, Rcpp::_["end"] = end,
+                              Rcpp::_["label"] = Rcpp::wrap(fmt.labels),
+                              Rcpp::_["missing"] = missing);
+    else
+      df = Rcpp::List::create(Rcpp::_["start"] = start, Rcpp::_["end"] = end,
+                              Rcpp::_["label"] = Rcpp::wrap(fmt.labels));
+  } else {
+    df = Rcpp::List::create(Rcpp::_["start"] = Rcpp::wrap(fmt.values),
+                            Rcpp::_["end"] = Rcpp::wrap(fmt.values),
+                            Rcpp::_["label"] = Rcpp::wrap(fmt.labels));
+  }
 
+  df.attr("row.names") = Rcpp::IntegerVector::create(NA_INTEGER, -(int)n);
+  df.attr("class") = "data.frame";
 
-template <typename T>
-inline std::string int_to_hex (T val) {
-  std::stringstream stream;
-  stream << std::hex << val;
-  std::string res( stream.str() );
-  return (res);
+  return df;
 }
 
-inline std::string SASEncoding(uint8_t encval) {
-
-  std::string enc = "";
-
-  switch(encval)
-  {
-  case 70:
-    enc = "x-MacArabic";
-    break;
-  case 245:
-    enc = "x-MacCroatian";
-    break;
-  case 246:
-    enc = "x-MacCyrillic";
-    break;
-  case 72:
-    enc = "x-MacGreek";
-    break;
-  case 71:
-    enc = "x-MacHebrew";
-    break;
-  case 163:
-    enc = "x-MacIceland";
-    break;
-  case 34:
-    enc = "ISO-8859-6";
-    break;
-  case 69:
-    enc = "x-MacRoman";
-    break;
-  case 247:
-    enc = "x-MacRomania";
-    break;
-  case 73:
-    enc = "x-MacThai";
-    break;
-  case 75:
-    enc = "x-MacTurkish";
-    break;
-  case 76:
-    enc = "x-MacUkraine";
-    break;
-  case 123:
-    enc = "Big5";
-    break;
-  case 33:
-    enc = "ISO-8859-5";
-    break;
-  case 78:
-    enc = "IBM037";
-    break;
-  case 95:
-    enc = "x-IBM1025";
-    break;
-  case 207:
-    enc = "x-IBM1097";
-    break;
-  case 98:
-    enc = "x-IBM1112";
-    break;
-  case 99:
-    enc = "x-IBM1122";
-    break;
-  case 183:
-    enc = "IBM01140";
-    break;
-  case 184:
-    enc = "IBM01141";
-    break;
-  case 185:
-    enc = "IBM01142";
-    break;
-  case 186:
-    enc = "IBM01143";
-    break;
-  case 187:
-    enc = "IBM01144";
-    break;
-  case 188:
-    enc = "IBM01145";
-    break;
-  case 189:
-    enc = "IBM01146";
-    break;
-  case 190:
-    enc = "IBM01147";
-    break;
-  case 191:
-    enc = "IBM01148";
-    break;
-  case 211:
-    enc = "IBM01149";
-    break;
-  case 87:
-    enc = "IBM424";
-    break;
-  case 88:
-    enc = "IBM500";
-    break;
-  case 89:
-    enc = "IBM-Thai";
-    break;
-  case 90:
-    enc = "IBM870";
-    break;
-  case 91:
-    enc = "x-IBM875";
-    break;
-  case 125:
-    enc = "GBK";
-    break;
-  case 134:
-    enc = "EUC-JP";
-    break;
-  case 140:
-    enc = "EUC-KR";
-    break;
-  case 119:
-    enc = "x-EUC-TW";
-    break;
-  case 205:
-    enc = "GB18030";
-    break;
-  case 35:
-    enc = "ISO-8859-7";
-    break;
-  case 36:
-    enc = "ISO-8859-8";
-    break;
-  case 128:
-    enc = "x-IBM1381";
-    break;
-  case 130:
-    enc = "x-IBM930";
-    break;
-  case 139:
-    enc = "x-IBM933";
-    break;
-  case 124:
-    enc = "x-IBM935";
-    break;
-  case 117:
-    enc = "x-IBM937";
-    break;
-  case 129:
-    enc = "x-IBM939";
-    break;
-  case 137:
-    enc = "x-IBM942";
-    break;
-  case 142:
-    enc = "x-IBM949";
-    break;
-  case 172:
-    enc = "x-ISO2022-CN-CNS";
-    break;
-  case 169:
-    enc = "x-ISO2022-CN-GB";
-    break;
-  case 167:
-    enc = "ISO-2022-JP";
-    break;
-  case 168:
-    enc = "ISO-2022-KR";
-    break;
-  case 29:
-    enc = "ISO-8859-1";
-    break;
-  case 30:
-    enc = "ISO-8859-2";
-    break;
-  case 31:
-    enc = "ISO-8859-3";
-    break;
-  case 32:
-    enc = "ISO-8859-4";
-    break;
-  case 37:
-    enc = "ISO-8859-9";
-    break;
-  case 242:
-    enc = "ISO-8859-13";
-    break;
-  case 40:
-    enc = "ISO-8859-15";
-    break;
-  case 136:
-    enc = "x-windows-iso2022jp";
-    break;
-  case 126:
-    enc = "x-mswin-936";
-    break;
-  case 141:
-    enc = "x-windows-949";
-    break;
-  case 118:
-    enc = "x-windows-950";
-    break;
-  case 173:
-    enc = "IBM037";
-    break;
-  case 108:
-    enc = "x-IBM1025";
-    break;
-  case 109:
-    enc = "IBM1026";
-    break;
-  case 110:
-    enc = "IBM1047";
-    break;
-  case 208:
-    enc = "x-IBM1097";
-    break;
-  case 111:
-    enc = "x-IBM1112";
-    break;
-  case 112:
-    enc = "x-IBM1122";
-    break;
-  case 192:
-    enc = "IBM01140";
-    break;
-  case 193:
-    enc = "IBM01141";
-    break;
-  case 194:
-    enc = "IBM01142";
-    break;
-  case 195:
-    enc = "IBM01143";
-    break;
-  case 196:
-    enc = "IBM01144";
-    break;
-  case 197:
-    enc = "IBM01145";
-    break;
-  case 198:
-    enc = "IBM01146";
-    break;
-  case 199:
-    enc = "IBM01147";
-    break;
-  case 200:
-    enc = "IBM01148";
-    break;
-  case 212:
-    enc = "IBM01149";
-    break;
-  case 102:
-    enc = "IBM424";
-    break;
-  case 103:
-    enc = "IBM-Thai";
-    break;
-  case 104:
-    enc = "IBM870";
-    break;
-  case 105:
-    enc = "x-IBM875";
-    break;
-  case 234:
-    enc = "x-IBM930";
-    break;
-  case 235:
-    enc = "x-IBM933";
-    break;
-  case 236:
-    enc = "x-IBM935";
-    break;
-  case 237:
-    enc = "x-IBM937";
-    break;
-  case 238:
-    enc = "x-IBM939";
-    break;
-  case 43:
-    enc = "IBM437";
-    break;
-  case 44:
-    enc = "IBM850";
-    break;
-  case 45:
-    enc = "IBM852";
-    break;
-  case 58:
-    enc = "IBM857";
-    break;
-  case 46:
-    enc = "IBM00858";
-    break;
-  case 47:
-    enc = "IBM862";
-    break;
-  case 51:
-    enc = "IBM866";
-    break;
-  case 138:
-    enc = "Shift_JIS";
-    break;
-  case 248:
-    enc = "JIS_X0201";
-    break;
-  case 39:
-    enc = "x-iso-8859-11";
-    break;
-  case 28:
-    enc = "US-ASCII";
-    break;
-  case 20:
-    enc = "UTF-8";
-    break;
-  case 66:
-    enc = "windows-1256";
-    break;
-  case 67:
-    enc = "windows-1257";
-    break;
-  case 61:
-    enc = "windows-1251";
-    break;
-  case 63:
-    enc = "windows-1253";
-    break;
-  case 65:
-    enc = "windows-1255";
-    break;
-  case 62:
-    enc = "windows-1252";
-    break;
-  case 60:
-    enc = "windows-1250";
-    break;
-  case 64:
-    enc = "windows-1254";
-    break;
-  case 68:
-    enc = "windows-1258";
-    break;
+// format of format_list() or written by hand. Character start values make a
+// character format, end is ignored there. NA without missing is '.'.
+inline SasFormat format_from(Rcpp::List x)
+{
+  SasFormat fmt;
+
+  // labels are UTF-8, values are compared with the bytes of the file
+  SEXP start = x["start"];
+  Rcpp::CharacterVector labels = x["label"];
+  for (R_xlen_t i = 0; i < labels.size(); ++i)
+    fmt.labels.push_back(Rf_translateCharUTF8(labels[i]));
+  fmt.numeric = TYPEOF(start) != STRSXP;
+
+  if (!fmt.numeric) {
+    fmt.values = Rcpp::as<std::vector<std::string>>(start);
+  } else {
+    fmt.start = Rcpp::as<std::vector<double>>(start);
+    fmt.end = x.containsElementNamed("end") ?
+      Rcpp::as<std::vector<double>>(x["end"]) : fmt.start;
+
+    std::vector<std::string> missing;
+    if (x.containsElementNamed("missing"))
+      missing = Rcpp::as<std::vector<std::string>>(x["missing"]);
+
+    for (size_t i = 0; i < fmt.start.size(); ++i) {
+      if (!std::isnan(fmt.start[i])) continue;
+      uint8_t tag = i < missing.size() && missing[i] != "NA" ?
+        sas_missing_code(missing[i]) : 1;
+      fmt.start[i] = fmt.end[i] = sas_missing(tag);
+    }
   }
 
-  return enc;
-}
+  size_t n = fmt.labels.size();
+  if ((fmt.numeric ? fmt.start.size() : fmt.values.size()) != n ||
+      (fmt.numeric && fmt.end.size() != n))
+    Rcpp::stop("formats need one start, end and label per value");
 
-std::vector<int64_t> vec_order(const std::vector<int64_t> &v) {
-  std::vector<int64_t> idx(v.size());
-  iota(idx.begin(), idx.end(), 0);
-  stable_sort(idx.begin(), idx.end(),
-              [&v](size_t i1, size_t i2) {return v[i1] < v[i2];});
+  for (size_t i = 0; i < fmt.start.size(); ++i)
+    if (fmt.start[i] > fmt.end[i])
+      Rcpp::stop("format range starts after its end");
 
-  return idx;
+  return fmt;
 }
 
-// order only the valid options
-std::vector<int64_t> order_(std::vector<int64_t> v) {
-  // if (std::count(v.begin(), v.end(), -1)) {
-  //   std::vector<int64_t> idx(v.size());
-  //   iota(idx.begin(), idx.end(), -1);
-  //
-  //   // fetch and sort
-  //   std::vector<int64_t> tmp;
-  //   for(std::size_t i = 0; i < v.size(); ++i) {
-  //     if(v[i] >= 0)  tmp.push_back(v[i]);
-  //   }
-  //   tmp = vec_order(tmp);
-  //
-  //   auto j = 0;
-  //   for (size_t i = 0; i < v.size(); ++i) {
-  //     if (v[i] >= 0) {
-  //       v[i] = tmp[j];
-  //       ++j;
-  //     }
-  //   }
-  //
-  //   return v;
-  //
-  // } else {
-    return vec_order(v);
-  // }
-}
+// reader shared by the lazy columns of a file, see readsas_lazy.cpp
+struct SasLazy {
+  SasReader reader;
+  std::vector<int64_t> rows;
+  bool convert = false, empty_to_na = false;
+  std::string encoding; // strings are recoded from this encoding to UTF-8
+};
 
-bool any_keepr(Rcpp::IntegerVector rvec, uint64_t idx) {
-  return std::find(rvec.begin(), rvec.end(), idx) != rvec.end();
-}
+// column col of the file, decoded on first access. A raw input vector is kept
+// alive by the column.
+SEXP sas_lazy_column(const std::shared_ptr<SasLazy>& lazy, int64_t col,
+                     SEXP input);
+
+// data.frame of an opened file, see readsas() in readsas.cpp
+Rcpp::List sas_data(const std::shared_ptr<SasLazy>& lazy,
+                    SEXP input,
+                    SasProfile* prof,
+                    const bool debug,
+                    Rcpp::Nullable<Rcpp::NumericVector> selectrows_,
+                    Rcpp::Nullable<Rcpp::CharacterVector> selectcols_,
+                    const bool empty_to_na,
+                    const bool convert,
+                    Rcpp::Nullable<Rcpp::CharacterVector> col_classes_,
+                    const bool narrow,
+                    Rcpp::Nullable<Rcpp::List> where_,
+                    Rcpp::Nullable<Rcpp::CharacterVector> zonemap_,
+                    Rcpp::Nullable<Rcpp::CharacterVector> index_,
+                    Rcpp::Nullable<Rcpp::List> sample_,
+                    const double n_max,
+                    Rcpp::Nullable<Rcpp::List> lazy_,
+                    const bool pagemap,
+                    Rcpp::Nullable<Rcpp::List> formats_);
 
 inline double check_na(double value, bool convert, bool debug) {
   uint64_t bits;
@@ -554,4 +250,40 @@ inline double check_na(double value, bool convert, bool debug) {
   return NA_REAL; // leave unchanged
 }
 
+// special missings ._ and .A to .Z of numeric columns, kept sparsely as rows
+// and codes. Columns without them cost nothing. Plain missings are not
+// kept, nor are .I and .M if they are converted to Inf and -Inf.
+struct SasSpecial {
+  std::vector<std::vector<int64_t>> rows;
+  std::vector<std::vector<uint8_t>> tags;
+
+  explicit SasSpecial(size_t kk = 0) : rows(kk), tags(kk) {}
+
+  void add(size_t j, int64_t i, double x, bool convert) {
+    uint8_t tag = sas_missing_tag(x);
+    if (tag == 1 || tag > 27) return;
+    if (convert && (tag == 'I' - 'A' + 2 || tag == 'M' - 'A' + 2))
+      return;
+    rows[j].push_back(i);
+    tags[j].push_back(tag);
+  }
+
+  // attribute sas_missing of column j: rows from 1 and the SAS names
+  void attach(SEXP vec, size_t j) const {
+    if (rows[j].empty()) return;
+
+    size_t n = rows[j].size();
+    Rcpp::NumericVector row(n);
+    Rcpp::CharacterVector code(n);
+    for (size_t k = 0; k < n; ++k) {
+      row[k] = rows[j][k] + 1;
+      code[k] = sas_missing_name(tags[j][k]);
+    }
+
+    Rf_setAttrib(vec, Rf_install("sas_missing"),
+                 Rcpp::List::create(Rcpp::_["row"] = row,
+                                    Rcpp::_["code"] = code));
+  }
+};
+
 #endif
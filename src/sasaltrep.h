@@ -0,0 +1,25 @@
+#ifndef SASALTREP_H
+#define SASALTREP_H
+
+// ALTREP is available from R 3.5.0 on. SAS_ALTREP is defined if it can be
+// used.
+
+#include <Rversion.h>
+
+#if R_VERSION >= R_Version(3, 5, 0)
+#define SAS_ALTREP
+
+#if R_VERSION < R_Version(3, 6, 0)
+// R 3.5 uses class as a parameter name and declares no C linkage
+#define class klass
+extern "C" {
+#include <R_ext/Altrep.h>
+}
+#undef class
+#else
+#include <R_ext/Altrep.h>
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef SASARROW_H
+#define SASARROW_H
+
+/*
+ * Export of decoded columns through the Arrow C Data Interface. Columns are
+ * decoded straight into Arrow buffers, no R objects are created. Numerics are
+ * float64, characters utf8 (or large_utf8 if a column exceeds 2GB). SAS
+ * missings and empty strings (if requested) are null.
+ *
+ * https://arrow.apache.org/docs/format/CDataInterface.html
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "sasfile.h"
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+struct SasArrowColumn {
+  std::string name, format, metadata;
+  int64_t null_count = 0;
+  std::vector<uint8_t> validity;
+  std::vector<double> values;
+  std::vector<int64_t> offsets;
+  std::vector<int32_t> offsets32;
+  std::string chars;
+};
+
+// cells are decoded into the column buffers. rows arrive in order.
+struct ArrowSink {
+  std::vector<SasArrowColumn>& cols;
+  bool convert, empty_to_na;
+
+  ArrowSink(std::vector<SasArrowColumn>& cols, bool convert, bool empty_to_na)
+    : cols(cols), convert(convert), empty_to_na(empty_to_na) {}
+
+  void set_null(SasArrowColumn& col, size_t i) {
+    col.validity[i >> 3] &= ~(uint8_t)(1 << (i & 7));
+    ++col.null_count;
+  }
+
+  void num(size_t i, size_t j, double val_d) {
+    SasArrowColumn& col = cols[j];
+
+    if (std::isnan(val_d)) {
+      uint64_t bits;
+      std::memcpy(&bits, &val_d, sizeof(bits));
+
+      // .I and .M
+      if (convert && bits == 0xfffff50000000000) {
+        val_d = std::numeric_limits<double>::infinity();
+      } else if (convert && bits == 0xfffff10000000000) {
+        val_d = -std::numeric_limits<double>::infinity();
+      } else {
+        val_d = 0;
+        set_null(col, i);
+      }
+    }
+
+    col.values[i] = val_d;
+  }
+
+  void str(size_t i, size_t j, const char* p, size_t len) {
+    SasArrowColumn& col = cols[j];
+
+    if (empty_to_na && len == 0)
+      set_null(col, i);
+    else
+      col.chars.append(p, len);
+
+    col.offsets[i + 1] = col.chars.size();
+  }
+
+  void missing(size_t i) {
+    for (auto& col : cols) {
+      set_null(col, i);
+      if (!col.values.empty()) col.values[i] = 0;
+      if (!col.offsets.empty()) col.offsets[i + 1] = col.chars.size();
+    }
+  }
+};
+
+// Arrow metadata: int32 number of pairs, then int32 length prefixed keys and
+// values, all in native byte order
+inline void sas_arrow_metadata(std::string& out, const std::string& key,
+                               const std::string& value)
+{
+  if (value.empty()) return;
+
+  int32_t n = 0;
+  if (out.empty())
+    out.assign(sizeof(int32_t), '\0');
+  else
+    std::memcpy(&n, &out[0], sizeof(n));
+
+  ++n;
+  std::memcpy(&out[0], &n, sizeof(n));
+
+  int32_t len = key.size();
+  out.append((const char*)&len, sizeof(len));
+  out.append(key);
+  len = value.size();
+  out.append((const char*)&len, sizeof(len));
+  out.append(value);
+}
+
+// decode rows and cols of f into Arrow columns. Returns the number of rows
+// with an unexpected size after decompression.
+inline int64_t sas_arrow_decode(const SasFile& f, std::istream& sas,
+                                const std::vector<int64_t>& rows,
+                                const std::vector<int64_t>& cols,
+                                bool convert, bool empty_to_na,
+                                std::vector<SasArrowColumn>& out)
+{
+  size_t nn = rows.size();
+
+  // strings of files in other encodings are passed as binary
+  bool utf8 = f.enc.empty() || f.enc == "UTF-8" || f.enc == "US-ASCII";
+
+  out.assign(cols.size(), SasArrowColumn());
+
+  for (size_t j = 0; j < cols.size(); ++j) {
+    int64_t c = cols[j];
+    SasArrowColumn& col = out[j];
+
+    col.name = f.varnames[c];
+    col.validity.assign((nn + 7) / 8, 0xFF);
+
+    if (f.vartyps[c] == 1) {
+      col.format = "g";
+      col.values.resize(nn);
+    } else {
+      col.format = utf8 ? "u" : "z";
+      col.offsets.assign(nn + 1, 0);
+      if (!utf8) sas_arrow_metadata(col.metadata, "SAS.encoding", f.enc);
+    }
+
+    if ((size_t)c < f.formats.size())
+      sas_arrow_metadata(col.metadata, "SAS.format", f.formats[c]);
+    if ((size_t)c < f.labels.size())
+      sas_arrow_metadata(col.metadata, "SAS.label", f.labels[c]);
+  }
+
+  ArrowSink sink(out, convert, empty_to_na);
+  int64_t badrows = sas_decode(f, sas, rows, cols, sink);
+
+  // columns below 2GB use 32 bit offsets
+  for (auto& col : out) {
+    if (col.offsets.empty()) continue;
+
+    if (col.chars.size() <= (size_t)std::numeric_limits<int32_t>::max()) {
+      col.offsets32.assign(col.offsets.begin(), col.offsets.end());
+      std::vector<int64_t>().swap(col.offsets);
+    } else {
+      col.format = col.format == "u" ? "U" : "Z";
+    }
+  }
+
+  return badrows;
+}
+
+
+// every exported struct owns its buffers, consumers may move children
+struct SasArrowArrayData {
+  SasArrowColumn col;
+  std::vector<const void*> buffers;
+  std::vector<ArrowArray> child_arrays;
+  std::vector<ArrowArray*> children;
+};
+
+struct SasArrowSchemaData {
+  std::string format, name, metadata;
+  std::vector<ArrowSchema> child_schemas;
+  std::vector<ArrowSchema*> children;
+};
+
+inline void sas_arrow_release_array(ArrowArray* array)
+{
+  for (int64_t i = 0; i < array->n_children; ++i) {
+    ArrowArray* child = array->children[i];
+    if (child->release) child->release(child);
+  }
+  delete (SasArrowArrayData*)array->private_data;
+  array->release = nullptr;
+}
+
+inline void sas_arrow_release_schema(ArrowSchema* schema)
+{
+  for (int64_t i = 0; i < schema->n_children; ++i) {
+    ArrowSchema* child = schema->children[i];
+    if (child->release) child->release(child);
+  }
+  delete (SasArrowSchemaData*)schema->private_data;
+  schema->release = nullptr;
+}
+
+inline void sas_arrow_column(SasArrowColumn& col, int64_t length,
+                             ArrowArray* array, ArrowSchema* schema)
+{
+  SasArrowSchemaData* sd = new SasArrowSchemaData();
+  sd->format = col.format;
+  sd->name = col.name;
+  sd->metadata = col.metadata;
+
+  schema->format = sd->format.c_str();
+  schema->name = sd->name.c_str();
+  schema->metadata = sd->metadata.empty() ? nullptr : sd->metadata.data();
+  schema->flags = ARROW_FLAG_NULLABLE;
+  schema->n_children = 0;
+  schema->children = nullptr;
+  schema->dictionary = nullptr;
+  schema->release = &sas_arrow_release_schema;
+  schema->private_data = sd;
+
+  SasArrowArrayData* ad = new SasArrowArrayData();
+  ad->col = std::move(col);
+  SasArrowColumn& c = ad->col;
+
+  const void* validity = c.null_count > 0 ? c.validity.data() : nullptr;
+
+  if (c.format == "g") {
+    ad->buffers = {validity, c.values.data()};
+  } else if (!c.offsets32.empty()) {
+    ad->buffers = {validity, c.offsets32.data(), c.chars.data()};
+  } else {
+    ad->buffers = {validity, c.offsets.data(), c.chars.data()};
+  }
+
+  array->length = length;
+  array->null_count = c.null_count;
+  array->offset = 0;
+  array->n_buffers = ad->buffers.size();
+  array->n_children = 0;
+  array->buffers = ad->buffers.data();
+  array->children = nullptr;
+  array->dictionary = nullptr;
+  array->release = &sas_arrow_release_array;
+  array->private_data = ad;
+}
+
+// move decoded columns into a struct array, the top level record batch
+inline void sas_arrow_export(std::vector<SasArrowColumn>& cols, int64_t length,
+                             ArrowArray* array, ArrowSchema* schema)
+{
+  size_t kk = cols.size();
+
+  SasArrowSchemaData* sd = new SasArrowSchemaData();
+  SasArrowArrayData* ad = new SasArrowArrayData();
+
+  sd->format = "+s";
+  sd->child_schemas.resize(kk);
+  ad->child_arrays.resize(kk);
+  ad->buffers = {nullptr};
+
+  for (size_t j = 0; j < kk; ++j) {
+    sas_arrow_column(cols[j], length, &ad->child_arrays[j],
+                     &sd->child_schemas[j]);
+    sd->children.push_back(&sd->child_schemas[j]);
+    ad->children.push_back(&ad->child_arrays[j]);
+  }
+
+  schema->format = sd->format.c_str();
+  schema->name = sd->name.c_str();
+  schema->metadata = nullptr;
+  schema->flags = 0;
+  schema->n_children = kk;
+  schema->children = sd->children.data();
+  schema->dictionary = nullptr;
+  schema->release = &sas_arrow_release_schema;
+  schema->private_data = sd;
+
+  array->length = length;
+  array->null_count = 0;
+  array->offset = 0;
+  array->n_buffers = 1;
+  array->n_children = kk;
+  array->buffers = ad->buffers.data();
+  array->children = ad->children.data();
+  array->dictionary = nullptr;
+  array->release = &sas_arrow_release_array;
+  array->private_data = ad;
+}
+
+#endif
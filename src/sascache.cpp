@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "sascache.h"
+
+bool sas_cache_source(const std::string& path, uint64_t& size, uint64_t& hash)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) return false;
+
+  in.seekg(0, std::ios::end);
+  size = in.tellg();
+  in.seekg(0, std::ios::beg);
+
+  std::vector<char> buf(std::min<uint64_t>(size, 65536));
+  if (!in.read(buf.data(), buf.size())) return false;
+
+  // FNV-1a
+  hash = 0xcbf29ce484222325ULL;
+  for (char c : buf) {
+    hash ^= (unsigned char)c;
+    hash *= 0x100000001b3ULL;
+  }
+
+  return true;
+}
+
+#ifdef _WIN32
+
+bool SasMap::open(const std::string& path)
+{
+  close();
+
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ |
+                            FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping) {
+    CloseHandle(file);
+    return false;
+  }
+
+  void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!p) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  file_ = file;
+  mapping_ = mapping;
+  data_ = (const char*)p;
+  size_ = size.QuadPart;
+  return true;
+}
+
+void SasMap::close()
+{
+  if (data_) UnmapViewOfFile(data_);
+  if (mapping_) CloseHandle(mapping_);
+  if (file_) CloseHandle(file_);
+  data_ = nullptr;
+  mapping_ = file_ = nullptr;
+  size_ = 0;
+}
+
+#else
+
+bool SasMap::open(const std::string& path)
+{
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+
+  // the mapping stays valid after the descriptor is closed
+  void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) return false;
+
+  data_ = (const char*)p;
+  size_ = st.st_size;
+  return true;
+}
+
+void SasMap::close()
+{
+  if (data_) munmap((void*)data_, size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif
+
+bool SasCache::open(const std::string& path, const std::string& source)
+{
+  uint64_t size = 0, hash = 0;
+  if (!sas_cache_source(source, size, hash) || !map.open(path)) return false;
+
+  uint64_t len = map.size();
+  header = (const SasCacheHeader*)map.data();
+
+  if (len < sizeof(SasCacheHeader) ||
+      std::memcmp(header->magic, SAS_CACHE_MAGIC, sizeof(SAS_CACHE_MAGIC)) ||
+      header->bom != 0x01020304 || header->source_size != size ||
+      header->source_hash != hash || header->nrow < 0 ||
+      header->meta > len || header->meta_size > len - header->meta)
+    return false;
+
+  uint64_t dir = sizeof(SasCacheHeader);
+  if ((uint64_t)header->ncol > (len - dir) / sizeof(SasCacheCol)) return false;
+  cols = (const SasCacheCol*)(map.data() + dir);
+
+  // every section lies within the file
+  uint64_t n = header->nrow;
+  auto within = [&](uint64_t off, uint64_t bytes, uint64_t align) {
+    return off % align == 0 && off <= len && bytes <= len - off;
+  };
+
+  for (uint32_t j = 0; j < header->ncol; ++j) {
+    const SasCacheCol& c = cols[j];
+    bool ok;
+
+    if (c.type == 0) {
+      ok = n <= len / 8 && within(c.data, n * 8, 8);
+    } else if (c.type == 1) {
+      ok = n < len / 8 && within(c.offsets, (n + 1) * 8, 8) &&
+        within(c.na, n, 1) && within(c.data, c.size, 1) &&
+        offsets(j)[0] == 0 && (uint64_t)offsets(j)[n] == c.size;
+    } else {
+      ok = false;
+    }
+
+    if (!ok) return false;
+  }
+
+  return true;
+}
+
+bool SasCacheWriter::open(const std::string& path, const std::string& source,
+                          int64_t nrow, uint32_t ncol)
+{
+  std::memset(&header_, 0, sizeof(header_));
+  std::memcpy(header_.magic, SAS_CACHE_MAGIC, sizeof(SAS_CACHE_MAGIC));
+  header_.bom = 0x01020304;
+  header_.ncol = ncol;
+  header_.nrow = nrow;
+
+  if (!sas_cache_source(source, header_.source_size, header_.source_hash))
+    return false;
+
+  path_ = path;
+  tmp_ = path + ".tmp" + std::to_string(std::random_device()());
+  out_.open(tmp_.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out_) return false;
+
+  // header and directory are written by finish()
+  cols_.clear();
+  pos_ = sizeof(SasCacheHeader) + ncol * sizeof(SasCacheCol);
+  std::vector<char> zero(pos_);
+  out_.write(zero.data(), zero.size());
+
+  return (bool)out_;
+}
+
+// appends n bytes padded to 8 and returns their position
+uint64_t SasCacheWriter::section(const void* p, uint64_t n)
+{
+  static const char pad[8] = {0};
+
+  uint64_t pos = pos_;
+  out_.write((const char*)p, n);
+  out_.write(pad, (8 - n % 8) % 8);
+  pos_ += n + (8 - n % 8) % 8;
+
+  return pos;
+}
+
+void SasCacheWriter::num(const double* x)
+{
+  SasCacheCol c = SasCacheCol();
+  c.type = 0;
+  c.size = header_.nrow * sizeof(double);
+  c.data = section(x, c.size);
+  cols_.push_back(c);
+}
+
+void SasCacheWriter::str(const std::vector<int64_t>& offsets,
+                         const std::vector<char>& na, const std::string& chars,
+                         bool utf8)
+{
+  SasCacheCol c = SasCacheCol();
+  c.type = 1;
+  c.utf8 = utf8;
+  c.offsets = section(offsets.data(), offsets.size() * sizeof(int64_t));
+  c.na = section(na.data(), na.size());
+  c.size = chars.size();
+  c.data = section(chars.data(), chars.size());
+  cols_.push_back(c);
+}
+
+bool SasCacheWriter::finish(const char* meta, size_t size)
+{
+  header_.meta = section(meta, size);
+  header_.meta_size = size;
+
+  bool ok = cols_.size() == header_.ncol;
+  if (ok) {
+    out_.seekp(0);
+    out_.write((const char*)&header_, sizeof(header_));
+    out_.write((const char*)cols_.data(), cols_.size() * sizeof(SasCacheCol));
+    out_.flush();
+    ok = (bool)out_;
+  }
+  out_.close();
+
+  if (ok) {
+#ifdef _WIN32
+    // rename does not replace existing files
+    std::remove(path_.c_str());
+#endif
+    ok = std::rename(tmp_.c_str(), path_.c_str()) == 0;
+  }
+
+  if (!ok) std::remove(tmp_.c_str());
+  return ok;
+}
@@ -0,0 +1,121 @@
+#ifndef SASCACHE_H
+#define SASCACHE_H
+
+/*
+ * Columnar cache of a decoded file. Numeric columns are stored as arrays of
+ * doubles, character columns as string offsets, NA flags and the string
+ * bytes. On reuse the cache is memory mapped, processes reading the same
+ * cache share a single copy in the page cache.
+ *
+ * Layout, every section starts at a multiple of 8 bytes:
+ *   SasCacheHeader
+ *   SasCacheCol[ncol]
+ *   column data
+ *   meta data, opaque bytes of the caller
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const char SAS_CACHE_MAGIC[8] = {'S', 'A', 'S', 'C', 'A', 'C', 'H', '1'};
+
+struct SasCacheHeader {
+  char magic[8];
+  uint32_t bom;            // 0x01020304 in the byte order of the writer
+  uint32_t ncol;
+  int64_t nrow;
+  uint64_t source_size;    // see sas_cache_source()
+  uint64_t source_hash;
+  uint64_t meta, meta_size;
+};
+
+struct SasCacheCol {
+  uint32_t type;           // 0 numeric, 1 character
+  uint32_t utf8;           // strings are UTF-8
+  uint64_t data;           // doubles or string bytes
+  uint64_t offsets;        // nrow + 1 string offsets
+  uint64_t na;             // nrow NA flags
+  uint64_t size;           // bytes at data
+};
+
+// size of a file and a hash of its first 64 KiB. The file header holds the
+// creation and modification time, a rewritten file gets another hash.
+bool sas_cache_source(const std::string& path, uint64_t& size, uint64_t& hash);
+
+// read only memory map of a file
+class SasMap {
+public:
+  SasMap() {}
+  ~SasMap() { close(); }
+  SasMap(const SasMap&) = delete;
+  SasMap& operator=(const SasMap&) = delete;
+
+  bool open(const std::string& path);
+  void close();
+
+  const char* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+private:
+  const char* data_ = nullptr;
+  uint64_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+};
+
+// a mapped cache
+struct SasCache {
+  SasMap map;
+  const SasCacheHeader* header = nullptr;
+  const SasCacheCol* cols = nullptr;
+
+  // false if path is missing, damaged or the cache of another source
+  bool open(const std::string& path, const std::string& source);
+
+  int64_t nrow() const { return header->nrow; }
+  uint32_t ncol() const { return header->ncol; }
+
+  const double* num(size_t j) const {
+    return (const double*)(map.data() + cols[j].data);
+  }
+  const int64_t* offsets(size_t j) const {
+    return (const int64_t*)(map.data() + cols[j].offsets);
+  }
+  const char* na(size_t j) const { return map.data() + cols[j].na; }
+  const char* chars(size_t j) const { return map.data() + cols[j].data; }
+  const char* meta() const { return map.data() + header->meta; }
+};
+
+// writes a cache column by column. The file is written under a temporary
+// name and renamed by finish(), readers never see a partial cache.
+class SasCacheWriter {
+public:
+  bool open(const std::string& path, const std::string& source, int64_t nrow,
+            uint32_t ncol);
+
+  void num(const double* x);
+
+  // string i is chars[offsets[i], offsets[i + 1]), na[i] != 0 for NA
+  void str(const std::vector<int64_t>& offsets, const std::vector<char>& na,
+           const std::string& chars, bool utf8);
+
+  // writes meta, the header and the column directory. Removes the temporary
+  // file on failure.
+  bool finish(const char* meta, size_t size);
+
+private:
+  uint64_t section(const void* p, uint64_t n);
+
+  std::ofstream out_;
+  std::string path_, tmp_;
+  SasCacheHeader header_;
+  std::vector<SasCacheCol> cols_;
+  uint64_t pos_ = 0;
+};
+
+#endif
@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * sas7bcat catalogs share the header and the pages of sas7bdat files. Pages
+ * hold an index of XLSR entries, each pointing to the first link of a chain
+ * of blocks. A chain spans one or more pages and holds a single format: its
+ * name, the values and the labels. The layout follows the description of
+ * ReadStat.
+ */
+
+#include <algorithm>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "sasparse.h"
+
+// integers of a block in the byte order of the file
+template <typename T>
+static T cat_read(const char* p, bool swapit)
+{
+  T t;
+  std::memcpy(&t, p, sizeof(t));
+  return swapit ? swap_endian(t) : t;
+}
+
+// numeric values are stored big endian, regardless of the file
+static uint64_t cat_read_be(const char* p)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i) v = (v << 8) | (unsigned char)p[i];
+  return v;
+}
+
+static std::string cat_string(const char* p, size_t len)
+{
+  size_t n = 0;
+  while (n < len && p[n] != '\0') ++n;
+  while (n > 0 && p[n - 1] == ' ') --n;
+  return std::string(p, n);
+}
+
+// offsets of the catalog layout, they depend on the header alignment
+struct CatLayout {
+  bool u64, swapit;
+  uint8_t pad1;
+  uint64_t xlsr_size, xlsr_offset, xlsr_o_offset;
+  uint32_t headersize, pagesize;
+  int64_t pagecount;
+};
+
+// first links of the chains listed in an index starting at p
+static void cat_index(const char* p, size_t len, const CatLayout& c,
+                      std::vector<std::pair<uint64_t, uint64_t>>& links)
+{
+  const char* xlsr = p;
+
+  while (xlsr + c.xlsr_size <= p + len) {
+    // entries are aligned to 8 bytes, blanks in between
+    if (std::memcmp(xlsr, "        ", 8) == 0) {
+      xlsr += 8;
+      continue;
+    }
+    if (std::memcmp(xlsr, "XLSR", 4) != 0) break;
+
+    if (xlsr[c.xlsr_o_offset] == 'O') {
+      uint64_t page, pos;
+      if (c.u64) {
+        page = cat_read<uint64_t>(xlsr + 8, c.swapit);
+        pos = cat_read<uint16_t>(xlsr + 16, c.swapit);
+      } else {
+        page = cat_read<uint32_t>(xlsr + 4, c.swapit);
+        pos = cat_read<uint16_t>(xlsr + 8, c.swapit);
+      }
+      links.emplace_back(page, pos);
+    }
+
+    xlsr += c.xlsr_size;
+  }
+}
+
+// concatenated payload of the chain starting at page (from 1) and pos
+static std::string cat_chain(std::istream& sas, const CatLayout& c,
+                             uint64_t page, uint64_t pos)
+{
+  std::string block;
+  char link[32];
+  size_t linklen = c.u64 ? 32 : 16;
+
+  for (int64_t count = 0; page > 0 && pos > 0 &&
+         page <= (uint64_t)c.pagecount && count < c.pagecount; ++count) {
+    sas.seekg(c.headersize + (page - 1) * c.pagesize + pos, sas.beg);
+    if (!sas.read(link, linklen))
+      throw SasError(SAS_ERROR_READ, "catalog block beyond end of file");
+
+    page = cat_read<uint32_t>(link, c.swapit);
+    pos = cat_read<uint16_t>(link + (c.u64 ? 8 : 4), c.swapit);
+    uint16_t len = cat_read<uint16_t>(link + (c.u64 ? 10 : 6), c.swapit);
+
+    size_t size = block.size();
+    block.resize(size + len);
+    if (!sas.read(&block[size], len))
+      throw SasError(SAS_ERROR_READ, "catalog block beyond end of file");
+  }
+
+  return block;
+}
+
+// the values and labels of a block
+static void cat_labels(const char* p, size_t len, uint64_t used,
+                       uint64_t capacity, const CatLayout& c, SasFormat& fmt)
+{
+  const char* end = p + len;
+  const char* lbp1 = p;
+  std::vector<size_t> value_pos(used, 0);
+
+  // values come first, ordered by the position of their label
+  for (uint64_t i = 0; i < capacity; ++i) {
+    if (lbp1 + 4 > end) sas_stop("catalog value beyond end of block");
+
+    if (i < used) {
+      if (lbp1 + 14 + c.pad1 > end) sas_stop("catalog value beyond end of block");
+      uint32_t label_pos = cat_read<uint32_t>(lbp1 + 10 + c.pad1, c.swapit);
+      if (label_pos >= used) sas_stop("invalid catalog label position");
+      value_pos[label_pos] = lbp1 - p;
+    }
+
+    lbp1 += 6 + cat_read<uint16_t>(lbp1 + 2, c.swapit);
+  }
+
+  // followed by the labels
+  const char* lbp2 = lbp1;
+
+  for (uint64_t i = 0; i < used; ++i) {
+    const char* val = p + value_pos[i];
+    if (val + 30 > end || lbp2 + 10 > end)
+      sas_stop("catalog label beyond end of block");
+
+    if (fmt.numeric) {
+      uint64_t bits = cat_read_be(val + 22);
+      double x;
+      if ((bits | 0xff0000000000ULL) == 0xffffffffffffULL) {
+        // catalogs store the tag itself, unlike data files which store its
+        // complement. sas_missing() builds the NaN of a data file.
+        x = sas_missing((uint8_t)(bits >> 40));
+      } else {
+        std::memcpy(&x, &bits, sizeof(x));
+        x = -x;
+      }
+      fmt.start.push_back(x);
+      fmt.end.push_back(x);
+    } else {
+      size_t entry = 6 + cat_read<uint16_t>(val + 2, c.swapit);
+      if (entry < 16 || val + entry > end)
+        sas_stop("catalog value beyond end of block");
+      fmt.values.push_back(cat_string(val + entry - 16, 16));
+    }
+
+    uint16_t label_len = cat_read<uint16_t>(lbp2 + 8, c.swapit);
+    if (lbp2 + 10 + label_len > end)
+      sas_stop("catalog label beyond end of block");
+    fmt.labels.push_back(cat_string(lbp2 + 10, label_len));
+
+    lbp2 += 8 + 2 + label_len + 1;
+  }
+}
+
+// a block holding a format. Returns false for blocks without labels.
+static bool cat_block(const std::string& block, const CatLayout& c,
+                      SasFormat& fmt)
+{
+  const char* data = block.data();
+  size_t offset = c.u64 ? 138 : 106;
+  if (block.size() < offset) return false;
+
+  uint16_t flags = cat_read<uint16_t>(data + 2, c.swapit);
+  size_t pad = (flags & 0x08) ? 4 : 0;
+
+  uint64_t capacity, used;
+  if (c.u64) {
+    capacity = cat_read<uint64_t>(data + 42 + pad, c.swapit);
+    used = cat_read<uint64_t>(data + 50 + pad, c.swapit);
+  } else {
+    capacity = cat_read<uint32_t>(data + 38 + pad, c.swapit);
+    used = cat_read<uint32_t>(data + 42 + pad, c.swapit);
+  }
+
+  fmt.name = cat_string(data + 8, 8);
+  if (pad) pad += 16;
+
+  // names longer than 8 characters
+  if ((!c.u64 && (flags & 0x80)) || (c.u64 && (flags & 0x20))) {
+    if (block.size() < offset + pad + 32) return false;
+    fmt.name = cat_string(data + offset + pad, 32);
+    pad += 32;
+  }
+
+  if (block.size() < offset + pad || used == 0 || used > capacity)
+    return false;
+
+  fmt.numeric = fmt.name.empty() || fmt.name[0] != '$';
+  cat_labels(data + offset + pad, block.size() - offset - pad, used, capacity,
+             c, fmt);
+
+  return true;
+}
+
+void readsas_catalog(std::istream& sas, SasLog& log, SasCatalog& cat)
+{
+  const bool debug = log.debug != nullptr;
+  std::ostream nullout(nullptr);
+  std::ostream& dbg = debug ? *log.debug : nullout;
+
+  SasHeader h;
+  readsas_header(sas, log, h);
+  if (!h.catalog)
+    throw SasError(SAS_ERROR_FORMAT, "not a sas7bcat catalog");
+
+  cat.enc = h.enc;
+
+  CatLayout c;
+  c.u64 = h.u64;
+  c.swapit = h.swapit;
+  c.pad1 = h.pad1;
+  c.xlsr_size = 212 + c.pad1;
+  c.xlsr_offset = 856 + 2 * c.pad1;
+  c.xlsr_o_offset = 50 + c.pad1;
+  if (c.u64) {
+    c.xlsr_size += 72;
+    c.xlsr_offset += 144;
+    c.xlsr_o_offset += 24;
+  }
+  c.headersize = h.headersize;
+  c.pagesize = h.pagesize;
+  c.pagecount = h.pagecount;
+
+  if (c.pagesize <= c.xlsr_offset) sas_stop("catalog pagesize too small");
+
+  // the index starts on the first page and continues on pages marked XLSR
+  std::vector<std::pair<uint64_t, uint64_t>> links;
+  std::string page(c.pagesize, '\0');
+
+  for (int64_t pg = 0; pg < c.pagecount; ++pg) {
+    log.check_interrupt();
+    if (pg == 1) continue;
+
+    sas.seekg(c.headersize + (uint64_t)pg * c.pagesize, sas.beg);
+    if (!sas.read(&page[0], c.pagesize))
+      throw SasError(SAS_ERROR_READ, "catalog page beyond end of file");
+
+    if (pg == 0)
+      cat_index(&page[c.xlsr_offset], c.pagesize - c.xlsr_offset, c, links);
+    else if (std::memcmp(&page[16], "XLSR", 4) == 0)
+      cat_index(&page[16], c.pagesize - 16, c, links);
+  }
+
+  std::sort(links.begin(), links.end());
+  links.erase(std::unique(links.begin(), links.end()), links.end());
+
+  if (debug) dbg << "catalog blocks: " << links.size() << std::endl;
+
+  for (auto& l : links) {
+    log.check_interrupt();
+
+    SasFormat fmt;
+    if (!cat_block(cat_chain(sas, c, l.first, l.second), c, fmt))
+      continue;
+
+    if (debug)
+      dbg << "format " << fmt.name << ": " << fmt.labels.size() <<
+        " labels" << std::endl;
+
+    cat.formats.push_back(std::move(fmt));
+  }
+}
@@ -0,0 +1,313 @@
+#ifndef SASCORE_H
+#define SASCORE_H
+
+/*
+ * libreadsas: the sas7bdat reader without R. Used by the R package and by
+ * the command line tools in cli/.
+ *
+ * The parser reports errors by throwing SasError. SasReader wraps it and
+ * returns status codes instead, warnings are collected and debug output is
+ * written to an optional stream.
+ */
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "sasfile.h"
+#include "sasfilter.h"
+#include "sasformat.h"
+#include "sasindex.h"
+#include "sasrefresh.h"
+#include "sassample.h"
+
+enum SasStatus {
+  SAS_OK = 0,
+  SAS_ERROR_OPEN,       // file could not be opened
+  SAS_ERROR_READ,       // file ended unexpectedly
+  SAS_ERROR_FORMAT,     // not a sas7bdat file or unsupported layout
+  SAS_ERROR_ARGUMENT,   // invalid rows or columns requested
+  SAS_ERROR_INTERRUPT,  // interrupted by the caller
+  SAS_ERROR_WRITE       // output could not be written
+};
+
+inline const char* sas_strerror(int status)
+{
+  switch (status) {
+  case SAS_OK:             return "no error";
+  case SAS_ERROR_OPEN:     return "could not open file";
+  case SAS_ERROR_READ:     return "read error";
+  case SAS_ERROR_FORMAT:   return "invalid file format";
+  case SAS_ERROR_ARGUMENT: return "invalid argument";
+  case SAS_ERROR_INTERRUPT: return "interrupted";
+  case SAS_ERROR_WRITE:    return "write error";
+  }
+  return "unknown error";
+}
+
+class SasError : public std::runtime_error {
+public:
+  SasError(int status, const std::string& msg)
+    : std::runtime_error(msg), status(status) {}
+  int status;
+};
+
+// printf like formatting for messages. Every conversion specification is
+// replaced by the next argument, written with operator<<.
+inline void sas_fmt_arg(std::ostream& os, int8_t v) { os << (int)v; }
+inline void sas_fmt_arg(std::ostream& os, uint8_t v) { os << (int)v; }
+template <typename T>
+inline void sas_fmt_arg(std::ostream& os, const T& v) { os << v; }
+
+inline void sas_fmt(std::ostream& os, const char* fmt) { os << fmt; }
+
+template <typename T, typename... Args>
+inline void sas_fmt(std::ostream& os, const char* fmt, const T& v,
+                    const Args&... args)
+{
+  for (; *fmt; ++fmt) {
+    if (*fmt != '%') {
+      os << *fmt;
+      continue;
+    }
+    if (fmt[1] == '%') {
+      os << '%';
+      ++fmt;
+      continue;
+    }
+    // skip flags, width and conversion
+    ++fmt;
+    while (*fmt && std::strchr("-+ #0123456789.hlzjt", *fmt)) ++fmt;
+    sas_fmt_arg(os, v);
+    if (*fmt) ++fmt;
+    return sas_fmt(os, fmt, args...);
+  }
+}
+
+template <typename... Args>
+inline std::string sas_format(const char* fmt, const Args&... args)
+{
+  std::ostringstream os;
+  sas_fmt(os, fmt, args...);
+  return os.str();
+}
+
+// how the parser talks to its caller
+struct SasLog {
+  std::ostream* debug = nullptr;                          // debug output
+  std::function<void(const std::string&)> warning;        // default: collect
+  std::function<bool()> interrupt;                        // true aborts
+  SasProfile* profile = nullptr;                          // optional timings
+  std::vector<std::string> warnings;
+
+  void warn(const std::string& msg) {
+    if (warning)
+      warning(msg);
+    else
+      warnings.push_back(msg);
+  }
+
+  void check_interrupt() {
+    if (interrupt && interrupt())
+      throw SasError(SAS_ERROR_INTERRUPT, "interrupted");
+  }
+};
+
+// file header of sas7bdat files and sas7bcat catalogs
+struct SasHeader {
+  bool u64 = false, swapit = false;
+  bool catalog = false;         // sas7bcat magic number
+  uint8_t pad1 = 0;             // 4 if the header is aligned, otherwise 0
+  std::string enc, sasfile, dataset, filetype, sasrel, sasserv, osver,
+    osmaker, osname;
+  double created = 0, created2 = 0, modified = 0, modified2 = 0, thrdts = 0;
+  uint32_t headersize = 0, pagesize = 0, pageseqnum = 0;
+  int64_t pagecount = 0;
+};
+
+// Reads the file header of a sas7bdat or sas7bcat file. Throws SasError.
+void readsas_header(std::istream& sas, SasLog& log, SasHeader& h);
+
+// Reads the value labels of a sas7bcat catalog. Throws SasError.
+void readsas_catalog(std::istream& sas, SasLog& log, SasCatalog& cat);
+
+// true if the stream holds a SAS transport (XPORT) library
+bool sas_is_xport(std::istream& sas);
+
+// Reads the member of a transport library whose header starts at offset, 0
+// is the first member. f.size must hold the file size and is reduced to the
+// end of the member. Returns the offset of the next member, 0 after the last
+// one. Throws SasError.
+uint64_t readsas_xport(std::istream& sas, SasLog& log, SasFile& f,
+                       uint64_t offset = 0);
+
+// Reads the file header, the meta data subheaders and the page map. Data rows
+// are not read, only their position is stored in f. With max_rows >= 0 the
+// page scan stops once max_rows rows that are not deleted were found, with
+// max_pages >= 0 after the first max_pages pages. Throws SasError.
+void readsas_meta(std::istream& sas, SasLog& log, SasFile& f,
+                  int64_t max_rows = -1, int64_t max_pages = -1);
+
+
+// a decoded column. Numeric missings are NaN with the SAS missing code in the
+// payload. Strings are stored back to back, string i is
+// chars[offsets[i], offsets[i + 1]).
+struct SasColumn {
+  std::string name, format, label;
+  bool numeric = true;
+  std::vector<double> num;
+  std::vector<int64_t> offsets;
+  std::string chars;
+};
+
+struct SasBatch {
+  std::vector<int64_t> rows;  // row numbers in the file, starting at 0
+  std::vector<SasColumn> cols;
+};
+
+class SasReader {
+public:
+  SasReader() {}
+
+  // open a file or a buffer. The buffer is not copied and must outlive the
+  // reader.
+  int open(const std::string& path);
+  int open(const char* data, size_t size);
+
+  // release the file, the meta data stays available
+  void close() {
+    in_.reset();
+    cache_.reset();
+    counter_.reset();
+    buf_.reset();
+  }
+
+  // debug output, warnings and interrupt checks during parsing
+  SasLog& log() { return log_; }
+
+  // scan only the pages holding the first n rows, set before open(). -1
+  // scans all pages.
+  void max_rows(int64_t n) { max_rows_ = n; }
+
+  // scan only the first n pages, set before open(). Pages holding column
+  // meta data are scanned regardless. -1 scans all pages.
+  void max_pages(int64_t n) { max_pages_ = n; }
+
+  // member of a transport library to read, see readsas_xport(). Set before
+  // open(), transport libraries are detected by their header.
+  void xport_member(uint64_t offset) { xport_member_ = offset; }
+
+  // offset of the transport member following the one read, 0 after the last
+  uint64_t xport_next() const { return xport_next_; }
+
+  // keep the last n pages read in memory, see SasPageCache. Set before
+  // open(), 0 disables the cache. Buffers are never cached.
+  void page_cache(size_t n) { page_cache_ = n; }
+
+  const SasFile& meta() const { return f_; }
+  int64_t nrow() const { return f_.n; }
+  int64_t ncol() const { return f_.vartyps.size(); }
+
+  // column position or -1
+  int64_t column(const std::string& name) const;
+
+  // rows available in the file. Deleted rows are skipped if skip_deleted.
+  std::vector<int64_t> rows(int64_t start, int64_t count,
+                            bool skip_deleted) const;
+
+  // decode count rows starting at row start. Deleted rows are skipped if
+  // skip_deleted. An empty cols reads all columns.
+  int read(int64_t start, int64_t count, const std::vector<int64_t>& cols,
+           bool skip_deleted, SasBatch& batch);
+
+  // decode rows and cols into a sink, see sas_decode()
+  template <typename Sink>
+  int decode(const std::vector<int64_t>& rows,
+             const std::vector<int64_t>& cols, Sink& sink,
+             int64_t& badrows) {
+    return guard([&]() {
+      check_cols(cols);
+      SasTimer timer(log_.profile, SAS_PHASE_DECODE);
+      badrows = sas_decode(f_, *in_, rows, cols, sink, log_.profile);
+    });
+  }
+
+  // rows matching where, see sas_select_where()
+  int select(const std::vector<int64_t>& rows,
+             const std::vector<SasPredicate>& where,
+             std::vector<int64_t>& matched);
+
+  // decode rows matching where, see sas_decode_where()
+  template <typename Sink>
+  int decode_where(const std::vector<int64_t>& rows,
+                   const std::vector<int64_t>& cols,
+                   const std::vector<SasPredicate>& where, Sink& sink,
+                   std::vector<int64_t>& matched, int64_t& badrows) {
+    return guard([&]() {
+      check_cols(cols);
+      check_where(where);
+      SasTimer timer(log_.profile, SAS_PHASE_DECODE);
+      badrows = sas_decode_where(f_, *in_, rows, cols, where, sink, matched,
+                                 log_.profile);
+    });
+  }
+
+  // zone map of the file. A valid map stored at path is reused, otherwise
+  // the map is built and written to path. An empty path keeps the map in
+  // memory only.
+  int zonemap(const std::string& path, SasZoneMap& zm);
+
+  // rows [first, last) that can match where if column col is sorted in
+  // ascending order, see sas_sorted_span(). probes is the number of rows read.
+  int sorted_span(int64_t col, const std::vector<SasPredicate>& where,
+                  int64_t& first, int64_t& last, int64_t& probes);
+
+  // key index of the numeric columns cols. A valid index stored at path is
+  // reused, columns it lacks are added with one scan and the index is
+  // written back. An empty path keeps the index in memory only.
+  int index(const std::string& path, const std::vector<int64_t>& cols,
+            SasIndex& idx);
+
+  const std::string& error() const { return error_; }
+  const std::vector<std::string>& warnings() const { return log_.warnings; }
+
+private:
+  int open_source();
+  void check_cols(const std::vector<int64_t>& cols) const;
+  void check_where(const std::vector<SasPredicate>& where) const;
+
+  // run fn, translate exceptions into status codes
+  template <typename Fn>
+  int guard(Fn fn) {
+    try {
+      if (!in_) throw SasError(SAS_ERROR_ARGUMENT, "no file opened");
+      fn();
+    } catch (SasError& e) {
+      error_ = e.what();
+      return e.status;
+    } catch (std::bad_alloc&) {
+      error_ = "out of memory";
+      return SAS_ERROR_READ;
+    } catch (std::exception& e) {
+      error_ = e.what();
+      return SAS_ERROR_FORMAT;
+    }
+    return SAS_OK;
+  }
+
+  SasFile f_;
+  SasLog log_;
+  int64_t max_rows_ = -1, max_pages_ = -1;
+  size_t page_cache_ = 0;
+  uint64_t xport_member_ = 0, xport_next_ = 0;
+  std::unordered_map<std::string, int64_t> columns_;
+  std::unique_ptr<std::streambuf> buf_, counter_, cache_;
+  std::unique_ptr<std::istream> in_;
+  std::string error_;
+};
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef SASCSV_H
+#define SASCSV_H
+
+/*
+ * Streaming csv export. Rows are decoded in chunks, every chunk is formatted
+ * by several threads into separate buffers that are written in order. Memory
+ * use is bounded by the chunk size.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#include "sascore.h"
+
+struct SasCsvOptions {
+  char sep = ',';
+  bool quote = true;         // quote all strings, otherwise only if required
+  std::string na;            // written for missing numerics
+  bool header = true;
+  bool dates = true;         // format dates, datetimes and times
+  bool convert = false;      // .I and .M as Inf and -Inf
+  bool skip_deleted = true;
+  int nthreads = 1;
+  int64_t chunk = 65536;
+};
+
+enum SasDateKind { SAS_NODATE = 0, SAS_DATE, SAS_DATETIME, SAS_TIME };
+
+inline bool sas_iequal(const std::string& a, const char* b)
+{
+  size_t n = std::strlen(b);
+  if (a.size() != n) return false;
+  for (size_t i = 0; i < n; ++i)
+    if (std::tolower((unsigned char)a[i]) != b[i]) return false;
+  return true;
+}
+
+// same formats as in sas_postprocess()
+inline SasDateKind sas_date_kind(const std::string& format)
+{
+  static const char* dates[] = {
+    "b8601da", "e8601da", "date", "day", "ddmmyy", "ddmmyyb", "ddmmyyc",
+    "ddmmyyd", "ddmmyyn", "ddmmyyp", "ddmmyys", "eurdfdd", "eurdfde",
+    "eurdfdn", "eurdfdwn", "eurdfmy", "eurdfwdx", "eurdfmn", "eurdfwkx",
+    "weekdate", "weekdatx", "weekday", "downame", "worddate", "worddatx",
+    "julday", "julian", "nengo", "pdjulg", "pdjuli", "yymm", "yymmc",
+    "yymmd", "yymmn", "yymmp", "yymms", "yymmdd", "yymmddb", "yymmddc",
+    "yymmddd", "yymmddn", "yymmddp", "yymmdds", "yymon", "yyq", "yyqc",
+    "yyqd", "yyqp", "yyqs", "yyqn", "yyqr", "yyqrc", "yyqrd", "yyqrp",
+    "yyqrs", "yyqrn", "year", "mmddyy", "mmddyyc", "mmddyyd", "mmddyyn",
+    "mmddyyp", "mmddyys", "mmyy", "mmyyc", "mmyyd", "mmyyn", "mmyyp",
+    "mmyys", "monname", "month", "monyy", "qtr", "qtrr"
+  };
+  static const char* datetimes[] = {
+    "e8601dn", "e8601dt", "e8601dx", "e8601dz", "e8601lx", "b8601dn",
+    "b8601dt", "b8601dx", "b8601dz", "b8601lx", "dateampm", "datetime",
+    "dtdate", "dtmonyy", "dtwkdatx", "dtyear", "mdyampm"
+  };
+  static const char* times[] = {
+    "time", "timeampm", "tod", "hhmm", "hour", "mmss", "systime"
+  };
+
+  for (auto d : dates) if (sas_iequal(format, d)) return SAS_DATE;
+  for (auto d : datetimes) if (sas_iequal(format, d)) return SAS_DATETIME;
+  for (auto d : times) if (sas_iequal(format, d)) return SAS_TIME;
+  return SAS_NODATE;
+}
+
+// shortest representation that reads back to the same double
+inline int sas_dtoa(double x, char* buf)
+{
+  // integers are common and cheap
+  if (x == std::floor(x) && std::fabs(x) < 9007199254740992.0) {
+    if (x == 0) {
+      buf[0] = '0';
+      return 1;
+    }
+    return std::snprintf(buf, 32, "%lld", (long long)x);
+  }
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  // the digits of the shortest representation printed as %.15g to %.17g,
+  // the same text as the snprintf loop below
+  char sci[32];
+  const char* end = std::to_chars(sci, sci + 32, x,
+                                  std::chars_format::scientific).ptr;
+  int digits = 0;
+  for (const char* p = sci; p < end && *p != 'e'; ++p)
+    digits += *p >= '0' && *p <= '9';
+  return std::to_chars(buf, buf + 32, x, std::chars_format::general,
+                       std::max(digits, 15)).ptr - buf;
+#else
+  int len = 0;
+  for (int prec = 15; prec <= 17; ++prec) {
+    len = std::snprintf(buf, 32, "%.*g", prec, x);
+    if (std::strtod(buf, nullptr) == x) break;
+  }
+  return len;
+#endif
+}
+
+// days since 1970-01-01 to civil date. H. Hinnant, chrono-Compatible
+// Low-Level Date Algorithms
+inline void sas_civil(int64_t z, int64_t& y, unsigned& m, unsigned& d)
+{
+  z += 719468;
+  const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = (unsigned)(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  y = (int64_t)yoe + era * 400;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y += (m <= 2);
+}
+
+// SAS counts from 1960-01-01. Like convert_to_date() days after the SAS leap
+// years 4000 and 8000 are shifted.
+inline int sas_format_date(double x, SasDateKind kind, char* buf)
+{
+  const double day = 86400;
+  double secs = kind == SAS_DATE ? x * day : x;
+
+  if (kind == SAS_TIME) {
+    secs = std::fmod(secs, day);
+    if (secs < 0) secs += day;
+  } else {
+    if (secs >= 64381305600.0) secs += day;
+    if (secs >= 190609027200.0) secs += day;
+  }
+
+  double fdays = std::floor(secs / day);
+  double rem = secs - fdays * day;
+  int64_t days = (int64_t)fdays - 3653; // 1960-01-01 is day -3653
+
+  int64_t y;
+  unsigned m, d;
+  sas_civil(days, y, m, d);
+
+  unsigned hh = (unsigned)(rem / 3600);
+  unsigned mm = (unsigned)((rem - hh * 3600) / 60);
+  unsigned ss = (unsigned)(rem - hh * 3600 - mm * 60);
+
+  switch (kind) {
+  case SAS_DATE:
+    return std::snprintf(buf, 64, "%04lld-%02u-%02u", (long long)y, m, d);
+  case SAS_DATETIME:
+    return std::snprintf(buf, 64, "%04lld-%02u-%02u %02u:%02u:%02u",
+                         (long long)y, m, d, hh, mm, ss);
+  default:
+    return std::snprintf(buf, 64, "%02u:%02u:%02u", hh, mm, ss);
+  }
+}
+
+inline void sas_csv_str(std::string& out, const char* p, size_t len,
+                        const SasCsvOptions& opt)
+{
+  bool quote = opt.quote;
+  for (size_t i = 0; i < len && !quote; ++i)
+    quote = p[i] == opt.sep || p[i] == '"' || p[i] == '\n' || p[i] == '\r';
+
+  if (!quote) {
+    out.append(p, len);
+    return;
+  }
+
+  out.push_back('"');
+  for (size_t i = 0; i < len; ++i) {
+    if (p[i] == '"') out.push_back('"');
+    out.push_back(p[i]);
+  }
+  out.push_back('"');
+}
+
+// format rows [from, to) of a batch
+inline void sas_csv_rows(const SasBatch& batch,
+                         const std::vector<SasDateKind>& kinds,
+                         size_t from, size_t to, const SasCsvOptions& opt,
+                         std::string& out)
+{
+  char buf[64];
+
+  for (size_t i = from; i < to; ++i) {
+    for (size_t j = 0; j < batch.cols.size(); ++j) {
+      const SasColumn& col = batch.cols[j];
+      if (j) out.push_back(opt.sep);
+
+      if (!col.numeric) {
+        sas_csv_str(out, col.chars.data() + col.offsets[i],
+                    col.offsets[i + 1] - col.offsets[i], opt);
+        continue;
+      }
+
+      double x = col.num[i];
+
+      if (std::isnan(x)) {
+        uint64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        if (opt.convert && bits == 0xfffff50000000000)
+          out.append("Inf");
+        else if (opt.convert && bits == 0xfffff10000000000)
+          out.append("-Inf");
+        else
+          out.append(opt.na);
+      } else if (kinds[j] != SAS_NODATE && std::fabs(x) < 1e13) {
+        out.append(buf, sas_format_date(x, kinds[j], buf));
+      } else if (std::isinf(x)) {
+        out.append(x > 0 ? "Inf" : "-Inf");
+      } else {
+        out.append(buf, sas_dtoa(x, buf));
+      }
+    }
+    out.push_back('\n');
+  }
+}
+
+// write cols of an open reader as csv. Returns a SasStatus, rows holds the
+// number of rows written.
+inline int sas_write_csv(SasReader& reader, const std::vector<int64_t>& cols,
+                         std::ostream& out, const SasCsvOptions& opt,
+                         int64_t& rows)
+{
+  const SasFile& f = reader.meta();
+  rows = 0;
+
+  std::vector<SasDateKind> kinds;
+  for (auto c : cols) {
+    SasDateKind kind = SAS_NODATE;
+    if (opt.dates && f.vartyps[c] == 1 && (size_t)c < f.formats.size())
+      kind = sas_date_kind(f.formats[c]);
+    kinds.push_back(kind);
+  }
+
+  if (opt.header) {
+    std::string line;
+    for (size_t j = 0; j < cols.size(); ++j) {
+      if (j) line.push_back(opt.sep);
+      const std::string& name = f.varnames[cols[j]];
+      sas_csv_str(line, name.data(), name.size(), opt);
+    }
+    line.push_back('\n');
+    out.write(line.data(), line.size());
+  }
+
+  size_t nthreads = opt.nthreads > 1 ? opt.nthreads : 1;
+  int64_t chunk = opt.chunk > 0 ? opt.chunk : 65536;
+  std::vector<std::string> parts(nthreads);
+  SasBatch batch;
+
+  for (int64_t start = 0; start < f.n; start += chunk) {
+
+    int status = reader.read(start, chunk, cols, opt.skip_deleted, batch);
+    if (status != SAS_OK) return status;
+
+    try {
+      reader.log().check_interrupt();
+    } catch (SasError& e) {
+      return e.status;
+    }
+
+    size_t nn = batch.rows.size();
+    size_t nt = std::min(nthreads, std::max<size_t>(nn / 1024, 1));
+    size_t per = (nn + nt - 1) / std::max<size_t>(nt, 1);
+
+    auto work = [&](size_t t) {
+      parts[t].clear();
+      size_t from = std::min(nn, t * per), to = std::min(nn, from + per);
+      sas_csv_rows(batch, kinds, from, to, opt, parts[t]);
+    };
+
+    if (nt <= 1) {
+      work(0);
+    } else {
+      std::vector<std::thread> pool;
+      for (size_t t = 0; t < nt; ++t) pool.emplace_back(work, t);
+      for (auto& t : pool) t.join();
+    }
+
+    for (size_t t = 0; t < nt; ++t)
+      out.write(parts[t].data(), parts[t].size());
+
+    if (!out) return SAS_ERROR_WRITE;
+
+    rows += nn;
+  }
+
+  out.flush();
+  return out ? SAS_OK : SAS_ERROR_WRITE;
+}
+
+#endif
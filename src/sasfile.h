@@ -0,0 +1,860 @@
+#ifndef SASFILE_H
+#define SASFILE_H
+
+/*
+ * Everything required to decode data rows once the file header and the page
+ * map are known. Nothing in here touches the R API, so rows can be decoded
+ * from worker threads.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <stdint.h>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sasformat.h"
+#include "swap_endian.h"
+#include "uncompress.h"
+
+// read-only stream buffer on top of memory owned by someone else, e.g. an R
+// raw vector. Allows parsing in-memory files without copying them first.
+class membuf : public std::streambuf {
+public:
+  membuf(const char* base, size_t size) {
+    char* p = const_cast<char*>(base);
+    setg(p, p, p + size);
+  }
+
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which = std::ios_base::in) override {
+    char* pos = nullptr;
+    if (dir == std::ios_base::beg)
+      pos = eback() + off;
+    else if (dir == std::ios_base::cur)
+      pos = gptr() + off;
+    else
+      pos = egptr() + off;
+
+    if (pos < eback() || pos > egptr())
+      return pos_type(off_type(-1));
+
+    setg(eback(), pos, egptr());
+    return pos_type(pos - eback());
+  }
+
+  pos_type seekpos(pos_type pos,
+                   std::ios_base::openmode which = std::ios_base::in) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+
+// where the file comes from. Every reader opens its own stream buffer, this
+// way multiple threads can read the same file.
+struct SasSource {
+  std::string path;
+  const char* data = nullptr;
+  size_t size = 0;
+
+  std::unique_ptr<std::streambuf> open() const {
+    std::unique_ptr<std::streambuf> buf;
+    if (data) {
+      buf.reset(new membuf(data, size));
+    } else {
+      std::filebuf* fb = new std::filebuf();
+      if (fb->open(path, std::ios::in | std::ios::binary))
+        buf.reset(fb);
+      else
+        delete fb;
+    }
+    return buf;
+  }
+};
+
+// optional profiling of a read. Phases are measured with wall and cpu time,
+// read and strings are measured per batch of rows and report wall time only.
+enum SasPhase {
+  SAS_PHASE_HEADER = 0, // file header and meta data subheaders
+  SAS_PHASE_PAGES,      // page scan
+  SAS_PHASE_READ,       // row reads and decompression
+  SAS_PHASE_DECODE,     // cell extraction, including read and strings
+  SAS_PHASE_STRINGS,    // character cells passed to the sink
+  SAS_PHASE_N
+};
+
+struct SasProfile {
+  double wall[SAS_PHASE_N] = {0};
+  double cpu[SAS_PHASE_N] = {0};
+  uint64_t bytes_read = 0, seeks = 0;
+  uint64_t compressed_bytes = 0, uncompressed_bytes = 0;
+  uint64_t peak_buffer = 0;
+};
+
+typedef std::chrono::steady_clock SasClock;
+
+inline double sas_seconds(SasClock::time_point t0)
+{
+  return std::chrono::duration<double>(SasClock::now() - t0).count();
+}
+
+// adds wall and cpu time to a phase until stop() or the end of the scope
+struct SasTimer {
+  SasProfile* prof;
+  int phase;
+  SasClock::time_point wall;
+  std::clock_t cpu = 0;
+
+  SasTimer(SasProfile* prof, int phase) : prof(prof), phase(phase) {
+    if (prof) {
+      wall = SasClock::now();
+      cpu = std::clock();
+    }
+  }
+
+  void stop() {
+    if (!prof) return;
+    prof->wall[phase] += sas_seconds(wall);
+    prof->cpu[phase] += double(std::clock() - cpu) / CLOCKS_PER_SEC;
+    prof = nullptr;
+  }
+
+  ~SasTimer() { stop(); }
+};
+
+// counts bytes and seeks of another stream buffer. Reads go through a small
+// buffer, bytes are counted when it is refilled.
+class CountingBuf : public std::streambuf {
+public:
+  CountingBuf(std::streambuf* src, SasProfile* prof) : src(src), prof(prof) {}
+
+protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    std::streamsize n = src->sgetn(buf, sizeof(buf));
+    if (n <= 0) {
+      setg(nullptr, nullptr, nullptr);
+      return traits_type::eof();
+    }
+    prof->bytes_read += n;
+    setg(buf, buf, buf + n);
+    return traits_type::to_int_type(*gptr());
+  }
+
+  std::streamsize xsgetn(char* s, std::streamsize n) override {
+    std::streamsize got = 0;
+    while (got < n) {
+      std::streamsize avail = egptr() - gptr();
+      if (avail > 0) {
+        std::streamsize k = std::min(avail, n - got);
+        std::memcpy(s + got, gptr(), k);
+        gbump(k);
+        got += k;
+        continue;
+      }
+
+      // large reads bypass the buffer
+      if (n - got >= (std::streamsize)sizeof(buf)) {
+        std::streamsize r = src->sgetn(s + got, n - got);
+        if (r > 0) prof->bytes_read += r;
+        return got + std::max<std::streamsize>(r, 0);
+      }
+
+      if (traits_type::eq_int_type(underflow(), traits_type::eof())) break;
+    }
+    return got;
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which = std::ios_base::in) override {
+    off_type buffered = egptr() - gptr();
+
+    // tellg() does not move
+    if (dir == std::ios_base::cur && off == 0) {
+      pos_type pos = src->pubseekoff(0, dir, which);
+      return pos == pos_type(off_type(-1)) ? pos : pos - buffered;
+    }
+
+    if (dir == std::ios_base::cur) off -= buffered;
+    ++prof->seeks;
+    setg(nullptr, nullptr, nullptr);
+    return src->pubseekoff(off, dir, which);
+  }
+
+  pos_type seekpos(pos_type pos,
+                   std::ios_base::openmode which = std::ios_base::in) override {
+    ++prof->seeks;
+    setg(nullptr, nullptr, nullptr);
+    return src->pubseekpos(pos, which);
+  }
+
+private:
+  std::streambuf* src;
+  SasProfile* prof;
+  char buf[4096];
+};
+
+// keeps the most recently used pages of another stream buffer in memory.
+// The header and every page of the file are cached as a whole, repeated
+// reads of the same rows are answered without touching the file again.
+class SasPageCache : public std::streambuf {
+public:
+  SasPageCache(std::streambuf* src, uint64_t headersize, uint64_t pagesize,
+               size_t capacity)
+    : src(src), headersize(headersize), pagesize(pagesize ? pagesize : 4096),
+      capacity(capacity ? capacity : 1) {}
+
+protected:
+  int_type underflow() override {
+    if (!load(tell())) return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+  }
+
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which = std::ios_base::in) override {
+    off_type base = 0;
+    if (dir == std::ios_base::cur) {
+      base = tell();
+    } else if (dir == std::ios_base::end) {
+      base = src->pubseekoff(0, std::ios_base::end, which);
+      if (base < 0) return pos_type(off_type(-1));
+    }
+    return seekpos(pos_type(base + off), which);
+  }
+
+  pos_type seekpos(pos_type pos,
+                   std::ios_base::openmode = std::ios_base::in) override {
+    off_type p = pos;
+    if (p < 0) return pos_type(off_type(-1));
+
+    uint64_t end = start + (egptr() - eback());
+    if (eback() && (uint64_t)p >= start && (uint64_t)p < end) {
+      setg(eback(), eback() + (p - start), egptr());
+    } else {
+      setg(nullptr, nullptr, nullptr);
+      next = p;
+    }
+    return pos;
+  }
+
+private:
+  struct Page {
+    uint64_t start;
+    std::vector<char> data;
+  };
+
+  uint64_t tell() const {
+    return eback() ? start + (gptr() - eback()) : next;
+  }
+
+  // makes the page holding pos the get area
+  bool load(uint64_t pos) {
+    setg(nullptr, nullptr, nullptr);
+    next = pos;
+
+    uint64_t first = 0, len = headersize;
+    if (pos >= headersize) {
+      first = headersize + (pos - headersize) / pagesize * pagesize;
+      len = pagesize;
+    }
+
+    auto it = index.find(first);
+    if (it != index.end()) {
+      lru.splice(lru.begin(), lru, it->second);
+    } else {
+      if (src->pubseekpos(first) == pos_type(off_type(-1))) return false;
+
+      Page pg;
+      pg.start = first;
+      pg.data.resize(len);
+      std::streamsize got = src->sgetn(pg.data.data(), len);
+      if (got <= 0) return false;
+      pg.data.resize(got);
+
+      if (lru.size() >= capacity) {
+        index.erase(lru.back().start);
+        lru.pop_back();
+      }
+      lru.push_front(std::move(pg));
+      index[first] = lru.begin();
+    }
+
+    Page& pg = lru.front();
+    if (pos - pg.start >= pg.data.size()) return false;
+
+    start = pg.start;
+    char* p = pg.data.data();
+    setg(p, p + (pos - pg.start), p + pg.data.size());
+    return true;
+  }
+
+  std::streambuf* src;
+  uint64_t headersize, pagesize;
+  size_t capacity;
+  std::list<Page> lru;
+  std::unordered_map<uint64_t, std::list<Page>::iterator> index;
+  uint64_t start = 0, next = 0;
+};
+
+struct SasPage {
+  uint64_t data_pos = 0;  // end of the subheader pointers
+  int64_t  rows = 0;      // BLOCK_COUNT - SUBHEADER_COUNT
+  int16_t  type = 0;
+  uint32_t seqnum = 0;
+  std::string delmarker;  // one char per row, '1' if deleted
+};
+
+// rows of compressed files are stored in subheaders, either compressed or
+// not. The page walk records their position and decompresses nothing.
+struct SasRowRef {
+  uint64_t off = 0;
+  uint32_t len = 0;
+  uint8_t  compr = 0;     // 0 raw, 1 SASYZCRL, 2 SASYZCR2
+};
+
+struct SasFile {
+
+  SasSource src;
+  uint64_t size = 0;
+
+  // header
+  std::string sasfile, dataset, filetype, sasrel, sasserv, osver, osmaker,
+    osname, compression, proc, sw, enc;
+  double created = 0, created2 = 0, modified = 0, modified2 = 0, thrdts = 0;
+  uint32_t headersize = 0, pagesize = 0;
+  int64_t pagecount = 0;
+  bool swapit = 0;
+  bool ibm = false;  // numerics are IBM floats, see readsas_xport()
+  uint8_t alignval = 8;
+  int16_t dataoffset = 0;
+
+  // row size and column size subheader
+  int compr = 0;
+  uint64_t rowlength = 0, delobs = 0;
+  int64_t n = 0, k = 0;
+
+  // columns in file order
+  std::vector<std::string> varnames, formats, labels;
+  std::vector<int32_t> vartyps, colwidth;
+  std::vector<int64_t> coloffset;
+  std::vector<double> fmtkeys, fmt32s, ifmt32s;
+  std::vector<int16_t> c8vec;
+  std::vector<int16_t> cnidx, cnoff, cnlen, cnzer;
+
+  // page map. If partial the page scan stopped early and pages holds only
+  // the pages scanned.
+  bool partial = false;
+  std::vector<SasPage> pages;
+  std::vector<int64_t> totalrowsvec; // rows up to and including page pg
+  std::vector<SasRowRef> rowrefs;    // compressed files only
+};
+
+
+// position of row r of an uncompressed file. returns false if r is not found
+// on any page.
+inline bool sas_row_pos(const SasFile& f, int64_t r, uint64_t& pos,
+                        int64_t& page, int64_t& ii)
+{
+  const std::vector<int64_t>& tr = f.totalrowsvec;
+
+  // first page that ends behind r
+  auto it = std::upper_bound(tr.begin(), tr.end(), r);
+  if (it == tr.end()) return false;
+
+  page = it - tr.begin();
+  ii = r - (page > 0 ? tr[page - 1] : 0);
+
+  pos = f.pages[page].data_pos + f.rowlength * (uint64_t)ii;
+
+  /* unknown: applies only to the first page containing data */
+  if (!(f.dataoffset == 1 || f.dataoffset == 256) &&
+      tr[page] == f.pages[page].rows)
+    pos += f.alignval;
+
+  return true;
+}
+
+inline bool sas_row_deleted(const SasFile& f, int64_t r)
+{
+  if (f.compr > 0) return false;
+
+  uint64_t pos = 0;
+  int64_t page = 0, ii = 0;
+  if (!sas_row_pos(f, r, pos, page, ii)) return false;
+
+  const std::string& dm = f.pages[page].delmarker;
+  return (uint64_t)ii < dm.size() && dm[ii] == '1';
+}
+
+inline int64_t sas_rows_available(const SasFile& f)
+{
+  if (f.compr > 0) return f.rowrefs.size();
+  return f.totalrowsvec.empty() ? 0 : f.totalrowsvec.back();
+}
+
+// page holding compressed row ref
+inline int64_t sas_rowref_page(const SasFile& f, const SasRowRef& ref)
+{
+  if (f.pagesize == 0 || ref.off < f.headersize) return 0;
+  return (ref.off - f.headersize) / f.pagesize;
+}
+
+// rows on the pages from to to, both included. Rows are numbered in page
+// order, the rows of a page range are consecutive and start at first.
+// Compressed rows belong to the page holding their subheader.
+inline void sas_page_rows(const SasFile& f, int64_t from, int64_t to,
+                          int64_t& first, int64_t& count)
+{
+  to = std::min<int64_t>(to, f.pages.size() - 1);
+
+  if (f.compr > 0) {
+    auto lo = std::partition_point(f.rowrefs.begin(), f.rowrefs.end(),
+                                   [&](const SasRowRef& ref) {
+                                     return sas_rowref_page(f, ref) < from;
+                                   });
+    auto hi = std::partition_point(lo, f.rowrefs.end(),
+                                   [&](const SasRowRef& ref) {
+                                     return sas_rowref_page(f, ref) <= to;
+                                   });
+    first = lo - f.rowrefs.begin();
+    count = hi - lo;
+    return;
+  }
+
+  const std::vector<int64_t>& tr = f.totalrowsvec;
+  int64_t np = tr.size();
+  first = from > 0 && np > 0 ? tr[std::min(from, np) - 1] : 0;
+  count = from <= to ? tr[to] - first : 0;
+}
+
+// read row r into buf. buf holds rowlength bytes afterwards. returns false if
+// the row is not available in the file. Decompression size mismatches are
+// counted in badrows, the row is padded or truncated to rowlength.
+inline bool sas_row(const SasFile& f, std::istream& sas, int64_t r,
+                    std::string& buf, std::string& tmp, int64_t& badrows,
+                    SasProfile* prof = nullptr)
+{
+  buf.resize(f.rowlength);
+
+  if (f.compr > 0) {
+
+    if (r < 0 || (uint64_t)r >= f.rowrefs.size()) return false;
+    const SasRowRef& ref = f.rowrefs[r];
+
+    if (ref.off + ref.len > f.size) return false;
+
+    sas.clear();
+    sas.seekg(ref.off, sas.beg);
+
+    if (ref.compr == 0) {
+      if (ref.len >= f.rowlength) {
+        if (!sas.read(&buf[0], f.rowlength)) return false;
+      } else {
+        std::fill(buf.begin(), buf.end(), '\0');
+        if (!sas.read(&buf[0], ref.len)) return false;
+      }
+      return true;
+    }
+
+    tmp.resize(ref.len);
+    if (!sas.read(&tmp[0], ref.len)) return false;
+
+    if (prof) {
+      prof->compressed_bytes += ref.len;
+      prof->uncompressed_bytes += f.rowlength;
+    }
+
+    if (ref.compr == 1)
+      buf = SASYZCRL(ref.len, f.rowlength, tmp);
+    else
+      buf = SASYZCR2(ref.len, f.rowlength, tmp);
+
+    if (buf.size() != f.rowlength) {
+      ++badrows;
+      buf.resize(f.rowlength, '\0');
+    }
+
+    return true;
+  }
+
+  uint64_t pos = 0;
+  int64_t page = 0, ii = 0;
+  if (!sas_row_pos(f, r, pos, page, ii)) return false;
+
+  if (pos + f.rowlength > f.size) return false;
+
+  // sequential reads do not require a seek
+  if ((uint64_t)sas.tellg() != pos) {
+    sas.clear();
+    sas.seekg(pos, sas.beg);
+  }
+
+  if (!sas.read(&buf[0], f.rowlength)) return false;
+
+  return true;
+}
+
+// numeric cell of width wid. Short numerics are truncated doubles, missing
+// bytes are the least significant ones.
+inline double sas_num(const char* p, int32_t wid, bool swapit)
+{
+  unsigned char buffer[8] = {0};
+  if (wid > 8) wid = 8;
+
+  if (swapit)
+    std::memcpy(buffer, p, wid);
+  else
+    std::memcpy(buffer + 8 - wid, p, wid);
+
+  double d = 0;
+  std::memcpy(&d, buffer, sizeof(d));
+
+  if (swapit) return swap_endian(d);
+  return d;
+}
+
+// 16^(e - 64) / 2^56 for the 7 bit exponents of IBM floats
+inline const double* sas_ibm_scale()
+{
+  static const std::vector<double> scale = []() {
+    std::vector<double> s(128);
+    for (int e = 0; e < 128; ++e) s[e] = std::ldexp(1.0, 4 * (e - 64) - 56);
+    return s;
+  }();
+  return scale.data();
+}
+
+// IBM float of width wid, stored big endian. Missings have a zero fraction
+// and '.', '_' or 'A' to 'Z' as first byte.
+inline double sas_ibm(const char* p, int32_t wid, const double* scale)
+{
+  if (wid > 8) wid = 8;
+
+  uint64_t v = 0;
+  for (int32_t b = 0; b < wid; ++b) v = (v << 8) | (unsigned char)p[b];
+  v <<= 8 * (8 - wid);
+
+  uint64_t frac = v & 0x00ffffffffffffffULL;
+  unsigned char first = v >> 56;
+
+  if (frac == 0 && first != 0 && first != 0x80) {
+    if (first == '_') return sas_missing(0);
+    if (first >= 'A' && first <= 'Z') return sas_missing(first - 'A' + 2);
+    return sas_missing(1);
+  }
+
+  double d = (double)frac * scale[first & 0x7f];
+  return (first & 0x80) ? -d : d;
+}
+
+// IBM floats of n cells stride bytes apart. Converted in a tight loop, once
+// per column of a block.
+inline void sas_ibm_block(const char* p, size_t n, uint64_t stride,
+                          int32_t wid, double* out)
+{
+  const double* scale = sas_ibm_scale();
+  for (size_t k = 0; k < n; ++k, p += stride)
+    out[k] = sas_ibm(p, wid, scale);
+}
+
+// numeric cell of f
+inline double sas_cell_num(const SasFile& f, const char* p, int32_t wid)
+{
+  if (f.ibm) return sas_ibm(p, wid, sas_ibm_scale());
+  return sas_num(p, wid, f.swapit);
+}
+
+// length of a character cell without trailing blanks. Cells end at the first
+// nul byte.
+inline size_t sas_strlen(const char* p, int32_t wid)
+{
+  const void* nul = std::memchr(p, '\0', wid);
+  size_t len = nul ? (const char*)nul - p : wid;
+  while (len > 0 && p[len - 1] == ' ') --len;
+  return len;
+}
+
+// cells outside of the row are treated as missing
+inline std::vector<bool> sas_inrow(const SasFile& f,
+                                   const std::vector<int64_t>& cols)
+{
+  std::vector<bool> inrow(cols.size());
+  for (size_t j = 0; j < cols.size(); ++j) {
+    int64_t c = cols[j];
+    inrow[j] = f.colwidth[c] > 0 && f.coloffset[c] >= 0 &&
+      (uint64_t)(f.coloffset[c] + f.colwidth[c]) <= f.rowlength;
+  }
+  return inrow;
+}
+
+// pass the cells of one row to the sink as row i
+template <typename Sink>
+inline void sas_cells(const SasFile& f, const char* row, size_t i,
+                      const std::vector<int64_t>& cols,
+                      const std::vector<bool>& inrow, Sink& sink)
+{
+  for (size_t j = 0; j < cols.size(); ++j) {
+    int64_t c = cols[j];
+    const char* p = row + f.coloffset[c];
+    int32_t wid = f.colwidth[c];
+
+    if (f.vartyps[c] == 1) {
+      if (inrow[j])
+        sink.num(i, j, sas_cell_num(f, p, wid));
+      else
+        sink.num(i, j, std::numeric_limits<double>::quiet_NaN());
+    } else {
+      if (inrow[j])
+        sink.str(i, j, p, sas_strlen(p, wid));
+      else
+        sink.str(i, j, p, 0);
+    }
+  }
+}
+
+// read row r, optionally timed. Meant for single rows such as probes, scans
+// read batches with sas_read_batch().
+inline bool sas_row_timed(const SasFile& f, std::istream& sas, int64_t r,
+                          std::string& buf, std::string& tmp,
+                          int64_t& badrows, SasProfile* prof)
+{
+  if (!prof) return sas_row(f, sas, r, buf, tmp, badrows);
+
+  SasClock::time_point t0 = SasClock::now();
+  bool found = sas_row(f, sas, r, buf, tmp, badrows, prof);
+  prof->wall[SAS_PHASE_READ] += sas_seconds(t0);
+  prof->peak_buffer = std::max<uint64_t>(prof->peak_buffer,
+                                         buf.capacity() + tmp.capacity());
+  return found;
+}
+
+// rows per block of the columnar decoder are limited to this many bytes. A
+// block of wide rows stays in the cache while it is transposed.
+const uint64_t SAS_BLOCK_BYTES = 256 * 1024;
+
+// number of rows starting at rows[i] that are stored back to back on a single
+// page of an uncompressed file, at most SAS_BLOCK_BYTES. pos is the position
+// of the first row. Returns 0 if the rows can not be read as a block.
+inline size_t sas_block(const SasFile& f, const std::vector<int64_t>& rows,
+                        size_t i, uint64_t& pos)
+{
+  if (f.compr > 0 || f.rowlength == 0) return 0;
+
+  int64_t page = 0, ii = 0;
+  if (!sas_row_pos(f, rows[i], pos, page, ii) || pos >= f.size) return 0;
+
+  uint64_t max = std::max<uint64_t>(1, SAS_BLOCK_BYTES / f.rowlength);
+  max = std::min<uint64_t>(max, (f.size - pos) / f.rowlength);
+
+  int64_t end = f.totalrowsvec[page];
+  size_t n = 1;
+  while (n < max && i + n < rows.size() &&
+         rows[i + n] == rows[i] + (int64_t)n && rows[i + n] < end)
+    ++n;
+
+  return n;
+}
+
+// pass the cells of n rows stored back to back in slab to the sink as rows i
+// to i + n - 1. The slab is transposed one column at a time, every output
+// column is written sequentially.
+template <typename Sink>
+inline void sas_cells_block(const SasFile& f, const char* slab, size_t n,
+                            size_t i, const std::vector<int64_t>& cols,
+                            const std::vector<bool>& inrow, Sink& sink,
+                            SasProfile* prof = nullptr)
+{
+  const uint64_t rl = f.rowlength;
+  std::vector<double> ibm;
+
+  for (size_t j = 0; j < cols.size(); ++j) {
+    int64_t c = cols[j];
+    int32_t wid = f.colwidth[c];
+
+    if (!inrow[j]) {
+      for (size_t k = 0; k < n; ++k) {
+        if (f.vartyps[c] == 1)
+          sink.num(i + k, j, std::numeric_limits<double>::quiet_NaN());
+        else
+          sink.str(i + k, j, slab, 0);
+      }
+      continue;
+    }
+
+    const char* p = slab + f.coloffset[c];
+
+    if (f.vartyps[c] != 1) {
+      // timed once per column of a block
+      SasClock::time_point t0;
+      if (prof) t0 = SasClock::now();
+      for (size_t k = 0; k < n; ++k, p += rl)
+        sink.str(i + k, j, p, sas_strlen(p, wid));
+      if (prof) prof->wall[SAS_PHASE_STRINGS] += sas_seconds(t0);
+    } else if (f.ibm) {
+      ibm.resize(n);
+      sas_ibm_block(p, n, rl, wid, ibm.data());
+      for (size_t k = 0; k < n; ++k)
+        sink.num(i + k, j, ibm[k]);
+    } else if (wid == 8 && !f.swapit) {
+      // full doubles in native byte order are copied as is
+      for (size_t k = 0; k < n; ++k, p += rl) {
+        double d;
+        std::memcpy(&d, p, sizeof(d));
+        sink.num(i + k, j, d);
+      }
+    } else {
+      for (size_t k = 0; k < n; ++k, p += rl)
+        sink.num(i + k, j, sas_num(p, wid, f.swapit));
+    }
+  }
+}
+
+// read the m rows rowat(i) to rowat(i + m - 1) back to back into slab.
+// found[k] is false for rows that are not available, their bytes are zero.
+// The reads are timed together.
+template <typename RowAt>
+inline void sas_read_batch(const SasFile& f, std::istream& sas, RowAt rowat,
+                           size_t i, size_t m, std::string& slab,
+                           std::vector<char>& found, std::string& buf,
+                           std::string& tmp, int64_t& badrows,
+                           SasProfile* prof)
+{
+  SasClock::time_point t0;
+  if (prof) t0 = SasClock::now();
+
+  const uint64_t rl = f.rowlength;
+  slab.assign(m * rl, '\0');
+  found.assign(m, 0);
+
+  for (size_t k = 0; k < m; ++k) {
+    if (!sas_row(f, sas, rowat(i + k), buf, tmp, badrows, prof)) continue;
+    if (rl > 0) std::memcpy(&slab[k * rl], buf.data(), rl);
+    found[k] = 1;
+  }
+
+  if (prof) {
+    prof->wall[SAS_PHASE_READ] += sas_seconds(t0);
+    prof->peak_buffer = std::max<uint64_t>(prof->peak_buffer,
+                                           slab.capacity() + buf.capacity() +
+                                           tmp.capacity());
+  }
+}
+
+// pass the n rows rowat(0) to rowat(n - 1) to fn(i, m, slab, found) in
+// batches of at most SAS_BLOCK_BYTES, see sas_read_batch(). Returns the
+// number of rows with an unexpected size after decompression.
+template <typename RowAt, typename Fn>
+int64_t sas_scan(const SasFile& f, std::istream& sas, size_t n, RowAt rowat,
+                 Fn fn, SasProfile* prof = nullptr)
+{
+  std::string slab, buf, tmp;
+  std::vector<char> found;
+  int64_t badrows = 0;
+
+  size_t max = std::max<uint64_t>(1, SAS_BLOCK_BYTES /
+                                  std::max<uint64_t>(f.rowlength, 1));
+
+  for (size_t i = 0; i < n; ) {
+    size_t m = std::min(max, n - i);
+    sas_read_batch(f, sas, rowat, i, m, slab, found, buf, tmp, badrows, prof);
+    fn(i, m, slab.data(), found);
+    i += m;
+  }
+
+  return badrows;
+}
+
+// decode rows of f. cols are column positions in file order. For every cell
+// the sink receives sink.num(i, j, value) or sink.str(i, j, ptr, len), where
+// i is the position in rows and j the position in cols. Rows not available in
+// the file are passed to sink.missing(i). Returns the number of rows with an
+// unexpected size after decompression.
+//
+// Consecutive rows of uncompressed files are read in blocks, everything else
+// row by row into batches. Both are decoded column by column, the cells of a
+// column always arrive in the order of rows.
+template <typename Sink>
+int64_t sas_decode(const SasFile& f, std::istream& sas,
+                   const std::vector<int64_t>& rows,
+                   const std::vector<int64_t>& cols, Sink& sink,
+                   SasProfile* prof = nullptr)
+{
+  std::string buf, tmp, slab;
+  std::vector<char> found;
+  int64_t badrows = 0;
+
+  std::vector<bool> inrow = sas_inrow(f, cols);
+  auto rowat = [&rows](size_t k) { return rows[k]; };
+  const uint64_t max = std::max<uint64_t>(1, SAS_BLOCK_BYTES /
+                                          std::max<uint64_t>(f.rowlength, 1));
+
+  for (size_t i = 0; i < rows.size(); ) {
+
+    uint64_t pos = 0;
+    size_t n = sas_block(f, rows, i, pos);
+
+    if (n > 1) {
+      SasClock::time_point t0;
+      if (prof) t0 = SasClock::now();
+
+      slab.resize(n * f.rowlength);
+      if ((uint64_t)sas.tellg() != pos) {
+        sas.clear();
+        sas.seekg(pos, sas.beg);
+      }
+      bool found = (bool)sas.read(&slab[0], slab.size());
+
+      if (prof) {
+        prof->wall[SAS_PHASE_READ] += sas_seconds(t0);
+        prof->peak_buffer = std::max<uint64_t>(prof->peak_buffer,
+                                               slab.capacity());
+      }
+
+      if (found) {
+        sas_cells_block(f, slab.data(), n, i, cols, inrow, sink, prof);
+        i += n;
+        continue;
+      }
+
+      // a short read is retried row by row
+      sas.clear();
+    }
+
+    // rows up to the next block
+    size_t m = 1;
+    while (m < max && i + m < rows.size() && sas_block(f, rows, i + m, pos) <= 1)
+      ++m;
+
+    sas_read_batch(f, sas, rowat, i, m, slab, found, buf, tmp, badrows, prof);
+
+    for (size_t k = 0; k < m; ) {
+      if (!found[k]) {
+        sink.missing(i + k);
+        ++k;
+        continue;
+      }
+      size_t e = k + 1;
+      while (e < m && found[e]) ++e;
+      sas_cells_block(f, slab.data() + k * f.rowlength, e - k, i + k, cols,
+                      inrow, sink, prof);
+      k = e;
+    }
+
+    i += m;
+  }
+
+  return badrows;
+}
+
+#endif
@@ -0,0 +1,511 @@
+#ifndef SASFILTER_H
+#define SASFILTER_H
+
+/*
+ * Predicate pushdown. Simple comparisons on numeric columns are evaluated on
+ * the raw row, before any cell is passed to a sink. Per page zone maps hold
+ * min, max and the number of missings of every numeric column, pages that
+ * can not match are skipped without being read or decompressed. Zone maps
+ * can be stored next to the file and are reused as long as the file is
+ * unchanged. On columns sorted in ascending order the rows that can match
+ * are found with a binary search over the first row of every page.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "sasfile.h"
+
+enum SasOp {
+  SAS_EQ = 0, SAS_NE, SAS_LT, SAS_LE, SAS_GT, SAS_GE, SAS_ISNA, SAS_NOTNA
+};
+
+// col op value. Predicates are combined with and. Like in R a missing never
+// compares true, it only matches SAS_ISNA. Neither does a comparison with a
+// missing constant, SAS_NE included.
+struct SasPredicate {
+  int64_t col = 0;
+  int op = SAS_EQ;
+  double value = 0;
+};
+
+inline bool sas_match(double x, int op, double value)
+{
+  if (std::isnan(x)) return op == SAS_ISNA;
+  if (std::isnan(value) && op <= SAS_GE) return false;
+
+  switch (op) {
+  case SAS_EQ:    return x == value;
+  case SAS_NE:    return x != value;
+  case SAS_LT:    return x < value;
+  case SAS_LE:    return x <= value;
+  case SAS_GT:    return x > value;
+  case SAS_GE:    return x >= value;
+  case SAS_NOTNA: return true;
+  }
+  return false;
+}
+
+inline bool sas_match_row(const SasFile& f, const char* row,
+                          const std::vector<SasPredicate>& where)
+{
+  for (auto& w : where) {
+    int64_t c = w.col;
+    double x = std::numeric_limits<double>::quiet_NaN();
+    if (f.colwidth[c] > 0 && f.coloffset[c] >= 0 &&
+        (uint64_t)(f.coloffset[c] + f.colwidth[c]) <= f.rowlength)
+      x = sas_cell_num(f, row + f.coloffset[c], f.colwidth[c]);
+    if (!sas_match(x, w.op, w.value)) return false;
+  }
+  return true;
+}
+
+// zones are the rows of a page. For compressed files these are the rows
+// stored in the subheaders of a page.
+struct SasZoneMap {
+  // file the map was built for
+  uint64_t size = 0;
+  int64_t pagecount = 0, n = 0;
+  uint64_t rowlength = 0;
+  double created = 0, modified = 0;
+
+  std::vector<int64_t> ends;      // rows up to and including zone z
+  std::vector<int64_t> cols;      // numeric columns in file order
+  std::vector<double> min, max;   // [z * cols.size() + j]
+  std::vector<int64_t> nulls;
+
+  bool empty() const { return ends.empty(); }
+};
+
+inline std::vector<int64_t> sas_zone_ends(const SasFile& f)
+{
+  if (f.compr == 0) return f.totalrowsvec;
+
+  std::vector<int64_t> ends;
+  int64_t last = -1;
+  for (size_t r = 0; r < f.rowrefs.size(); ++r) {
+    int64_t page = 0;
+    if (f.pagesize > 0 && f.rowrefs[r].off >= f.headersize)
+      page = (f.rowrefs[r].off - f.headersize) / f.pagesize;
+    if (page != last && r > 0) ends.push_back(r);
+    last = page;
+  }
+  if (!f.rowrefs.empty()) ends.push_back(f.rowrefs.size());
+  return ends;
+}
+
+// zone ends clipped to the rows of the file. Page row counts may exceed the
+// row count, rows behind it are never read.
+inline std::vector<int64_t> sas_zone_ends_clipped(const SasFile& f)
+{
+  int64_t avail = std::min(f.n, sas_rows_available(f));
+  std::vector<int64_t> ends = sas_zone_ends(f);
+  for (auto& e : ends) e = std::min(e, avail);
+  return ends;
+}
+
+inline bool sas_zonemap_valid(const SasZoneMap& zm, const SasFile& f)
+{
+  return !zm.empty() && zm.size == f.size && zm.pagecount == f.pagecount &&
+    zm.n == f.n && zm.rowlength == f.rowlength && zm.created == f.created &&
+    zm.modified == f.modified;
+}
+
+// one pass over all rows
+inline int64_t sas_zonemap_build(const SasFile& f, std::istream& sas,
+                                 SasZoneMap& zm, SasProfile* prof = nullptr)
+{
+  zm = SasZoneMap();
+  zm.size = f.size;
+  zm.pagecount = f.pagecount;
+  zm.n = f.n;
+  zm.rowlength = f.rowlength;
+  zm.created = f.created;
+  zm.modified = f.modified;
+  zm.ends = sas_zone_ends(f);
+
+  for (size_t c = 0; c < f.vartyps.size(); ++c)
+    if (f.vartyps[c] == 1) zm.cols.push_back(c);
+
+  size_t kk = zm.cols.size(), nz = zm.ends.size();
+  zm.min.assign(nz * kk, std::numeric_limits<double>::infinity());
+  zm.max.assign(nz * kk, -std::numeric_limits<double>::infinity());
+  zm.nulls.assign(nz * kk, 0);
+
+  std::vector<bool> inrow = sas_inrow(f, zm.cols);
+  size_t z = 0;
+
+  auto zone = [&](size_t i, size_t m, const char* slab,
+                  const std::vector<char>& found) {
+    for (size_t k = 0; k < m; ++k) {
+      int64_t r = i + k;
+      while (r >= zm.ends[z]) ++z;
+
+      double* mn = &zm.min[z * kk];
+      double* mx = &zm.max[z * kk];
+      int64_t* na = &zm.nulls[z * kk];
+
+      // unreadable rows could hold anything
+      if (!found[k]) {
+        for (size_t j = 0; j < kk; ++j) {
+          mn[j] = -std::numeric_limits<double>::infinity();
+          mx[j] = std::numeric_limits<double>::infinity();
+          ++na[j];
+        }
+        continue;
+      }
+
+      const char* row = slab + k * f.rowlength;
+      for (size_t j = 0; j < kk; ++j) {
+        int64_t c = zm.cols[j];
+        if (!inrow[j]) {
+          ++na[j];
+          continue;
+        }
+        double x = sas_cell_num(f, row + f.coloffset[c], f.colwidth[c]);
+        if (std::isnan(x)) {
+          ++na[j];
+        } else {
+          if (x < mn[j]) mn[j] = x;
+          if (x > mx[j]) mx[j] = x;
+        }
+      }
+    }
+  };
+
+  int64_t n = nz > 0 ? zm.ends.back() : 0;
+  return sas_scan(f, sas, n, [](size_t k) { return (int64_t)k; }, zone, prof);
+}
+
+// true if no row of zone z can match
+inline bool sas_zone_skip(const SasZoneMap& zm, size_t z,
+                          const std::vector<SasPredicate>& where)
+{
+  size_t kk = zm.cols.size();
+  int64_t rows = zm.ends[z] - (z > 0 ? zm.ends[z - 1] : 0);
+
+  for (auto& w : where) {
+    auto it = std::lower_bound(zm.cols.begin(), zm.cols.end(), w.col);
+    if (it == zm.cols.end() || *it != w.col) continue;
+    size_t j = it - zm.cols.begin();
+
+    double mn = zm.min[z * kk + j], mx = zm.max[z * kk + j];
+    int64_t na = zm.nulls[z * kk + j];
+
+    if (std::isnan(w.value) && w.op <= SAS_GE) return true;
+
+    // without values min is Inf and max is -Inf, comparisons fail
+    bool skip = false;
+    switch (w.op) {
+    case SAS_EQ:    skip = w.value < mn || w.value > mx; break;
+    case SAS_NE:    skip = mn == w.value && mx == w.value; break;
+    case SAS_LT:    skip = mn >= w.value; break;
+    case SAS_LE:    skip = mn > w.value; break;
+    case SAS_GT:    skip = mx <= w.value; break;
+    case SAS_GE:    skip = mx < w.value; break;
+    case SAS_ISNA:  skip = na == 0; break;
+    case SAS_NOTNA: skip = na == rows; break;
+    }
+    if (skip) return true;
+  }
+
+  return false;
+}
+
+// drop rows in zones that can not match. rows must be sorted.
+inline std::vector<int64_t> sas_zone_filter(const SasZoneMap& zm,
+                                            const std::vector<int64_t>& rows,
+                                            const std::vector<SasPredicate>& where)
+{
+  if (zm.empty() || where.empty()) return rows;
+
+  std::vector<int64_t> out;
+  out.reserve(rows.size());
+
+  size_t z = 0;
+  bool skip = sas_zone_skip(zm, 0, where);
+
+  for (auto r : rows) {
+    if (z < zm.ends.size() && r >= zm.ends[z]) {
+      while (z < zm.ends.size() && r >= zm.ends[z]) ++z;
+      skip = z < zm.ends.size() && sas_zone_skip(zm, z, where);
+    }
+    if (!skip) out.push_back(r);
+  }
+
+  return out;
+}
+
+// sorted columns. The first row of every zone is decoded on demand, the
+// zones that can hold rows matching where are found with a binary search on
+// these keys. Missings sort first as in SAS, unreadable rows are treated as
+// missings.
+struct SasSortedProbe {
+  const SasFile& f;
+  std::istream& sas;
+  SasProfile* prof;
+  int64_t col;
+  bool inrow;
+  std::vector<int64_t> starts, ends;  // zones holding rows
+  std::vector<double> keys;
+  std::vector<bool> known;
+  std::string buf, tmp;
+  int64_t badrows = 0, probes = 0;
+
+  SasSortedProbe(const SasFile& f, std::istream& sas, int64_t col,
+                 SasProfile* prof)
+    : f(f), sas(sas), prof(prof), col(col),
+      inrow(sas_inrow(f, std::vector<int64_t>(1, col))[0]) {
+    int64_t last = 0;
+    for (auto e : sas_zone_ends_clipped(f)) {
+      if (e > last) {
+        starts.push_back(last);
+        ends.push_back(e);
+        last = e;
+      }
+    }
+    keys.resize(starts.size());
+    known.resize(starts.size());
+  }
+
+  double key(size_t z) {
+    if (!known[z]) {
+      double x = -std::numeric_limits<double>::infinity();
+      if (sas_row_timed(f, sas, starts[z], buf, tmp, badrows, prof) &&
+          inrow) {
+        double v = sas_cell_num(f, buf.data() + f.coloffset[col],
+                                f.colwidth[col]);
+        if (!std::isnan(v)) x = v;
+      }
+      keys[z] = x;
+      known[z] = true;
+      ++probes;
+    }
+    return keys[z];
+  }
+
+  // first zone in [lo, hi) for which below(key) is false
+  template <typename Pred>
+  size_t search(size_t lo, size_t hi, Pred below) {
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (below(key(mid)))
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+};
+
+// rows [first, last) that can match where if col is sorted in ascending
+// order. Only the predicates on col narrow the span, about 2 log2(zones)
+// rows are read. Returns the number of rows with an unexpected size after
+// decompression.
+inline int64_t sas_sorted_span(const SasFile& f, std::istream& sas,
+                               int64_t col,
+                               const std::vector<SasPredicate>& where,
+                               int64_t& first, int64_t& last,
+                               int64_t& probes, SasProfile* prof = nullptr)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  double lo = -inf, hi = inf;
+  bool none = false;
+
+  for (auto& w : where) {
+    if (w.col != col) continue;
+    if (std::isnan(w.value) && w.op <= SAS_GE) none = true;
+
+    switch (w.op) {
+    case SAS_EQ: lo = std::max(lo, w.value); hi = std::min(hi, w.value); break;
+    case SAS_GT:
+    case SAS_GE: lo = std::max(lo, w.value); break;
+    case SAS_LT:
+    case SAS_LE: hi = std::min(hi, w.value); break;
+    case SAS_ISNA: hi = -inf; break;  // missings come first
+    }
+  }
+
+  SasSortedProbe probe(f, sas, col, prof);
+  size_t nz = probe.starts.size();
+
+  first = last = probes = 0;
+  if (nz == 0 || none || lo > hi) return 0;
+
+  // equal keys may continue from the zone before the first zone starting
+  // with a key >= lo
+  size_t z0 = 0;
+  if (lo > -inf) {
+    z0 = probe.search(0, nz, [lo](double x) { return x < lo; });
+    if (z0 > 0) --z0;
+  }
+
+  size_t z1 = nz;
+  if (hi < inf)
+    z1 = probe.search(z0, nz, [hi](double x) { return x <= hi; });
+
+  if (z1 > z0) {
+    first = probe.starts[z0];
+    last = probe.ends[z1 - 1];
+  }
+  probes = probe.probes;
+
+  return probe.badrows;
+}
+
+// rows matching where. Only the cells of the where columns are decoded, the
+// matching rows can be decoded afterwards with sas_decode(). This is the
+// first phase of a two phase read, sinks need to know the number of rows in
+// advance. Returns the number of rows with an unexpected size after
+// decompression.
+inline int64_t sas_select_where(const SasFile& f, std::istream& sas,
+                                const std::vector<int64_t>& rows,
+                                const std::vector<SasPredicate>& where,
+                                std::vector<int64_t>& matched,
+                                SasProfile* prof = nullptr)
+{
+  auto select = [&](size_t i, size_t m, const char* slab,
+                    const std::vector<char>& found) {
+    for (size_t k = 0; k < m; ++k)
+      if (found[k] && sas_match_row(f, slab + k * f.rowlength, where))
+        matched.push_back(rows[i + k]);
+  };
+
+  return sas_scan(f, sas, rows.size(),
+                  [&rows](size_t k) { return rows[k]; }, select, prof);
+}
+
+// single pass variant for sinks that can grow: decode rows matching where.
+// Matching rows are passed to the sink in order
+// as rows 0, 1, ... and are appended to matched. Returns the number of rows
+// with an unexpected size after decompression.
+template <typename Sink>
+int64_t sas_decode_where(const SasFile& f, std::istream& sas,
+                         const std::vector<int64_t>& rows,
+                         const std::vector<int64_t>& cols,
+                         const std::vector<SasPredicate>& where, Sink& sink,
+                         std::vector<int64_t>& matched,
+                         SasProfile* prof = nullptr)
+{
+  std::vector<bool> inrow = sas_inrow(f, cols);
+  std::string hits;
+
+  // matching rows of a batch are decoded together
+  auto decode = [&](size_t i, size_t m, const char* slab,
+                    const std::vector<char>& found) {
+    const uint64_t rl = f.rowlength;
+    size_t first = matched.size();
+    hits.clear();
+    for (size_t k = 0; k < m; ++k) {
+      const char* row = slab + k * rl;
+      if (!found[k] || !sas_match_row(f, row, where)) continue;
+      hits.append(row, rl);
+      matched.push_back(rows[i + k]);
+    }
+    if (matched.size() > first)
+      sas_cells_block(f, hits.data(), matched.size() - first, first, cols,
+                      inrow, sink, prof);
+  };
+
+  return sas_scan(f, sas, rows.size(),
+                  [&rows](size_t k) { return rows[k]; }, decode, prof);
+}
+
+
+// zone map files: magic, a byte order mark and the fields of SasZoneMap in
+// native byte order. Maps written on another platform are rebuilt.
+static const char SAS_ZONEMAP_MAGIC[8] = {'S','A','S','Z','M','A','P','1'};
+
+template <typename T>
+inline void sas_zm_put(std::ostream& out, const T& v)
+{
+  out.write((const char*)&v, sizeof(v));
+}
+
+template <typename T>
+inline void sas_zm_put(std::ostream& out, const std::vector<T>& v)
+{
+  uint64_t n = v.size();
+  sas_zm_put(out, n);
+  if (n) out.write((const char*)v.data(), n * sizeof(T));
+}
+
+template <typename T>
+inline bool sas_zm_get(std::istream& in, T& v)
+{
+  return (bool)in.read((char*)&v, sizeof(v));
+}
+
+template <typename T>
+inline bool sas_zm_get(std::istream& in, std::vector<T>& v, uint64_t max)
+{
+  uint64_t n = 0;
+  if (!sas_zm_get(in, n) || n > max) return false;
+  v.resize(n);
+  return n == 0 || (bool)in.read((char*)v.data(), n * sizeof(T));
+}
+
+inline bool sas_zonemap_write(const std::string& path, const SasZoneMap& zm)
+{
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out) return false;
+
+  out.write(SAS_ZONEMAP_MAGIC, sizeof(SAS_ZONEMAP_MAGIC));
+  sas_zm_put(out, (uint32_t)0x01020304);
+  sas_zm_put(out, zm.size);
+  sas_zm_put(out, zm.pagecount);
+  sas_zm_put(out, zm.n);
+  sas_zm_put(out, zm.rowlength);
+  sas_zm_put(out, zm.created);
+  sas_zm_put(out, zm.modified);
+  sas_zm_put(out, zm.ends);
+  sas_zm_put(out, zm.cols);
+  sas_zm_put(out, zm.min);
+  sas_zm_put(out, zm.max);
+  sas_zm_put(out, zm.nulls);
+
+  out.flush();
+  return (bool)out;
+}
+
+// false if the file is missing, damaged or was built for another file
+inline bool sas_zonemap_read(const std::string& path, const SasFile& f,
+                             SasZoneMap& zm)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) return false;
+
+  char magic[8];
+  uint32_t bom = 0;
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, SAS_ZONEMAP_MAGIC, sizeof(magic)) != 0 ||
+      !sas_zm_get(in, bom) || bom != 0x01020304)
+    return false;
+
+  SasZoneMap z;
+  uint64_t max = f.pagecount + f.n + 1;
+  uint64_t kk = f.vartyps.size();
+  bool ok = sas_zm_get(in, z.size) && sas_zm_get(in, z.pagecount) &&
+    sas_zm_get(in, z.n) && sas_zm_get(in, z.rowlength) &&
+    sas_zm_get(in, z.created) && sas_zm_get(in, z.modified) &&
+    sas_zm_get(in, z.ends, max) && sas_zm_get(in, z.cols, kk) &&
+    sas_zm_get(in, z.min, max * kk) && sas_zm_get(in, z.max, max * kk) &&
+    sas_zm_get(in, z.nulls, max * kk);
+
+  size_t cells = z.ends.size() * z.cols.size();
+  if (!ok || !sas_zonemap_valid(z, f) || z.min.size() != cells ||
+      z.max.size() != cells || z.nulls.size() != cells)
+    return false;
+
+  for (auto c : z.cols)
+    if (c < 0 || (uint64_t)c >= kk || f.vartyps[c] != 1) return false;
+
+  zm = z;
+  return true;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef SASFORMAT_H
+#define SASFORMAT_H
+
+/*
+ * User defined formats, the value labels of PROC FORMAT as stored in sas7bcat
+ * catalogs. A format maps numeric values or ranges, or character values, to
+ * labels. While decoding, single values are looked up in a hash table and
+ * ranges with a binary search.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// NaN of a SAS missing as decoded from a data file. Tags are 0 for ._, 1 for
+// . and 2 to 27 for .A to .Z, the file stores the complement of the tag.
+inline double sas_missing(uint8_t tag)
+{
+  uint64_t bits = 0xffff000000000000ULL | (uint64_t)(uint8_t)~tag << 40;
+  double x;
+  std::memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+inline uint8_t sas_missing_tag(double x)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  return (uint8_t)~(bits >> 40);
+}
+
+// ".", "._" or ".A" to ".Z"
+inline std::string sas_missing_name(uint8_t tag)
+{
+  if (tag == 1) return ".";
+  if (tag == 0) return "._";
+  if (tag < 28) return std::string(".") + (char)('A' + tag - 2);
+  return ".";
+}
+
+// tag of a missing name, 1 for anything unknown
+inline uint8_t sas_missing_code(const std::string& name)
+{
+  if (name == "._" || name == "_") return 0;
+  char c = name.size() == 2 && name[0] == '.' ? name[1] :
+    name.size() == 1 ? name[0] : '.';
+  if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+  if (c >= 'A' && c <= 'Z') return c - 'A' + 2;
+  return 1;
+}
+
+struct SasFormat {
+  std::string name;                // character formats start with $
+  bool numeric = true;
+  std::vector<double> start, end;  // numeric formats, single values have
+                                   // start == end, missings are sas_missing()
+  std::vector<std::string> values; // character formats
+  std::vector<std::string> labels;
+};
+
+struct SasCatalog {
+  std::string enc;
+  std::vector<SasFormat> formats;
+};
+
+// position of the label of a value in a format or -1. Ranges must not
+// overlap, they include both ends.
+class SasFormatLookup {
+public:
+  explicit SasFormatLookup(const SasFormat& fmt) {
+    if (!fmt.numeric) {
+      for (size_t i = 0; i < fmt.values.size(); ++i)
+        str_.emplace(fmt.values[i], i);
+      return;
+    }
+
+    for (size_t i = 0; i < fmt.start.size(); ++i) {
+      if (std::isnan(fmt.start[i]) || fmt.start[i] == fmt.end[i])
+        num_.emplace(key(fmt.start[i]), i);
+      else
+        ranges_.push_back({fmt.start[i], fmt.end[i], (int64_t)i});
+    }
+
+    std::sort(ranges_.begin(), ranges_.end(),
+              [](const Range& a, const Range& b) { return a.lo < b.lo; });
+  }
+
+  int64_t find(double x) const {
+    auto it = num_.find(key(x));
+    if (it != num_.end()) return it->second;
+    if (std::isnan(x) || ranges_.empty()) return -1;
+
+    // last range starting at or before x
+    auto r = std::upper_bound(ranges_.begin(), ranges_.end(), x,
+                              [](double v, const Range& a) {
+                                return v < a.lo;
+                              });
+    if (r == ranges_.begin()) return -1;
+    --r;
+    return x <= r->hi ? r->pos : -1;
+  }
+
+  int64_t find(const char* p, size_t len) const {
+    auto it = str_.find(std::string(p, len));
+    return it == str_.end() ? -1 : it->second;
+  }
+
+private:
+  struct Range {
+    double lo, hi;
+    int64_t pos;
+  };
+
+  // -0 is 0, missings are compared by their tag
+  static uint64_t key(double x) {
+    if (x == 0) x = 0;
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    if (std::isnan(x)) bits &= 0xffffff0000000000ULL;
+    return bits;
+  }
+
+  std::unordered_map<std::string, int64_t> str_;
+  std::unordered_map<uint64_t, int64_t> num_;
+  std::vector<Range> ranges_;
+};
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef SASINDEX_H
+#define SASINDEX_H
+
+/*
+ * Key indexes. The values of a numeric column are stored in sorted order
+ * together with their rows. Comparisons with a constant are resolved to rows
+ * with a binary search, only the pages holding these rows are read. SAS index
+ * files (sas7bndx) use an undocumented layout and are not read, indexes are
+ * built with a single scan and stored next to the file like zone maps. The
+ * index file is read as a whole for each query, 16 bytes per row and column.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sasfilter.h"
+
+struct SasKeyIndex {
+  int64_t col = 0;
+  std::vector<double> keys;   // ascending, missings at the end
+  std::vector<int64_t> rows;  // row of keys[i], ascending for equal keys
+  int64_t nulls = 0;          // number of missings
+};
+
+struct SasIndex {
+  // file the index was built for
+  uint64_t size = 0;
+  int64_t pagecount = 0, n = 0;
+  uint64_t rowlength = 0;
+  double created = 0, modified = 0;
+
+  std::vector<SasKeyIndex> keys;  // ordered by column
+
+  const SasKeyIndex* find(int64_t col) const {
+    auto it = std::lower_bound(keys.begin(), keys.end(), col,
+                               [](const SasKeyIndex& k, int64_t c) {
+                                 return k.col < c;
+                               });
+    return it != keys.end() && it->col == col ? &*it : nullptr;
+  }
+};
+
+inline bool sas_index_valid(const SasIndex& idx, const SasFile& f)
+{
+  return idx.size == f.size && idx.pagecount == f.pagecount &&
+    idx.n == f.n && idx.rowlength == f.rowlength &&
+    idx.created == f.created && idx.modified == f.modified;
+}
+
+// adds the numeric columns cols to idx with one pass over all rows. Rows that
+// can not be read are left out, they never match a predicate. Returns the
+// number of rows with an unexpected size after decompression.
+inline int64_t sas_index_build(const SasFile& f, std::istream& sas,
+                               const std::vector<int64_t>& cols,
+                               SasIndex& idx, SasProfile* prof = nullptr)
+{
+  if (!sas_index_valid(idx, f)) {
+    idx = SasIndex();
+    idx.size = f.size;
+    idx.pagecount = f.pagecount;
+    idx.n = f.n;
+    idx.rowlength = f.rowlength;
+    idx.created = f.created;
+    idx.modified = f.modified;
+  }
+
+  std::vector<int64_t> add;
+  for (auto c : cols)
+    if (f.vartyps[c] == 1 && !idx.find(c) &&
+        std::find(add.begin(), add.end(), c) == add.end())
+      add.push_back(c);
+  if (add.empty()) return 0;
+
+  size_t kk = add.size();
+  std::vector<std::vector<std::pair<double, int64_t>>> vals(kk);
+  std::vector<std::vector<int64_t>> nulls(kk);
+  std::vector<bool> inrow = sas_inrow(f, add);
+
+  auto collect = [&](size_t i, size_t m, const char* slab,
+                     const std::vector<char>& found) {
+    for (size_t k = 0; k < m; ++k) {
+      if (!found[k]) continue;
+
+      int64_t r = i + k;
+      const char* row = slab + k * f.rowlength;
+      for (size_t j = 0; j < kk; ++j) {
+        int64_t c = add[j];
+        double x = std::numeric_limits<double>::quiet_NaN();
+        if (inrow[j])
+          x = sas_cell_num(f, row + f.coloffset[c], f.colwidth[c]);
+        if (std::isnan(x))
+          nulls[j].push_back(r);
+        else
+          vals[j].emplace_back(x, r);
+      }
+    }
+  };
+
+  int64_t avail = std::min(f.n, sas_rows_available(f));
+  int64_t badrows = sas_scan(f, sas, std::max<int64_t>(avail, 0),
+                             [](size_t k) { return (int64_t)k; }, collect,
+                             prof);
+
+  for (size_t j = 0; j < kk; ++j) {
+    // pairs sort by value, then by row
+    std::sort(vals[j].begin(), vals[j].end());
+
+    SasKeyIndex ki;
+    ki.col = add[j];
+    ki.nulls = nulls[j].size();
+    ki.keys.reserve(vals[j].size() + nulls[j].size());
+    ki.rows.reserve(vals[j].size() + nulls[j].size());
+    for (auto& v : vals[j]) {
+      ki.keys.push_back(v.first);
+      ki.rows.push_back(v.second);
+    }
+    for (auto r : nulls[j]) {
+      ki.keys.push_back(std::numeric_limits<double>::quiet_NaN());
+      ki.rows.push_back(r);
+    }
+
+    idx.keys.push_back(std::move(ki));
+  }
+
+  std::sort(idx.keys.begin(), idx.keys.end(),
+            [](const SasKeyIndex& a, const SasKeyIndex& b) {
+              return a.col < b.col;
+            });
+
+  return badrows;
+}
+
+// sorted rows of ki that can match w. False if the index does not help, as
+// for SAS_NE with a value.
+inline bool sas_index_rows(const SasKeyIndex& ki, const SasPredicate& w,
+                           std::vector<int64_t>& out)
+{
+  auto first = ki.keys.begin();
+  auto last = ki.keys.end() - ki.nulls;
+  auto lo = first, hi = first;
+
+  // comparisons with a missing never match
+  bool na = std::isnan(w.value);
+
+  switch (w.op) {
+  case SAS_EQ:
+    if (!na) {
+      lo = std::lower_bound(first, last, w.value);
+      hi = std::upper_bound(lo, last, w.value);
+    }
+    break;
+  case SAS_LT:
+    if (!na) hi = std::lower_bound(first, last, w.value);
+    break;
+  case SAS_LE:
+    if (!na) hi = std::upper_bound(first, last, w.value);
+    break;
+  case SAS_GT:
+    if (!na) {
+      lo = std::upper_bound(first, last, w.value);
+      hi = last;
+    }
+    break;
+  case SAS_GE:
+    if (!na) {
+      lo = std::lower_bound(first, last, w.value);
+      hi = last;
+    }
+    break;
+  case SAS_ISNA:
+    lo = last;
+    hi = ki.keys.end();
+    break;
+  case SAS_NOTNA:
+    hi = last;
+    break;
+  case SAS_NE:
+    if (na) break;
+    return false;
+  default:
+    return false;
+  }
+
+  out.assign(ki.rows.begin() + (lo - ki.keys.begin()),
+             ki.rows.begin() + (hi - ki.keys.begin()));
+  std::sort(out.begin(), out.end());
+  return true;
+}
+
+// drop rows that can not match a predicate on an indexed column. rows must
+// be sorted.
+inline std::vector<int64_t> sas_index_filter(const SasIndex& idx,
+                                             const std::vector<int64_t>& rows,
+                                             const std::vector<SasPredicate>& where)
+{
+  std::vector<int64_t> out = rows, hit, tmp;
+
+  for (auto& w : where) {
+    const SasKeyIndex* ki = idx.find(w.col);
+    if (!ki || !sas_index_rows(*ki, w, hit)) continue;
+
+    tmp.clear();
+    std::set_intersection(out.begin(), out.end(), hit.begin(), hit.end(),
+                          std::back_inserter(tmp));
+    out.swap(tmp);
+  }
+
+  return out;
+}
+
+
+// index files: magic, a byte order mark, the file the index was built for
+// and the columns with their keys. Same layout rules as zone map files.
+static const char SAS_INDEX_MAGIC[8] = {'S','A','S','I','N','D','X','1'};
+
+inline bool sas_index_write(const std::string& path, const SasIndex& idx)
+{
+  std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!out) return false;
+
+  out.write(SAS_INDEX_MAGIC, sizeof(SAS_INDEX_MAGIC));
+  sas_zm_put(out, (uint32_t)0x01020304);
+  sas_zm_put(out, idx.size);
+  sas_zm_put(out, idx.pagecount);
+  sas_zm_put(out, idx.n);
+  sas_zm_put(out, idx.rowlength);
+  sas_zm_put(out, idx.created);
+  sas_zm_put(out, idx.modified);
+
+  sas_zm_put(out, (uint64_t)idx.keys.size());
+  for (auto& ki : idx.keys) {
+    sas_zm_put(out, ki.col);
+    sas_zm_put(out, ki.nulls);
+    sas_zm_put(out, ki.keys);
+    sas_zm_put(out, ki.rows);
+  }
+
+  out.flush();
+  return (bool)out;
+}
+
+// false if the file is missing, damaged or was built for another file
+inline bool sas_index_read(const std::string& path, const SasFile& f,
+                           SasIndex& idx)
+{
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in) return false;
+
+  char magic[8];
+  uint32_t bom = 0;
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, SAS_INDEX_MAGIC, sizeof(magic)) != 0 ||
+      !sas_zm_get(in, bom) || bom != 0x01020304)
+    return false;
+
+  SasIndex x;
+  uint64_t nk = 0, kk = f.vartyps.size(), max = f.n;
+  bool ok = sas_zm_get(in, x.size) && sas_zm_get(in, x.pagecount) &&
+    sas_zm_get(in, x.n) && sas_zm_get(in, x.rowlength) &&
+    sas_zm_get(in, x.created) && sas_zm_get(in, x.modified) &&
+    sas_zm_get(in, nk) && nk <= kk;
+  if (!ok || !sas_index_valid(x, f)) return false;
+
+  x.keys.resize(nk);
+  for (auto& ki : x.keys) {
+    if (!sas_zm_get(in, ki.col) || !sas_zm_get(in, ki.nulls) ||
+        !sas_zm_get(in, ki.keys, max) || !sas_zm_get(in, ki.rows, max))
+      return false;
+
+    if (ki.col < 0 || (uint64_t)ki.col >= kk || f.vartyps[ki.col] != 1 ||
+        ki.rows.size() != ki.keys.size() || ki.nulls < 0 ||
+        (uint64_t)ki.nulls > ki.keys.size())
+      return false;
+  }
+
+  for (size_t i = 1; i < x.keys.size(); ++i)
+    if (x.keys[i - 1].col >= x.keys[i].col) return false;
+
+  idx = x;
+  return true;
+}
+
+#endif
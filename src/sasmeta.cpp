@@ -0,0 +1,2002 @@
+/*
+ * Copyright (C) 2019, 2022-2023, 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <bitset>
+#include <regex>
+#include <stdint.h>
+#include <string>
+
+#include "sasparse.h"
+
+void readsas_header(std::istream& sas, SasLog& log, SasHeader& h)
+{
+  const bool debug = log.debug != nullptr;
+  std::ostream nullout(nullptr);
+  std::ostream& dbg = debug ? *log.debug : nullout;
+
+  bool swapit = 0;
+  int8_t  unk8  = 0;
+  int8_t ALIGN_1_CHECKER_VALUE = 0;
+  int8_t ALIGN_2_VALUE = 0;
+  int8_t ENDIANNESS = 0;
+  int32_t unk32 = 0;
+  double unkdub = 0;
+
+  int8_t u64 = 0;
+  uint8_t encoding = 0;
+
+  uint32_t pageseqnum32 = 0;
+
+  double created = 0, created2 = 0;   // 8
+  double modified = 0, modified2 = 0; // 16
+
+  std::string enc = "";
+  std::string sasfile  (8, '\0');
+  std::string filetype (8, '\0');
+  std::string sasrel   (8, '\0');
+  std::string sasserv  (16, '\0');
+  std::string osver    (16, '\0');
+  std::string osmaker  (16, '\0');
+  std::string osname   (16, '\0');
+  std::string dataset  (64, '\0');
+
+  // read 2* 4*4 = 32
+  // 0 - 31: Magic Number
+  int32_t mn1 = 0, mn2 = 0, mn3 = 0, mn4 = 0;
+  int32_t mn5 = 0, mn6 = 0, mn7 = 0, mn8 = 0;
+
+  mn1 = readbin(mn1, sas, 0);
+  mn2 = readbin(mn2, sas, 0);
+  mn3 = readbin(mn3, sas, 0);
+  mn4 = readbin(mn4, sas, 0);
+  mn5 = readbin(mn5, sas, 0);
+  mn6 = readbin(mn6, sas, 0);
+  mn7 = readbin(mn7, sas, 0);
+  mn8 = readbin(mn8, sas, 0);
+
+  if (debug)
+    sas_fmt(dbg, "Magicnumber: %d, %d, %d, %d, %d, %d, %d, %d  \n",
+            mn1, mn2, mn3, mn4, mn5, mn6, mn7, mn8);
+
+  if (mn1 != 0)
+    sas_warning(log, "mn1 != 0");
+
+  // the last 20 bytes identify sas7bdat files. Catalogs differ in the fourth
+  // byte, 0x63 instead of 0x60.
+  const unsigned char magic[20] = {
+    0xc2, 0xea, 0x81, 0x60, 0xb3, 0x14, 0x11, 0xcf, 0xbd, 0x92,
+    0x08, 0x00, 0x09, 0xc7, 0x31, 0x8c, 0x18, 0x1f, 0x10, 0x11
+  };
+  int32_t mn[5] = {mn4, mn5, mn6, mn7, mn8};
+  unsigned char* mnb = (unsigned char*)mn;
+  h.catalog = mnb[3] == 0x63;
+  if (h.catalog) mnb[3] = 0x60;
+  if (std::memcmp(mn, magic, sizeof(magic)) != 0)
+    throw SasError(SAS_ERROR_FORMAT, "not a sas7bdat file");
+  // End Magicnumber
+
+  /*
+   * Most likely the following blocks of 4 are handled as fixed values. eg as
+   *  int32 with a specific meaning.
+   *
+   */
+
+  if (debug) dbg << sas.tellg() << std::endl;
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  ALIGN_1_CHECKER_VALUE = readbin(ALIGN_1_CHECKER_VALUE, sas, 0); // 51 or 34
+  if (ALIGN_1_CHECKER_VALUE == 51) u64 = 4;// 51 is b'3'
+  if (debug) sas_fmt(dbg, "ALIGN_1_CHECKER_VALUE: %d \n", ALIGN_1_CHECKER_VALUE);
+
+  unk8 = readbin(unk8, sas, 0);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, 0);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  int8_t U64_BYTE_CHECKER_VALUE = 0;
+  U64_BYTE_CHECKER_VALUE = readbin(U64_BYTE_CHECKER_VALUE, sas, 0);
+  if (U64_BYTE_CHECKER_VALUE == 51) ALIGN_2_VALUE = 4;
+  if (debug) sas_fmt(dbg, "U64_BYTE_CHECKER_VALUE: %d \n", U64_BYTE_CHECKER_VALUE);
+  // end block of 4
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, 0);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  ENDIANNESS = readbin(ENDIANNESS, sas, 0);
+  if (debug) sas_fmt(dbg, "ENDIANNESS: %d \n", ENDIANNESS);
+  if (ENDIANNESS == 0) swapit = 1;
+  // if (ENDIANNESS < 1) sas_stop("Endiannes < 1 found");
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  // (1) 49 Unix (2) 50 Win
+  uint8_t PLATFORM = 0;
+  PLATFORM = readbin(PLATFORM, sas, swapit);
+  if (debug) sas_fmt(dbg, "PLATFORM: %d \n", PLATFORM);
+  // end block of 4
+
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit); // 1|4
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // ?
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 3
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 1
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+
+
+  int8_t U64_BYTE_CHECKER_VALUE2 = 0;
+
+  /* SAS written files repeat the first two blocks here */
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "ALIGN_1_CHECKER_VALUE2 %d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  U64_BYTE_CHECKER_VALUE2 = readbin(U64_BYTE_CHECKER_VALUE2, sas, swapit);
+  if (debug) sas_fmt(dbg, "U64_BYTE_CHECKER_VALUE2 %d\n", U64_BYTE_CHECKER_VALUE2);
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  ENDIANNESS = readbin(ENDIANNESS, sas, swapit);
+  if (debug) sas_fmt(dbg, "ENDIANNESS: %d \n", ENDIANNESS);
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "unk2 %d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit);
+  if (debug) sas_fmt(dbg, "Platform2 %d\n", unk8);
+
+  // o64
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg() << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit); // 4
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 51
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 1
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 35
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit); // interpreted as sas release ?
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // data representation 1 linux ?
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  encoding = readbin(encoding, sas, swapit); // file encoding?
+  if (debug) sas_fmt(dbg, "%d\n", encoding);
+  enc = SASEncoding(encoding);
+  unk8 = readbin(unk8, sas, swapit); // sys encoding?
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+
+
+  if (debug) dbg << " ---- block ---- " << sas.tellg()  << std::endl;
+  /* begin block of 4 ----------------------------------------------------- */
+  unk8 = readbin(unk8, sas, swapit); // 0
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 16 | 32: PAGE_BIT_OFFSET?
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 3
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+  unk8 = readbin(unk8, sas, swapit); // 1
+  if (debug) sas_fmt(dbg, "%d\n", unk8);
+
+
+  // o80
+  unk32 = readbin(unk32, sas, swapit); // 0
+  // sas_fmt(dbg, "%d\n", unk32);
+
+  unk32 = readbin(unk32, sas, swapit); // 0
+  // sas_fmt(dbg, "%d\n", unk32);
+
+
+  // o84 SAS FILE
+  sasfile = readstring(sasfile, sas);
+  if (debug) dbg << sasfile << std::endl;
+
+  // o92 dataset name
+  dataset = readstring(dataset, sas);
+  dataset = std::regex_replace(dataset, std::regex(" +$"), "$1");
+  if (debug) dbg << dataset << std::endl;
+
+  // o156 filetype 'DATA    '
+  filetype = readstring(filetype, sas);
+  filetype = std::regex_replace(filetype, std::regex(" +$"), "$1");
+  if (debug) dbg << filetype << std::endl;
+
+  if (ALIGN_2_VALUE == 4) {
+    unk32 = readbin(unk32, sas, swapit);
+    if (debug) dbg << unk32 << std::endl;
+  }
+
+  created = readbin(created, sas, swapit);
+  if (debug) dbg << created << std::endl;
+
+  modified = readbin(modified, sas, swapit);
+  if (debug) dbg << modified << std::endl;
+
+  created2 = readbin(created2, sas, swapit);
+  if (debug) dbg << created2 << std::endl;
+
+  modified2 = readbin(modified2, sas, swapit);
+  if (debug) dbg << modified2 << std::endl;
+
+  uint32_t headersize = 0;
+  headersize = readbin(headersize, sas, swapit);
+  if (debug) dbg << "headersize: " << headersize << std::endl;
+  if (headersize <= 0) sas_stop("headersize <= 0");
+
+  uint32_t pagesize = 0;
+  pagesize = readbin(pagesize, sas, swapit);
+  if (debug) dbg << "pagesize: " << pagesize << std::endl;
+  if (pagesize <= 0) sas_stop("pagesize <= 0");
+
+  int64_t pagecount = 0;
+  if (u64 == 4) {
+    pagecount = readbin(pagecount, sas, swapit);
+  } else {
+    pagecount = readbin((int32_t)pagecount, sas, swapit);
+  }
+  if (debug)
+    dbg << "pagecount: " << pagecount << std::endl;
+
+
+  unkdub = readbin(unkdub, sas, swapit); // 0
+  if (debug) dbg << unkdub << std::endl;
+
+  sasrel = readstring(sasrel, sas);
+  if (debug) dbg << "SAS release: " << sasrel << std::endl;
+
+  sasserv = readstring(sasserv, sas);
+  if (debug) dbg << "SAS server: " << sasserv << std::endl;
+
+  // osversion
+  osver = readstring(osver, sas);
+  if (debug) dbg << "OS ver: " <<  osver << std::endl;
+
+  // osmaker
+  osmaker = readstring(osmaker, sas);
+  if (debug) dbg << "OS maker: " << osmaker << std::endl; // eg WIN
+
+  // osname
+  osname = readstring(osname, sas); // x86_64
+  if (debug) dbg << "OS name: " << osname << std::endl;
+
+  uint32_t uunk32 = 0;
+
+  // unk
+  uunk32 = readbin(uunk32, sas, swapit);
+  if (debug) dbg << uunk32 << std::endl;
+
+  // three identical unks
+  uunk32 = readbin(uunk32, sas, swapit);
+  if (debug) dbg << uunk32 << std::endl;
+  uunk32 = readbin(uunk32, sas, swapit);
+  if (debug) dbg << uunk32 << std::endl;
+  uunk32 = readbin(uunk32, sas, swapit);
+  if (debug) dbg << uunk32 << std::endl;
+
+  unkdub = readbin(unkdub, sas, swapit); // 0
+  if (debug) dbg << unkdub << std::endl;
+  unkdub = readbin(unkdub, sas, swapit); // 0
+  if (debug) dbg << unkdub << std::endl;
+
+  // dbg << sas.tellg() << std::endl;
+
+  // page seq num at 320|328
+  pageseqnum32 = readbin(pageseqnum32, sas, swapit);
+  if (debug) dbg << "pageseqnum: " << pageseqnum32 << std::endl;
+
+  unk32 = readbin(unk32, sas, swapit); // 0 padding?
+  if (debug) sas_fmt(dbg, "unk32: %d \n", unk32);
+
+  // 3rd timestamp ? 0
+  double thrdts = 0;
+  thrdts = readbin(thrdts, sas, swapit);
+  if (debug) dbg << "3. TS " << thrdts << std::endl;
+
+  // rest is filled with zeros. read it anyway.
+  uint64_t num_zeros = headersize - sas.tellg();
+
+  for (uint64_t i = 0; i < num_zeros; ++i) {
+    int8_t zero = 0;
+    zero = readbin(zero, sas, swapit);
+    if (zero!=0 && debug)
+      sas_warning(log, "debug: expected 0, is %d", zero);
+  }
+
+  // debug
+  int64_t pagestart = sas.tellg();
+  if (debug) dbg << "position: " << pagestart << std::endl;
+
+  h.u64 = u64 == 4;
+  h.pad1 = ALIGN_2_VALUE;
+  h.swapit = swapit;
+  h.enc = enc;
+  h.sasfile = sasfile;
+  h.dataset = dataset;
+  h.filetype = filetype;
+  h.sasrel = sasrel;
+  h.sasserv = sasserv;
+  h.osver = osver;
+  h.osmaker = osmaker;
+  h.osname = osname;
+  h.created = created;
+  h.created2 = created2;
+  h.modified = modified;
+  h.modified2 = modified2;
+  h.thrdts = thrdts;
+  h.headersize = headersize;
+  h.pagesize = pagesize;
+  h.pagecount = pagecount;
+  h.pageseqnum = pageseqnum32;
+}
+
+void readsas_meta(std::istream& sas, SasLog& log, SasFile& f,
+                  int64_t max_rows, int64_t max_pages)
+{
+  const bool debug = log.debug != nullptr;
+  std::ostream nullout(nullptr);
+  std::ostream& dbg = debug ? *log.debug : nullout;
+
+  SasTimer timer(log.profile, SAS_PHASE_HEADER);
+
+  int compr = 0;
+
+  bool hasattributes = 0, hasproc = 1, swapit = 0, c5first = 0;
+  int8_t  unk8  = 0;
+  int16_t unk16 = 0;
+  int32_t unk32 = 0;
+  int64_t unk64 = 0;
+
+  int8_t u64 = 0;
+  int16_t dataoffset = 0;
+  int16_t swlen = 0, proclen = 0, comprlen = 0, textoff = 0, todata = 0,
+    addtextoff = 0, fmtkey = 0, fmtkey2 = 0,
+    fmt32 = 0, fmt322 = 0, ifmt32 = 0, ifmt322 = 0;
+  int16_t PAGE_TYPE = 0, BLOCK_COUNT = 0, SUBHEADER_COUNT = 0;
+
+  uint32_t pageseqnum32 = 0;
+
+  std::string compression = "";
+  std::string compstr = "";
+  std::string proc = "";
+  std::string sw = "";
+
+  std::vector<CN_Poi> cnpois;
+  std::vector<SasRowRef> rowrefs;
+  std::vector<idxofflen> fmt;
+  std::vector<idxofflen> lbl;
+  std::vector<idxofflen> unk;
+  std::vector<int16_t> c8vec;
+
+  std::vector<double> fmt32s;
+  std::vector<double> ifmt32s;
+  std::vector<double> fmtkeys;
+  std::vector<int32_t> vartyps;
+  std::vector<int32_t> colwidth;
+  std::vector<int64_t> coloffset;
+  std::vector<int16_t> page_type;
+  std::vector<int16_t> cnidx;
+  std::vector<int16_t> cnoff;
+  std::vector<int16_t> cnlen;
+  std::vector<int16_t> cnzer;
+
+  std::vector<std::string> labels;
+  std::vector<std::string> formats;
+  std::vector<std::string> varnames; // (k)
+
+  SasHeader h;
+  readsas_header(sas, log, h);
+  if (h.catalog)
+    throw SasError(SAS_ERROR_FORMAT, "not a sas7bdat file but a sas7bcat catalog");
+
+  swapit = h.swapit;
+  if (h.u64) u64 = 4;
+  pageseqnum32 = h.pageseqnum;
+
+  uint32_t headersize = h.headersize;
+  uint32_t pagesize = h.pagesize;
+  int64_t pagecount = h.pagecount;
+
+  uint32_t uunk32 = 0;
+
+  /*
+   * theoretically every page contains data and/or varnames. practically
+   * this must not be true. 1024 does not contain data, only varnames. 512
+   * might contain both or only varnames.
+   */
+
+  std::vector<uint64_t> data_pos(pagecount, 0);
+  std::vector<uint64_t> varname_pos;
+  std::vector<std::string> coltext;
+  std::vector<uint64_t> label_pos;
+  std::vector<int64_t>  rowsperpage(pagecount, 0);
+
+  // end of Header ---------------------------------------------------------//
+
+
+  uint8_t alignval = 8;
+  if (u64 != 4) alignval = 4;
+
+
+  uint64_t rowlength = 0, delobs = 0;
+  int64_t colf_p1 = 0, colf_p2 = 0;
+  int64_t n = 0, k = 0;
+
+  int64_t totalrows = 0;
+  std::vector<int64_t> totalrowsvec(pagecount);
+  std::vector<uint32_t> pageseqnum(pagecount);
+
+  std::vector<std::string> pagedelmarker(pagecount);
+
+  int8_t PAGE_BIT_OFFSET = 0;
+  int8_t SUBHEADER_POINTER_LENGTH = 0;
+  int8_t SUBHEADER_POINTERS_OFFSET = 8;
+
+  if (u64 == 4) {
+    PAGE_BIT_OFFSET = 32;
+    SUBHEADER_POINTER_LENGTH = 24;
+  } else {
+    PAGE_BIT_OFFSET = 16;
+    SUBHEADER_POINTER_LENGTH = 12;
+  }
+
+  uint64_t pre_pagenumx = 0;
+  uint64_t pagenumx = 0;
+
+  timer.stop();
+  SasTimer pagetimer(log.profile, SAS_PHASE_PAGES);
+
+  // pages scanned and deleted rows on them
+  int64_t scanned = pagecount, delrows = 0;
+
+  // begin reading pages ---------------------------------------------------//
+  for (int64_t pg = 0; pg < pagecount; ++pg) {
+    log.check_interrupt();
+
+    // dbg << "--- new page ------------------------------------" << std::endl;
+
+    /* should already be at this position for pg == 1 */
+    if (pagecount > 0) {
+      pre_pagenumx = pagenumx;
+      pagenumx = headersize + (uint64_t)pg * pagesize;
+
+      sas.seekg(pagenumx, sas.beg);
+
+      if (pagenumx <= pre_pagenumx)
+        sas_stop("pagenumx did not increase");
+    }
+
+    int64_t unk1 = 0, unk2 = 0;
+    int32_t c5typ = 0; /* check if variable name, format or label */
+    int64_t PAGE_DELETED_POINTER_LENGTH = 0;
+
+    // Page Offset Table
+    if (u64 == 4) {
+      pageseqnum32 = readbin(pageseqnum32, sas, swapit);
+      unk32 = readbin(unk32, sas, swapit);
+      unk1 = readbin(unk1, sas, swapit);
+      unk2 = readbin(unk2, sas, swapit);
+      PAGE_DELETED_POINTER_LENGTH = readbin(PAGE_DELETED_POINTER_LENGTH, sas, swapit);
+    } else {
+      pageseqnum32 = readbin(pageseqnum32, sas, swapit);
+      unk1 = readbin((int32_t)unk1, sas, swapit);
+      unk2 = readbin((int32_t)unk2, sas, swapit);
+      PAGE_DELETED_POINTER_LENGTH = readbin((int32_t)PAGE_DELETED_POINTER_LENGTH, sas, swapit);
+    }
+
+    pageseqnum[pg] = pageseqnum32;
+
+    PAGE_TYPE       = readbin(PAGE_TYPE, sas, swapit);
+    BLOCK_COUNT     = readbin(BLOCK_COUNT, sas, swapit);
+    SUBHEADER_COUNT = readbin(SUBHEADER_COUNT, sas, swapit);
+    unk16           = readbin(unk16, sas, swapit);
+
+    page_type.push_back(PAGE_TYPE);
+
+    rowsperpage[pg] = BLOCK_COUNT - SUBHEADER_COUNT;
+    if (rowsperpage[pg] < 0) rowsperpage[pg] = 0;
+    totalrows += rowsperpage[pg];
+    totalrowsvec[pg] = totalrows;
+
+    if (debug)
+      sas_fmt(dbg, "PAGE_TYPE: %d ; BC: %d ; SC: %d ; unk16: %d ---- \n",
+              PAGE_TYPE, BLOCK_COUNT, SUBHEADER_COUNT, unk16);
+
+    int16_t zero = 0;
+    // int64_t sh_tot_len = 0;
+    uint64_t dataoff = 0;
+
+    std::vector<PO_Tab> potabs(SUBHEADER_COUNT);
+
+
+    if ((
+        PAGE_TYPE == 16384 ||                   // PAGE_META_TYPE_2
+          PAGE_TYPE == 1024 ||                    // PAGE_AMD_TYPE
+          PAGE_TYPE == 640 || PAGE_TYPE == 512 || // PAGE_MIX_TYPE_2   PAGE_MIX_TYPE_1
+          PAGE_TYPE == 384 || PAGE_TYPE == 256 || // PAGE_DATA_TYPE_2  PAGE_DATA_TYPE
+          PAGE_TYPE == 128 ||                     // PAGE_CMETA_TYPE
+          PAGE_TYPE == 0))                        // PAGE_META_TYPE_1
+    {
+
+      for (auto i = 0; i < SUBHEADER_COUNT; ++i) {
+
+        if (u64 == 4) {
+
+          potabs[i].SH_OFF = readbin(potabs[i].SH_OFF, sas, swapit);           // 8
+          potabs[i].SH_LEN = readbin(potabs[i].SH_LEN, sas, swapit);           // 16
+          potabs[i].COMPRESSION = readbin(potabs[i].COMPRESSION, sas, swapit); // 20
+          potabs[i].SH_TYPE = readbin(potabs[i].SH_TYPE, sas, swapit);         // 24
+
+          zero = readbin(zero, sas, swapit);
+          // dbg << zero << std::endl;
+          zero = readbin(zero, sas, swapit);
+          // dbg << zero << std::endl;
+          zero = readbin(zero, sas, swapit);
+          // dbg << zero << std::endl;
+
+        } else {
+
+          potabs[i].SH_OFF = readbin((uint32_t)potabs[i].SH_OFF, sas, swapit); // 4
+          potabs[i].SH_LEN = readbin((uint32_t)potabs[i].SH_LEN, sas, swapit); // 8
+          potabs[i].COMPRESSION = readbin(potabs[i].COMPRESSION, sas, swapit); // 10
+          potabs[i].SH_TYPE = readbin(potabs[i].SH_TYPE, sas, swapit);         // 12
+
+          zero = readbin(zero, sas, swapit);
+          // dbg << zero << std::endl;
+        }
+
+        if (debug)
+          dbg << "SH_OFF: " << potabs[i].SH_OFF
+                      << "SH_LEN: " << potabs[i].SH_LEN
+                      << "COMPR.: " << potabs[i].COMPRESSION
+                      << "SH_TYPE: " << potabs[i].SH_TYPE << std::endl;
+
+        dataoff = potabs[i].SH_OFF - (uint64_t)rowsperpage[pg] * rowlength;
+
+      }
+
+      if (debug) {
+        dbg << "data offset " << dataoff << std::endl;
+        dbg << "data offset ------------------------------- " << std::endl;
+      }
+
+      uint64_t sh_end_pos = 0;
+
+      if (PAGE_TYPE != 0) sh_end_pos = sas.tellg();
+
+      data_pos[pg] = sh_end_pos;
+
+      if (debug)
+        // sas_fmt(dbg, "sh_end_pos: %d\n", sh_end_pos);
+        dbg << "sh_end_pos: " << sh_end_pos << std::endl;
+
+
+      // from now on, we will seek to every position inside the sas file
+      for (auto sc = 0; sc < SUBHEADER_COUNT; ++sc)
+      {
+
+        if (debug)
+          dbg << "Subheader Count: " << sc << std::endl;
+
+        uint64_t pagepos = headersize + (uint64_t)pg * pagesize + potabs[sc].SH_OFF;
+
+        // 2 files, where this is a problem
+        if(potabs[sc].SH_OFF == 0 || potabs[sc].SH_LEN == 0)
+          break;
+
+        sas.seekg(pagepos, sas.beg);
+
+        // not sure yet, whats the right thing to do here
+        bool page0not = 0;
+        if ((pg == 0) && (sc != 3))
+          page0not = (PAGE_TYPE == 0) &&  (potabs[sc].SH_LEN == rowlength);
+
+        // there can be uncompressed rows in the data
+        if (potabs[sc].COMPRESSION == 0 && potabs[sc].SH_TYPE == 1 && potabs[sc].SH_LEN == rowlength && compr > 0) {
+
+          if (debug)
+            dbg << "-------- case 0 "<< sas.tellg()  << std::endl;
+
+          SasRowRef ref;
+          ref.off = sas.tellg();
+          ref.len = rowlength;
+          rowrefs.push_back(ref);
+          continue;
+        }
+
+        int64_t sas_offset = alignval;
+        if (! ((potabs[sc].COMPRESSION == 4) |
+            (PAGE_TYPE == -28672) | page0not ) ) {
+          if (u64 == 4) {
+            sas_offset = readbin(sas_offset, sas, swapit);
+          } else {
+            sas_offset = readbin((int32_t)sas_offset, sas, swapit);
+          }
+        }
+
+        std::string sas_hex = int_to_hex(sas_offset);
+
+        if (debug)
+          dbg << "SAS Hex: " << sas_hex << std::endl;
+
+        auto sas_offset_table = 0;
+        if (sas_hex.compare("f7f7f7f7") == 0 ||
+            sas_hex.compare("fffffffff7f7f7f7") == 0 ||
+            sas_hex.compare("f7f7f7f700000000") == 0 ||
+            sas_hex.compare("f7f7f7f7fffffbfe") == 0 )
+          sas_offset_table = 1;
+        if (sas_hex.compare("fffffc00") == 0 ||
+            sas_hex.compare("fffffffffffffc00") == 0 )
+          sas_offset_table = 2;
+        if (sas_hex.compare("fffffbfe") == 0 ||
+            sas_hex.compare("fffffffffffffbfe") == 0)
+          sas_offset_table = 3;
+        if (sas_hex.compare("f6f6f6f6") == 0 ||
+            sas_hex.compare("fffffffff6f6f6f6") == 0 ||
+            sas_hex.compare("f6f6f6f600000000") == 0 ||
+            sas_hex.compare("f6f6f6f6fffffbfe") == 0 )
+          sas_offset_table = 4;
+        if (sas_hex.compare("fffffffd") == 0 ||
+            sas_hex.compare("fffffffffffffffd") == 0)
+          sas_offset_table = 5;
+        if (sas_hex.compare("ffffffff") == 0 ||
+            sas_hex.compare("ffffffffffffffff") == 0)
+          sas_offset_table = 6;
+        if (sas_hex.compare("fffffffc") == 0 ||
+            sas_hex.compare("fffffffffffffffc") == 0)
+          sas_offset_table = 7;
+        if (sas_hex.compare("fffffffe") == 0 ||
+            sas_hex.compare("fffffffffffffffe") == 0)
+          sas_offset_table = 8;
+        if (potabs[sc].COMPRESSION == 4)
+          sas_offset_table = 9;
+        if (page0not)
+          sas_offset_table = 10;
+
+
+        switch(sas_offset_table)
+        {
+
+          // new offset --------------------------------------------------- //
+        case 1:
+          {
+
+            /* Row Size */
+
+            int16_t pgwpossh = 0, pgwpossh2 = 0, numzeros = 37,
+              sh_num = 0, cn_maxlen = 0, l_maxlen = 0,
+              rowsonpg = 0;
+            int32_t pgidx = 0;
+            int64_t pgsize = 0, pgc = 0, rcmix = 0, pgwsh = 0, pgwsh2 = 0;
+
+            if (debug)
+              dbg << "-------- case 1 "<< sas.tellg() << std::endl;
+
+
+
+            if (u64 == 4) {
+
+              /* */
+
+
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl;
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl;
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl;
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl;
+
+              rowlength = readbin(rowlength, sas, swapit);
+              if (debug) dbg << "rowlength " << rowlength << std::endl;
+              n = readbin(n, sas, swapit);
+              if (debug) dbg << "n " << n << std::endl;
+              delobs = readbin(delobs, sas, swapit);
+              if (debug) dbg << "delobs " << delobs << std::endl;
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl;
+
+              colf_p1 = readbin(colf_p1, sas, swapit);
+              if (debug) dbg << colf_p1 << std::endl;
+              colf_p2 = readbin(colf_p2, sas, swapit);
+              if (debug) dbg << colf_p2 << std::endl;
+              unk64 = readbin(unk64, sas, swapit); // p3 and p4?
+              if (debug) dbg << unk64 << std::endl;
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl;
+              pgsize = readbin(pgsize, sas, swapit);
+              unk64 = readbin(unk64, sas, swapit);
+              rcmix =  readbin(rcmix, sas, swapit);
+
+              /* next two indicate the end of the initial header ? */
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl; // -1
+              unk64 = readbin(unk64, sas, swapit);
+              if (debug) dbg << unk64 << std::endl; // -1
+
+              for (int z = 0; z < numzeros; ++z) {
+                unk64 = readbin(unk64, sas, swapit);
+                if (unk64 != 0)
+                  sas_warning(log, "val is %d. expected a zero", unk64);
+              }
+
+              pgidx = readbin(pgidx, sas, swapit);
+
+              // padding? 68 bytes: zeros
+              for (int z = 0; z < 8; ++z) {
+                unk64 = readbin(unk64, sas, swapit);
+                if (unk64 != 0)
+                  sas_warning(log, "val0 is %d. expected a zero", unk64);
+              }
+              unk32 = readbin(unk32, sas, swapit);
+
+              unk64 = readbin(unk64, sas, swapit); // val 1?
+              unk16 = readbin(unk16, sas, swapit); // val 2?
+
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+
+              pgwsh = readbin(pgwsh, sas, swapit);
+              pgwpossh = readbin(pgwpossh, sas, swapit);
+
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+
+              pgwsh2 = readbin(pgwsh2, sas, swapit);
+              pgwpossh2 = readbin(pgwpossh2, sas, swapit);
+
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+
+              pgc = readbin(pgc, sas, swapit);
+
+              unk16 = readbin(unk16, sas, swapit); // val ?
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+
+              unk64 = readbin(unk64, sas, swapit); // val 1?
+
+              addtextoff = readbin(addtextoff, sas, swapit); // val 7 | 8?
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+              unk16 = readbin(unk16, sas, swapit); // padding
+
+              for (int z = 0; z < 10; ++z) {
+                unk64 = readbin(unk64, sas, swapit); // 0
+                if (unk64 != 0 && debug)
+                  sas_warning(log, "val1 is %d. expected a zero", unk64);
+              }
+
+              if (debug) dbg << "###############" << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // val
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 0|8 ?
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 4
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 0
+              if (debug) dbg << unk16 << std::endl;
+              todata = readbin(unk16, sas, swapit); // val 12,32|0?
+              if (debug) dbg << todata << std::endl;
+
+              if (todata == 12)
+                hasproc = false;
+
+              if (debug) dbg << "###############" << std::endl;
+
+              swlen = readbin(swlen, sas, swapit);
+              if (debug) dbg << swlen << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 0
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 20 | 28
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 8
+              if (debug) dbg << unk16 << std::endl;
+
+              if (debug) dbg << "###############" << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // 0
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 12
+              if (debug) dbg << unk16 << std::endl;
+              comprlen = readbin(unk16, sas, swapit); // 8
+              if (debug) dbg << comprlen << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 0
+              if (debug) dbg << unk16 << std::endl;
+
+              if (debug) dbg << "###############" << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // 12 | 20
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 8
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 0
+              if (debug) dbg << unk16 << std::endl;
+              textoff = readbin(textoff, sas, swapit); // 28 | 36
+              if (debug) dbg << textoff << std::endl;
+              proclen = readbin(proclen, sas, swapit);
+              if (debug) dbg << "proclen " << proclen << std::endl;
+
+              if (debug) dbg << "###############" << std::endl;
+
+              for (int z = 0; z < 8; ++z) {
+                unk32 = readbin(unk32, sas, swapit); // 0
+                if (unk64 != 0)
+                  sas_warning(log, "val2 is %d. expected a zero", unk64);
+              }
+
+              unk16 = readbin(unk16, sas, swapit); // 4
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 1
+              if (debug) dbg << unk16 << std::endl;
+
+              sh_num = readbin(sh_num, sas, swapit);
+              if (debug) dbg << sh_num << std::endl;
+              cn_maxlen = readbin(cn_maxlen, sas, swapit);
+              if (debug) dbg << cn_maxlen << std::endl;
+              l_maxlen = readbin(l_maxlen, sas, swapit);
+              if (debug) dbg << l_maxlen << std::endl;
+
+              /* maybe SAS version information at o131018 ? */
+              unk32 = readbin(unk32, sas, swapit); // 1
+              // dbg << "1 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 2
+              // if (unk32 != 0) sas_stop("unk32 1. expected 0 is %d", unk32);
+              unk32 = readbin(unk32, sas, swapit); // 3
+              // if (unk32 != 0) sas_stop("unk32 1. expected 0 is %d", unk32);
+
+              rowsonpg = readbin(rowsonpg, sas, swapit);
+
+
+              unk16 = readbin(unk16, sas, swapit); // 1
+              if (unk16 != 0) sas_stop("unk16 01. expected 0 is %d", unk16);
+              unk32 = readbin(unk32, sas, swapit); // 2
+              // dbg << "2 " << unk32 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 4
+              if (unk16 != 0) sas_stop("unk16 04. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 5
+              if (unk16 != 0) sas_stop("unk16 05. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 6
+              if (unk16 != 0) sas_stop("unk16 06. expected 0 is %d", unk16);
+              unk32 = readbin(unk32, sas, swapit); // 7
+              // dbg << "7 " << unk32 << std::endl; // nrows
+              unk16 = readbin(unk16, sas, swapit); // 9
+              if (unk16 != 0) sas_stop("unk16 09. expected 0 is %d", unk16);
+              unk32 = readbin(unk32, sas, swapit); // 10
+              // dbg << "10 "<< unk32 << std::endl; // delobs
+              unk16 = readbin(unk16, sas, swapit); // 12
+              if (unk16 != 0) sas_stop("unk16 12. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 13
+              if (unk16 != 0) sas_stop("unk16 13. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 14
+              if (unk16 != 0) sas_stop("unk16 14. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 15
+              if (unk16 != 0) sas_stop("unk16 15. expected 0 is %d", unk16);
+              dataoffset = readbin(dataoffset, sas, swapit); // 16
+              // dbg << dataoffset << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 17
+              if (unk16 != 0) sas_stop("unk16 17. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit);// 18
+              if (unk16 != 0) sas_stop("unk16 18. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 19
+              if (unk16 != 0) sas_stop("unk16 19. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 20
+              if (unk16 != 0) sas_stop("unk16 20. expected 0 is %d", unk16);
+
+
+              /* */
+
+            } else {
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+
+              rowlength = readbin((int32_t)rowlength, sas, swapit);
+              if (debug) dbg << "rowlength " << rowlength << std::endl;
+              n = readbin((int32_t)n, sas, swapit);
+              if (debug) dbg << "rowcount " << n << std::endl;
+              delobs = readbin((int32_t)delobs, sas, swapit); // deleted obs?
+              if (debug) dbg << "delobs " << delobs << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              colf_p1 = readbin((int32_t)colf_p1, sas, swapit);
+              if (debug) dbg << "colfp1 " << colf_p1 << std::endl;
+              colf_p2 = readbin((int32_t)colf_p2, sas, swapit);
+              if (debug) dbg << "colfp2 " << colf_p2 << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              pgsize = readbin((int32_t)pgsize, sas, swapit);
+              if (debug) dbg << "pgsize " << pgsize << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              rcmix =  readbin((int32_t)rcmix, sas, swapit);
+              if (debug) dbg << "rcmix " << rcmix << std::endl;
+              uunk32 = readbin(uunk32, sas, swapit);
+              if (debug) dbg << uunk32 << std::endl;
+              uunk32 = readbin(uunk32, sas, swapit);
+              if (debug) dbg << uunk32 << std::endl;
+
+              for (int z = 0; z < numzeros; ++z) {
+                unk64 = readbin((int32_t)unk64, sas, swapit);
+                if (unk64 != 0 && debug)
+                  sas_warning(log, "val1 is %d. expected a zero", unk64);
+              }
+
+              pgidx = readbin(pgidx, sas, swapit);
+
+
+              for (int z = 0; z < 8; ++z) {
+                unk64 = readbin((int32_t)unk64, sas, swapit);
+                if (debug) dbg << unk64 << std::endl;
+              }
+
+              // padding?
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              if (debug) dbg << unk32 << std::endl;
+
+              unk32 = readbin(unk32, sas, swapit); // val 1?
+              if (debug) dbg << unk32 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 2?
+              if (debug) dbg << unk16 << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // padding
+              if (debug) dbg << unk16 << std::endl;
+
+              pgwsh = readbin((int32_t)pgwsh, sas, swapit);
+              if (debug) dbg << "pgwsh " << pgwsh << std::endl;
+              pgwpossh = readbin(pgwpossh, sas, swapit);
+              if (debug) dbg << "pgwpossh " << pgwpossh << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // padding
+              if (debug) dbg << unk16 << std::endl;
+
+              pgwsh2 = readbin((int32_t)pgwsh2, sas, swapit);
+              if (debug) dbg << "pgwsh2 " << pgwsh2 << std::endl;
+              pgwpossh2 = readbin(pgwpossh2, sas, swapit);
+              if (debug) dbg << "pgwpossh2 " << pgwpossh2 << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // padding
+              if (debug) dbg << unk16 << std::endl;
+
+              pgc = readbin((int32_t)pgc, sas, swapit);
+              if (debug) dbg << "pgc " << pgc << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // val ?
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // padding
+
+              unk64 = readbin((int32_t)unk64, sas, swapit); // val 1?
+              if (debug) dbg << unk64 << std::endl;
+
+              addtextoff = readbin(addtextoff, sas, swapit); // val 7 | 8?
+              if (debug) dbg << addtextoff << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // padding
+
+              for (int z = 0; z < 10; ++z) {
+                unk64 = readbin((int32_t)unk64, sas, swapit); // 0
+                if (unk64 != 0)
+                  sas_warning(log, "val2 is %d. expected a zero", unk64);
+              }
+
+              if (debug) dbg << "###############" << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // val
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 0|8 ?
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 4
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 0
+              if (debug) dbg << unk16 << std::endl;
+              todata = readbin(todata, sas, swapit); // val 12,32|0? //
+              if (debug) dbg << todata << std::endl;
+
+              if (todata == 12)
+                hasproc = false;
+
+              if (debug) dbg << "###############" << std::endl;
+
+              swlen = readbin(swlen, sas, swapit);
+              if (debug) dbg << "swlen " << swlen << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 0?
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // val 20?
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); //
+              if (debug) dbg << unk16 << std::endl;
+
+              if (debug) dbg << "###############" << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // 0
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 12
+              if (debug) dbg << unk16 << std::endl;
+              comprlen = readbin(unk16, sas, swapit); // 8 compr. code length?
+              if (debug) dbg << comprlen << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 0
+              if (debug) dbg << unk16 << std::endl;
+
+              if (debug) dbg << "###############" << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // 12
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 8
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 0
+              if (debug) dbg << unk16 << std::endl;
+              textoff = readbin(textoff, sas, swapit); // 28
+              if (debug) dbg << textoff << std::endl;
+              proclen = readbin(proclen, sas, swapit);
+              if (debug) dbg << "proclen " << proclen << std::endl;
+
+              if (debug) dbg << "###############" << std::endl;
+
+
+              unk32 = readbin(unk32, sas, swapit); // 1
+              // dbg << "1 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 2
+              // dbg << "2 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 3
+              // dbg << "3 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 4
+              // dbg << "4 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 5
+              // dbg << "5 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 6
+              // dbg << "6 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 7
+              // dbg << "7 " << unk32 << std::endl;
+              unk32 = readbin(unk32, sas, swapit); // 8
+              // dbg << "8 " << unk32 << std::endl;
+
+              unk16 = readbin(unk16, sas, swapit); // 4
+              if (debug) dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 1
+              if (debug) dbg << unk16 << std::endl;
+
+              sh_num = readbin(sh_num, sas, swapit);
+              if (debug) dbg << sh_num << std::endl;
+              cn_maxlen = readbin(cn_maxlen, sas, swapit);
+              if (debug) dbg << cn_maxlen << std::endl;
+              l_maxlen = readbin(l_maxlen, sas, swapit);
+              if (debug) dbg << l_maxlen << std::endl;
+
+              for (int z = 0; z < 3; ++z) {
+                unk32 = readbin(unk32, sas, swapit); // 0
+              }
+
+              rowsonpg = readbin(rowsonpg, sas, swapit);
+
+
+              unk16 = readbin(unk16, sas, swapit); // 1
+              if (unk16 != 0) sas_stop("unk16 01. expected 0 is %d", unk16);
+              unk32 = readbin(unk32, sas, swapit); // 2
+              // dbg << "2 " << unk32 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 4
+              if (unk16 != 0) sas_stop("unk16 04. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 5
+              if (unk16 != 0) sas_stop("unk16 05. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 6
+              if (unk16 != 0) sas_stop("unk16 06. expected 0 is %d", unk16);
+              unk32 = readbin(unk32, sas, swapit); // 7
+              // dbg << "7 " << unk32 << std::endl; // nrows
+              unk16 = readbin(unk16, sas, swapit); // 9
+              if (unk16 != 0) sas_stop("unk16 09. expected 0 is %d", unk16);
+              unk64 = readbin((int32_t)unk64, sas, swapit); // 10
+              if (debug) dbg << "delobs "<< unk64 << std::endl; // delobs?
+              // if (unk16 != 0) sas_stop("unk16 11. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 12
+              if (unk16 != 0) sas_stop("unk16 12. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 13
+              if (unk16 != 0) sas_stop("unk16 13. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 14
+              if (unk16 != 0) sas_stop("unk16 14. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 15
+              if (unk16 != 0) sas_stop("unk16 15. expected 0 is %d", unk16);
+              dataoffset = readbin(dataoffset, sas, swapit); // 16
+              // dbg << dataoffset << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 17
+              if (unk16 != 0) sas_stop("unk16 17. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit);// 18
+              if (unk16 != 0) sas_stop("unk16 18. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 19
+              if (unk16 != 0) sas_stop("unk16 19. expected 0 is %d", unk16);
+              unk16 = readbin(unk16, sas, swapit); // 20
+              if (unk16 != 0) sas_stop("unk16 20. expected 0 is %d", unk16);
+            }
+
+            if (debug)
+              sas_fmt(dbg, "swlen = %d, todata %d, textoff %d\n",
+                      swlen, todata, textoff);
+
+
+            if (!((dataoffset == 1) ||(dataoffset == 256) || (dataoffset == 1280)))
+              sas_warning(log, "debug: dataoffset is unexpectedly %d\n",
+                      dataoffset);
+
+            break;
+          }
+
+
+
+          // new offset --------------------------------------------------- //
+        case 2:
+          {
+
+            if (debug)
+              dbg << "-------- case 2 "<< sas.tellg() << std::endl;
+
+            int64_t off = 0;
+
+            if (u64 == 4) {
+              off = readbin(off, sas, swapit);
+              // dbg << off << std::endl;
+              unk64 = readbin(unk64, sas, swapit);
+              // dbg << unk64 << std::endl;
+            } else {
+              off = readbin((int32_t)off, sas, swapit);
+              // dbg << off << std::endl;
+              unk32 = readbin(unk32, sas, swapit);
+              // dbg << unk32 << std::endl;
+            }
+
+            int16_t num_nonzero = 0;
+            num_nonzero = readbin(num_nonzero, sas, swapit);
+            // dbg << "numzeros " <<  num_nonzero << std::endl;
+
+            int8_t unklen = 94; // should be 94
+            if (u64 != 4) unklen = 50;
+            for (int jj = 0; jj < unklen/2; ++jj) {
+              unk16 = readbin(unk16, sas, swapit);
+              // 4th from the end is 1804 meaning is unknown
+            }
+
+            std::vector<SCV> scv(12);
+
+            for (int8_t i = 0; i < 12; ++i) {
+
+              if (u64 == 4) {
+                scv[i].SIG = readbin(scv[i].SIG, sas, swapit);
+                scv[i].FIRST = readbin(scv[i].FIRST, sas, swapit);
+                scv[i].F_POS = readbin(scv[i].F_POS, sas, swapit);
+
+                if ((i == 0) && (scv[i].SIG != -4))
+                  sas_warning(log, "first SIG is not -4");
+
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+
+                scv[i].LAST = readbin(scv[i].LAST, sas, swapit);
+                scv[i].L_POS = readbin(scv[i].L_POS, sas, swapit);
+
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+
+              } else {
+                scv[i].SIG = readbin((int32_t)scv[i].SIG, sas, swapit);
+                scv[i].FIRST = readbin((int32_t)scv[i].FIRST, sas, swapit);
+                scv[i].F_POS = readbin(scv[i].F_POS, sas, swapit);
+
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+
+                scv[i].LAST = readbin((int32_t)scv[i].LAST, sas, swapit);
+                scv[i].L_POS = readbin(scv[i].L_POS, sas, swapit);
+
+                unk16 = readbin(unk16, sas, swapit);
+                // dbg << unk16 << std::endl;
+              }
+
+              if (debug)
+                dbg << "Sig: " << scv[i].SIG
+                            << "FIRST " << scv[i].FIRST
+                            << "F_POS " << scv[i].F_POS
+                            << "LAST " << scv[i].LAST
+                            << "L_POS " << scv[i].L_POS
+                            << std::endl;
+
+            }
+
+            break;
+          }
+
+
+          // new offset --------------------------------------------------- //
+        case 3:
+          {
+
+            if (debug)
+              dbg << "-------- case 3 "<< sas.tellg() << std::endl;
+
+            hasattributes = 1;
+
+            unk16 = readbin(unk16, sas, swapit);           // 1
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 2
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 3
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 4
+            // dbg << unk16 << std::endl;
+            fmt32 = readbin(fmt32, sas, swapit);           // 5
+            // dbg << fmt32 << std::endl;
+            fmt322 = readbin(fmt322, sas, swapit);         // 6
+            // dbg << fmt322 << std::endl;
+            ifmt32 = readbin(ifmt32, sas, swapit);         // 7
+            // dbg << ifmt32 << std::endl;
+            ifmt322 = readbin(ifmt322, sas, swapit);       // 8
+            // dbg << ifmt322 << std::endl;
+            fmtkey = readbin(fmtkey, sas, swapit);         // 9
+            // dbg << fmtkey << std::endl;
+            fmtkey2 = readbin(fmtkey2, sas, swapit);       // 10
+            // dbg << fmtkey2 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 11
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 12
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 13
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 14 off + len
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit);           // 15 1 w char
+            // dbg << unk16 << std::endl;
+
+            if (u64 == 4) {
+              unk16 = readbin(unk16, sas, swapit);
+              // dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit);
+              // dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit);
+              // dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit);
+              // dbg << unk16 << std::endl;
+            }
+
+            fmt32s.push_back(  fmt32  + (double)fmt322/10);
+            ifmt32s.push_back( ifmt32 + (double)ifmt322/10);
+            fmtkeys.push_back( fmtkey + (double)fmtkey2/10);
+
+            idxofflen fmts, lbls, unks;
+
+            fmts.IDX = readbin(fmts.IDX, sas, swapit);
+            fmts.OFF = readbin(fmts.OFF, sas, swapit);
+            fmts.LEN = readbin(fmts.LEN, sas, swapit);
+
+            if (debug)
+              dbg << fmts.IDX << ", " << fmts.OFF <<
+                ", " << fmts.LEN << std::endl;
+
+            fmt.push_back(fmts);
+
+            lbls.IDX = readbin(lbls.IDX, sas, swapit);
+            lbls.OFF = readbin(lbls.OFF, sas, swapit);
+            lbls.LEN = readbin(lbls.LEN, sas, swapit);
+
+            if (debug)
+              dbg << lbls.IDX << ", " << lbls.OFF <<
+                ", " << lbls.LEN << std::endl;
+
+            lbl.push_back(lbls);
+
+            unks.IDX = readbin(unks.IDX, sas, swapit);
+            unks.OFF = readbin(unks.OFF, sas, swapit);
+            unks.LEN = readbin(unks.LEN, sas, swapit);
+
+
+            unk.push_back(unks);
+
+            if ((unks.IDX != 0) | (unks.OFF != 0) | (unks.LEN != 0)) {
+              sas_warning(log, "case3: unk is not 0 as expected, but %d %d %d\n",
+                      unks.IDX, unks.OFF, unks.LEN);
+            }
+
+            break;
+          }
+
+
+          // new offset --------------------------------------------------- //
+        case 4:
+          {
+            /* Column Size */
+
+            if (debug)
+              dbg << "-------- case 4 "<< sas.tellg() << std::endl;
+
+            uint64_t uunk64 = 0;
+
+            if (u64 == 4) {
+              k = readbin(k, sas, swapit);
+              uunk64 = readbin(uunk64, sas, swapit);
+            } else {
+              k = readbin((int32_t)k, sas, swapit);
+              uunk64 = readbin((int32_t)uunk64, sas, swapit);
+            }
+
+            if (debug)
+              dbg << "k " << k << "; uunk64 " << uunk64 << std::endl;
+
+            break;
+          }
+
+          // new offset --------------------------------------------------- //
+
+        case 5:
+          {
+            /* Column Text */
+
+            if (debug)
+              dbg << "-------- case 5 "<< sas.tellg() << std::endl;
+
+            int16_t len = 0;
+
+            varname_pos.push_back( sas.tellg() );
+
+            // keep the whole subheader, names, formats and labels are
+            // sliced from it once all pointers are known
+            {
+              uint64_t txtlen = std::min<uint64_t>(potabs[sc].SH_LEN, pagesize);
+              std::string txt(txtlen, '\0');
+              if (!sas.read(&txt[0], txtlen)) {
+                sas.clear();
+                txt.resize(sas.gcount());
+              }
+              coltext.push_back(std::move(txt));
+              sas.seekg(varname_pos.back(), sas.beg);
+            }
+
+            len = readbin(len, sas, swapit);
+            // dbg << len << std::endl;
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+
+            if ((PAGE_TYPE != 1024) && (c5first == 0)) {
+              unk16 = readbin(unk16, sas, swapit); // 0 |     0 | 27977
+              // dbg << unk16 << std::endl;
+              unk16 = readbin(unk16, sas, swapit); // 0 | 15872 | 30064
+              // dbg << unk16 << std::endl;
+            }
+
+            if ((c5typ == 0) && (pg == 0)) {
+
+              uint64_t pos_beg = sas.tellg();
+              int8_t tmp = 16; // always 16?
+              if (!hasproc) tmp = 0;
+
+              if (debug)
+                dbg << comprlen << ", "
+                            << tmp << ", "
+                            << proclen << ", "
+                            << swlen << "; "
+                            << varname_pos[0]
+                            << std::endl;
+
+              uint64_t txtpos = varname_pos[0] + 12;
+
+              sas.seekg(txtpos, sas.beg);
+
+              // compression
+              if (comprlen > 0) {
+                compression.resize(comprlen, '\0');
+                compression = readstring(compression, sas);
+
+                if (compression.compare("SASYZCRL") == 0)
+                  compr = 1;
+
+                if (compression.compare("SASYZCR2") == 0)
+                  compr = 2;
+                // dbg << compression << std::endl;
+              }
+
+              // 16 whitespaces
+              std::string empty (tmp, '\0');
+              if (tmp > 0) {
+                empty = readstring(empty, sas);
+                if (!(empty.compare("                ") == 0))
+                  sas_warning(log, "non empty 'empty' string found %s \n",
+                          empty);
+              }
+
+              // proc that created the file
+              if (proclen > 0) {
+                proc.resize(proclen, '\0');
+                proc = readstring(proc, sas);
+              }
+
+              // additional software string
+              if (swlen > 0) {
+                sw.resize(swlen, '\0');
+                sw = readstring(sw, sas);
+              }
+
+
+              if (debug)
+                dbg << "here we go!\n" <<
+                  compression << "\n" <<
+                    empty << "\n" <<
+                      proc << "\n" <<
+                        sw << std::endl;
+
+              sas.seekg(pos_beg, sas.beg);
+            }
+
+            if (debug)
+              dbg << "SH_LEN " << potabs[sc].SH_LEN
+                          << "; len " << len << std::endl;
+
+            ++c5typ;
+
+            break;
+          }
+
+
+          // new offset --------------------------------------------------- //
+        case 6:
+          {
+            /* Column Name */
+
+            if (debug)
+              dbg << "-------- case 6 "<< sas.tellg() << std::endl;
+
+
+            int16_t lenremain = 0;
+
+            lenremain = readbin(lenremain, sas, swapit);
+            if (debug) sas_fmt(dbg, "lenremain %d \n", lenremain);
+
+            int8_t div = 8;
+            lenremain -= 8;
+
+            auto cmax = lenremain / div;
+
+
+            unk16 = readbin(unk16, sas, swapit); // 0
+            if (unk16 != 0) sas_stop("unk16 1. expected 0 is %d", unk16);
+            unk16 = readbin(unk16, sas, swapit); // 0
+            if (unk16 != 0) sas_stop("unk16 2. expected 0 is %d", unk16);
+            unk16 = readbin(unk16, sas, swapit); // 0
+            if (unk16 != 0) sas_stop("unk16 3. expected 0 is %d", unk16);
+
+            /* Column Name Pointers */
+            CN_Poi cnpoi;
+
+            for (auto cn = 0; cn < cmax; ++cn) {
+
+              cnpoi.CN_IDX    = readbin(cnpoi.CN_IDX, sas, swapit);
+              cnpoi.CN_OFF    = readbin(cnpoi.CN_OFF, sas, swapit);
+              cnpoi.CN_LEN    = readbin(cnpoi.CN_LEN, sas, swapit);
+              cnpoi.zeros     = readbin(cnpoi.zeros,  sas, swapit);
+
+              cnpois.push_back( cnpoi );
+
+              cnidx.push_back( cnpoi.CN_IDX );
+              cnoff.push_back( cnpoi.CN_OFF );
+              cnlen.push_back( cnpoi.CN_LEN );
+              cnzer.push_back( cnpoi.zeros );
+
+              if (debug) {
+                dbg << "CN_IDX " << cnpois[cn].CN_IDX
+                            << "; CN_OFF " << cnpois[cn].CN_OFF
+                            << "; CN_LEN " << cnpois[cn].CN_LEN
+                            << "; zeros " << cnpois[cn].zeros
+                            << "; len " << cn
+                            << std::endl;
+              }
+
+
+            }
+
+            break;
+          }
+
+
+          // new offset --------------------------------------------------- //
+        case 7:
+          {
+            /* Column Attributes */
+
+            if (debug)
+              dbg << "-------- case 7 "<< sas.tellg()  << std::endl;
+
+            int16_t lenremain = 0;
+            lenremain = readbin(lenremain, sas, swapit);
+            if (debug) sas_fmt(dbg, "lenremain %d \n", lenremain);
+
+            // zeros as padding?
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+
+            int8_t divs = 16;
+            if (u64 != 4) divs = 12;
+
+            lenremain -= 8;
+
+            auto cmax = lenremain / divs;
+
+            /* Column Attributes Pointers */
+            std::vector<CN_Att> capois(cmax);
+
+            for (auto i = 0; i < cmax; ++i) {
+
+              if (u64 == 4) {
+                capois[i].CN_OFF     = readbin(capois[i].CN_OFF, sas, swapit);
+              } else {
+                capois[i].CN_OFF     = readbin((int32_t)capois[i].CN_OFF,
+                                               sas, swapit);
+              }
+              capois[i].CN_WID     = readbin(capois[i].CN_WID, sas, swapit);
+              capois[i].NM_FLAG    = readbin(capois[i].NM_FLAG, sas, swapit);
+              capois[i].CN_TYP     = readbin(capois[i].CN_TYP, sas, swapit);
+              capois[i].UNK8       = readbin(capois[i].UNK8, sas, swapit);
+
+
+              if ((capois[i].CN_TYP >= 1) && (capois[i].CN_TYP <= 2) &&
+                  (capois[i].CN_WID >= 0) && // just > ?
+                  ((uint32_t)capois[i].CN_WID <= pagesize)) {
+                if (debug)
+                  dbg << "OFF " << capois[i].CN_OFF
+                              << "; WID: " << capois[i].CN_WID
+                              << "; FLAG " << capois[i].NM_FLAG
+                              << "; TYP " << capois[i].CN_TYP
+                              << "; UNK8 " << capois[i].UNK8
+                              << std::endl;
+
+                coloffset.push_back( capois[i].CN_OFF );
+                colwidth.push_back( capois[i].CN_WID );
+                vartyps.push_back( capois[i].CN_TYP );
+              }
+
+            }
+
+            break;
+          }
+
+        case 8:
+          {
+
+            if (debug)
+              dbg << "-------- case 8 "<< sas.tellg() << std::endl;
+
+            int16_t cls = 0;
+            int64_t lenremain = 0;
+
+            unk32 = readbin(unk32, sas, swapit); // unkown large number
+            // dbg << unk32 << std::endl;
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin(unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+
+            if (u64 == 4) {  // lenremain
+              lenremain = readbin(lenremain, sas, swapit);
+            } else {
+              lenremain = readbin((int32_t)lenremain, sas, swapit);
+            }
+
+            if (debug)
+              dbg << "lenremain "<< lenremain << std::endl; // 92
+
+            unk16 = readbin(unk16, sas, swapit);
+            // dbg << unk16 << std::endl; // number of varnames?
+            cls = readbin(cls, sas, swapit);
+            // dbg << cls << std::endl;   // counter for unk loop below
+            unk16 = readbin(unk16, sas, swapit);
+            // dbg << unk16 << std::endl; // 1
+            unk16 = readbin(unk16, sas, swapit);
+            // dbg << unk16 << std::endl; // number of varnames?
+            unk16 = readbin(unk16, sas, swapit);  // 3233
+            // dbg << unk16 << std::endl; // 0
+            unk16 = readbin(unk16, sas, swapit);  // 3233
+            // dbg << unk16 << std::endl; // 0
+            unk16 = readbin(unk16, sas, swapit);  // 3233
+            // dbg << unk16 << std::endl; // 0
+
+            lenremain -= 14;
+
+            // dbg << lenremain << " " << cls << std::endl;
+
+            for (auto cl = 0; cl < cls; ++cl) {
+              int16_t res = 0;
+              res = readbin(res, sas, swapit);
+              c8vec.push_back(res);
+            }
+
+
+            // dbg << "---------------------------" << std::endl;
+
+            // 8
+            unk16 = readbin((int8_t)unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin((int8_t)unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin((int8_t)unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+            unk16 = readbin((int8_t)unk16, sas, swapit); // 0
+            // dbg << unk16 << std::endl;
+
+            // dbg << "---------------------------" << std::endl;
+
+            break;
+
+          }
+
+        case 9:
+          {
+
+            if (debug)
+              dbg << "-------- case 9 "<< sas.tellg()  << std::endl;
+
+
+            // compressed row, decompressed when the row is read
+            SasRowRef ref;
+            ref.off = sas.tellg();
+            ref.len = potabs[sc].SH_LEN;
+            ref.compr = compr;
+            rowrefs.push_back(ref);
+
+            break;
+          }
+
+        case 10:
+          {
+            if (debug)
+              dbg << "-------- case 10 "<< sas.tellg()  << std::endl;
+
+            if ((potabs[sc].SH_LEN > alignval) &&
+                (potabs[sc].SH_LEN < pagesize) && compr > 0)
+            {
+              // uncompressed row containing data
+              SasRowRef ref;
+              ref.off = sas.tellg();
+              ref.len = potabs[sc].SH_LEN;
+              rowrefs.push_back(ref);
+            }
+
+            break;
+          }
+
+          // not implemented ---------------------------------------------- //
+        default:
+          {
+
+            if (debug) {
+            dbg << "---- unimplemented "<< sas.tellg() << std::endl;
+            dbg << "SAS HEX STRING: "  << sas_hex << std::endl;
+            dbg << "rowlength is " << rowlength << std::endl;
+
+            dbg << "SH_OFF: " << potabs[sc].SH_OFF
+                        << "; SH_LEN: " << potabs[sc].SH_LEN
+                        << "; COMPR.: " << (int32_t)potabs[sc].COMPRESSION
+                        << "; SH_TYPE: " << (int32_t)potabs[sc].SH_TYPE
+                        << std::endl;
+
+          }
+
+            // some subheaders are pointers to positions inside the file.
+            // their use for SAS is unknown and they are not required for R.
+            // if SC_LEN == alignval it is just padding?
+            if ((potabs[sc].SH_LEN > alignval) &&
+                (potabs[sc].SH_LEN < pagesize) &&
+                (potabs[sc].COMPRESSION != 4) )
+            {
+              auto unklen = potabs[sc].SH_LEN;
+              std::string unkstr(unklen, '\0');
+            }
+
+            break;
+          }
+
+        }
+      }
+
+
+
+      /*
+       * The code to detect removed rows is based on the parso library
+       * Licensed under the Apache License, Version 2.0. Copyright 2015 EPAM
+       *
+       */
+
+      // check for deleted rows
+      if (PAGE_TYPE == 384 || PAGE_TYPE == 640 || PAGE_TYPE == 1024) {
+
+        uint64_t start_pos = sas.tellg();
+
+        // TODO this calculation should be replaced with alignval assignment
+        auto alignCorrection = (
+          (PAGE_BIT_OFFSET + 8) +
+            SUBHEADER_POINTERS_OFFSET +
+            (int64_t)SUBHEADER_COUNT * SUBHEADER_POINTER_LENGTH
+        ) % 8;
+
+        if (debug)
+          dbg << "alignCorrection: " << alignCorrection << std::endl;
+
+        uint64_t deletedMapOffset = (PAGE_BIT_OFFSET + 8) +
+          PAGE_DELETED_POINTER_LENGTH +
+          alignCorrection + // alignval?
+          ((uint64_t)SUBHEADER_COUNT * SUBHEADER_POINTER_LENGTH) +
+          ((uint64_t)rowsperpage[pg] * rowlength);
+
+        uint64_t dmo_pos = headersize + (uint64_t)pg * pagesize + deletedMapOffset;
+
+        if (debug) {
+          dbg << "SUBHEADER_COUNT " << SUBHEADER_COUNT << std::endl;
+          dbg << "rowlength " << rowlength << std::endl;
+          dbg << "dMO " << deletedMapOffset << std::endl;
+          dbg << "read from: " << dmo_pos << std::endl;
+        }
+
+        sas.seekg(dmo_pos, sas.beg);
+
+
+        // every byte contains information for 8 rows
+        int64_t dm_len = (rowsperpage[pg] + 7) / 8;
+        if (debug) dbg << "dm_len: " << dm_len << std::endl;
+
+        std::string delmarker = "";
+        for (int64_t dm = 0; dm < dm_len; ++dm) {
+          unk8 = readbin(unk8, sas, swapit);
+          if (debug) sas_fmt(dbg, "unk8: %d\n", unk8);
+
+          delmarker += std::bitset<8>(unk8).to_string(); //to binary
+          if (debug) dbg << delmarker << std::endl;
+        }
+
+        pagedelmarker[pg] = delmarker;
+
+        sas.seekg(start_pos, sas.beg);
+
+      }
+
+    }
+
+    // stop early once enough rows or pages were found and the column meta
+    // data is complete
+    if ((max_rows >= 0 || max_pages >= 0) && pg + 1 < pagecount) {
+      const std::string& dm = pagedelmarker[pg];
+      delrows += std::count(dm.begin(),
+                            dm.begin() + std::min<size_t>(dm.size(),
+                                                          rowsperpage[pg]),
+                            '1');
+
+      int64_t found = compr ? (int64_t)rowrefs.size() : totalrows - delrows;
+
+      bool enough = max_rows >= 0 ? found >= max_rows : pg + 1 >= max_pages;
+
+      if (enough && k > 0 && (int64_t)cnpois.size() >= k &&
+          (int64_t)vartyps.size() >= k && (int64_t)fmt.size() >= k) {
+        scanned = pg + 1;
+        if (debug)
+          dbg << "stopped after page " << pg << ": " << found << " rows" <<
+            std::endl;
+        break;
+      }
+    }
+  }
+
+  data_pos.resize(scanned);
+  rowsperpage.resize(scanned);
+  totalrowsvec.resize(scanned);
+  pageseqnum.resize(scanned);
+  pagedelmarker.resize(scanned);
+
+
+  // text of column text subheader idx. Falls back to the file if the text
+  // is not within the subheader.
+  auto text_at = [&](size_t idx, int64_t off, int64_t len) {
+    std::string txt(std::max<int64_t>(len, 0), '\0');
+    const std::string& blob = coltext[idx];
+
+    if (off >= 0 && (uint64_t)(off + txt.size()) <= blob.size()) {
+      txt.assign(blob, off, txt.size());
+    } else {
+      sas.seekg(varname_pos[idx] + off, sas.beg);
+      txt = readstring(txt, sas);
+    }
+    return txt;
+  };
+
+  if (debug)
+    dbg << "varnames ----------------------------" << std::endl;
+
+  for (size_t i = 0; i < cnpois.size(); ++i) {
+
+    if (debug)
+      dbg << "CN_IDX " << cnpois[i].CN_IDX
+                  << "; CN_OFF " << cnpois[i].CN_OFF
+                  << "; CN_LEN " << cnpois[i].CN_LEN
+                  << "; zeros " << cnpois[i].zeros
+                  << std::endl;
+
+    if ((size_t)cnpois[i].CN_IDX >= varname_pos.size())
+      sas_stop("varname %d points to a missing column text subheader", i);
+
+    uint64_t vpos = (varname_pos[cnpois[i].CN_IDX] + cnpois[i].CN_OFF);
+    std::string varname = text_at(cnpois[i].CN_IDX, cnpois[i].CN_OFF,
+                                  cnpois[i].CN_LEN);
+
+    varnames.push_back(varname);
+
+    if (debug)
+      dbg << i << " : " << vpos << " : " << varname << std::endl;
+
+  }
+
+  if (hasattributes) {
+
+    for (auto i = 0; i < k; ++i) {
+
+      /* read formats and labels */
+      std::string format = "";
+      if ((size_t)i < fmt.size() && fmt[i].LEN > 0) {
+        if ((size_t)fmt[i].IDX >= varname_pos.size())
+          sas_stop("format %d points to a missing column text subheader", i);
+        format = text_at(fmt[i].IDX, fmt[i].OFF, fmt[i].LEN);
+      }
+
+      std:: string label = "";
+      if ((size_t)i < lbl.size() && lbl[i].LEN > 0) {
+        if ((size_t)lbl[i].IDX >= varname_pos.size())
+          sas_stop("label %d points to a missing column text subheader", i);
+        label = text_at(lbl[i].IDX, lbl[i].OFF, lbl[i].LEN);
+      }
+
+      if (debug)
+        dbg << format << " : " << label << std::endl;
+
+      formats.push_back( format );
+      labels.push_back( label );
+    }
+  }
+
+  f.sasfile = h.sasfile;
+  f.dataset = h.dataset;
+  f.filetype = h.filetype;
+  f.sasrel = h.sasrel;
+  f.sasserv = h.sasserv;
+  f.osver = h.osver;
+  f.osmaker = h.osmaker;
+  f.osname = h.osname;
+  f.compression = compression;
+  f.proc = proc;
+  f.sw = sw;
+  f.enc = h.enc;
+  f.created = h.created;
+  f.created2 = h.created2;
+  f.modified = h.modified;
+  f.modified2 = h.modified2;
+  f.thrdts = h.thrdts;
+  f.headersize = headersize;
+  f.pagesize = pagesize;
+  f.pagecount = pagecount;
+  f.swapit = swapit;
+  f.alignval = alignval;
+  f.dataoffset = dataoffset;
+
+  f.compr = compr;
+  f.rowlength = rowlength;
+  f.delobs = delobs;
+  f.n = n;
+  f.k = k;
+
+  f.varnames = std::move(varnames);
+  f.formats = std::move(formats);
+  f.labels = std::move(labels);
+  f.vartyps = std::move(vartyps);
+  f.colwidth = std::move(colwidth);
+  f.coloffset = std::move(coloffset);
+  f.fmtkeys = std::move(fmtkeys);
+  f.fmt32s = std::move(fmt32s);
+  f.ifmt32s = std::move(ifmt32s);
+  f.c8vec = std::move(c8vec);
+  f.cnidx = std::move(cnidx);
+  f.cnoff = std::move(cnoff);
+  f.cnlen = std::move(cnlen);
+  f.cnzer = std::move(cnzer);
+
+  f.partial = scanned < pagecount;
+  f.pages.resize(scanned);
+  for (int64_t pg = 0; pg < scanned; ++pg) {
+    f.pages[pg].data_pos = data_pos[pg];
+    f.pages[pg].rows = rowsperpage[pg];
+    f.pages[pg].type = page_type[pg];
+    f.pages[pg].seqnum = pageseqnum[pg];
+    f.pages[pg].delmarker = std::move(pagedelmarker[pg]);
+  }
+  f.totalrowsvec = std::move(totalrowsvec);
+  f.rowrefs = std::move(rowrefs);
+}
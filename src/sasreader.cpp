@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sascore.h"
+
+int SasReader::open(const std::string& path)
+{
+  f_ = SasFile();
+  f_.src.path = path;
+  return open_source();
+}
+
+int SasReader::open(const char* data, size_t size)
+{
+  f_ = SasFile();
+  f_.src.data = data;
+  f_.src.size = size;
+  return open_source();
+}
+
+int SasReader::open_source()
+{
+  error_.clear();
+  log_.warnings.clear();
+  in_.reset();
+  cache_.reset();
+  columns_.clear();
+
+  buf_ = f_.src.open();
+  if (!buf_) {
+    error_ = "could not open file";
+    return SAS_ERROR_OPEN;
+  }
+
+  // count bytes and seeks if profiling
+  counter_.reset();
+  if (log_.profile)
+    counter_.reset(new CountingBuf(buf_.get(), log_.profile));
+
+  in_.reset(new std::istream(counter_ ? counter_.get() : buf_.get()));
+
+  return guard([&]() {
+    std::istream& sas = *in_;
+
+    sas.seekg(0, std::ios_base::end);
+    auto sas_size = sas.tellg();
+    if (!sas)
+      throw SasError(SAS_ERROR_OPEN, "could not open file");
+
+    f_.size = sas_size;
+    sas.seekg(0, std::ios_base::beg);
+
+    xport_next_ = 0;
+    if (sas_is_xport(sas))
+      xport_next_ = readsas_xport(sas, log_, f_, xport_member_);
+    else
+      readsas_meta(sas, log_, f_, max_rows_, max_pages_);
+
+    // first column of each name, wide files are looked up in constant time
+    for (size_t i = 0; i < f_.varnames.size() && i < f_.vartyps.size(); ++i)
+      columns_.emplace(f_.varnames[i], i);
+
+    // pages are known now, later reads go through the cache
+    if (page_cache_ > 0 && !f_.src.data) {
+      std::streambuf* src = counter_ ? counter_.get() : buf_.get();
+      cache_.reset(new SasPageCache(src, f_.headersize, f_.pagesize,
+                                    page_cache_));
+      in_.reset(new std::istream(cache_.get()));
+    }
+  });
+}
+
+int64_t SasReader::column(const std::string& name) const
+{
+  auto it = columns_.find(name);
+  return it == columns_.end() ? -1 : it->second;
+}
+
+std::vector<int64_t> SasReader::rows(int64_t start, int64_t count,
+                                     bool skip_deleted) const
+{
+  std::vector<int64_t> rows;
+
+  int64_t end = std::min(f_.n, sas_rows_available(f_));
+  if (start < 0) start = 0;
+  if (count >= 0 && count < end - start) end = start + count;
+
+  for (int64_t r = start; r < end; ++r)
+    if (!skip_deleted || !sas_row_deleted(f_, r)) rows.push_back(r);
+
+  return rows;
+}
+
+void SasReader::check_cols(const std::vector<int64_t>& cols) const
+{
+  for (auto c : cols)
+    if (c < 0 || c >= ncol())
+      throw SasError(SAS_ERROR_ARGUMENT, sas_format("column %d not found", c));
+}
+
+void SasReader::check_where(const std::vector<SasPredicate>& where) const
+{
+  for (auto& w : where) {
+    check_cols(std::vector<int64_t>(1, w.col));
+    if (f_.vartyps[w.col] != 1)
+      throw SasError(SAS_ERROR_ARGUMENT,
+                     sas_format("column %s is not numeric", f_.varnames[w.col]));
+    if (w.op < SAS_EQ || w.op > SAS_NOTNA)
+      throw SasError(SAS_ERROR_ARGUMENT, "invalid comparison");
+  }
+}
+
+int SasReader::select(const std::vector<int64_t>& rows,
+                      const std::vector<SasPredicate>& where,
+                      std::vector<int64_t>& matched)
+{
+  return guard([&]() {
+    check_where(where);
+    SasTimer timer(log_.profile, SAS_PHASE_DECODE);
+    int64_t badrows = sas_select_where(f_, *in_, rows, where, matched,
+                                       log_.profile);
+    timer.stop();
+
+    if (badrows > 0)
+      log_.warn(sas_format("%d rows had an unexpected size after decompression",
+                           badrows));
+  });
+}
+
+int SasReader::zonemap(const std::string& path, SasZoneMap& zm)
+{
+  return guard([&]() {
+    if (f_.partial)
+      throw SasError(SAS_ERROR_ARGUMENT, "zone maps require a full page scan");
+
+    if (!path.empty() && sas_zonemap_read(path, f_, zm)) return;
+
+    int64_t badrows = sas_zonemap_build(f_, *in_, zm, log_.profile);
+    if (badrows > 0)
+      log_.warn(sas_format("%d rows had an unexpected size after decompression",
+                           badrows));
+
+    if (!path.empty() && !sas_zonemap_write(path, zm))
+      log_.warn(sas_format("could not write zone map %s", path));
+  });
+}
+
+int SasReader::sorted_span(int64_t col,
+                           const std::vector<SasPredicate>& where,
+                           int64_t& first, int64_t& last, int64_t& probes)
+{
+  return guard([&]() {
+    check_where(where);
+    check_cols(std::vector<int64_t>(1, col));
+    if (f_.vartyps[col] != 1)
+      throw SasError(SAS_ERROR_ARGUMENT,
+                     sas_format("column %s is not numeric", f_.varnames[col]));
+
+    int64_t badrows = sas_sorted_span(f_, *in_, col, where, first, last,
+                                      probes, log_.profile);
+    if (badrows > 0)
+      log_.warn(sas_format("%d rows had an unexpected size after decompression",
+                           badrows));
+  });
+}
+
+int SasReader::index(const std::string& path,
+                     const std::vector<int64_t>& cols, SasIndex& idx)
+{
+  return guard([&]() {
+    if (f_.partial)
+      throw SasError(SAS_ERROR_ARGUMENT, "indexes require a full page scan");
+    check_cols(cols);
+
+    bool found = !path.empty() && sas_index_read(path, f_, idx);
+
+    size_t have = idx.keys.size();
+    int64_t badrows = sas_index_build(f_, *in_, cols, idx, log_.profile);
+    if (badrows > 0)
+      log_.warn(sas_format("%d rows had an unexpected size after decompression",
+                           badrows));
+
+    if (!path.empty() && (!found || idx.keys.size() != have) &&
+        !sas_index_write(path, idx))
+      log_.warn(sas_format("could not write index %s", path));
+  });
+}
+
+// fills a SasBatch
+struct BatchSink {
+  std::vector<SasColumn>& cols;
+
+  void num(size_t i, size_t j, double val_d) {
+    cols[j].num[i] = val_d;
+  }
+
+  void str(size_t i, size_t j, const char* p, size_t len) {
+    SasColumn& col = cols[j];
+    col.chars.append(p, len);
+    col.offsets[i + 1] = col.chars.size();
+  }
+
+  void missing(size_t i) {
+    for (auto& col : cols) {
+      if (col.numeric)
+        col.num[i] = std::numeric_limits<double>::quiet_NaN();
+      else
+        col.offsets[i + 1] = col.chars.size();
+    }
+  }
+};
+
+int SasReader::read(int64_t start, int64_t count,
+                    const std::vector<int64_t>& cols, bool skip_deleted,
+                    SasBatch& batch)
+{
+  return guard([&]() {
+    std::vector<int64_t> sel = cols;
+    if (sel.empty())
+      for (int64_t i = 0; i < ncol(); ++i) sel.push_back(i);
+    check_cols(sel);
+
+    batch.rows = rows(start, count, skip_deleted);
+    size_t nn = batch.rows.size();
+
+    batch.cols.assign(sel.size(), SasColumn());
+    for (size_t j = 0; j < sel.size(); ++j) {
+      int64_t c = sel[j];
+      SasColumn& col = batch.cols[j];
+
+      col.name = f_.varnames[c];
+      if ((size_t)c < f_.formats.size()) col.format = f_.formats[c];
+      if ((size_t)c < f_.labels.size()) col.label = f_.labels[c];
+      col.numeric = f_.vartyps[c] == 1;
+
+      if (col.numeric)
+        col.num.resize(nn);
+      else
+        col.offsets.assign(nn + 1, 0);
+    }
+
+    BatchSink sink{batch.cols};
+    SasTimer timer(log_.profile, SAS_PHASE_DECODE);
+    int64_t badrows = sas_decode(f_, *in_, batch.rows, sel, sink,
+                                 log_.profile);
+    timer.stop();
+
+    if (badrows > 0)
+      log_.warn(sas_format("%d rows had an unexpected size after decompression",
+                           badrows));
+  });
+}
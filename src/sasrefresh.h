@@ -0,0 +1,163 @@
+#ifndef SASREFRESH_H
+#define SASREFRESH_H
+
+/*
+ * Incremental refresh of files that are appended to. A page map records the
+ * layout of a file when it was read. Compared with the page map of the
+ * current file it yields the rows added since, as long as the header, the
+ * columns and the rows read before are unchanged.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sasfile.h"
+
+struct SasPageMap {
+  uint64_t schema = 0;            // see sas_schema_hash()
+  std::vector<uint32_t> seqnum;
+  std::vector<int16_t> type;
+  std::vector<int64_t> rows;      // rows stored on the page
+  std::vector<std::string> delmarker;
+};
+
+// FNV-1a
+inline void sas_hash(uint64_t& h, const void* p, size_t len)
+{
+  const unsigned char* c = (const unsigned char*)p;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= c[i];
+    h *= 0x100000001b3ULL;
+  }
+}
+
+template <typename T>
+inline void sas_hash(uint64_t& h, const std::vector<T>& v)
+{
+  uint64_t n = v.size();
+  sas_hash(h, &n, sizeof(n));
+  if (n) sas_hash(h, v.data(), n * sizeof(T));
+}
+
+inline void sas_hash(uint64_t& h, const std::vector<std::string>& v)
+{
+  uint64_t n = v.size();
+  sas_hash(h, &n, sizeof(n));
+  for (auto& s : v) {
+    n = s.size();
+    sas_hash(h, &n, sizeof(n));
+    sas_hash(h, s.data(), n);
+  }
+}
+
+// hash of everything that must not change between two reads: the page and
+// row layout, the creation time and the columns. The modification time and
+// the row count change whenever rows are appended and are left out.
+inline uint64_t sas_schema_hash(const SasFile& f)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+
+  sas_hash(h, &f.headersize, sizeof(f.headersize));
+  sas_hash(h, &f.pagesize, sizeof(f.pagesize));
+  sas_hash(h, &f.rowlength, sizeof(f.rowlength));
+  sas_hash(h, &f.compr, sizeof(f.compr));
+  sas_hash(h, &f.swapit, sizeof(f.swapit));
+  sas_hash(h, &f.created, sizeof(f.created));
+  sas_hash(h, &f.created2, sizeof(f.created2));
+  sas_hash(h, f.enc.data(), f.enc.size());
+  sas_hash(h, f.varnames);
+  sas_hash(h, f.formats);
+  sas_hash(h, f.labels);
+  sas_hash(h, f.vartyps);
+  sas_hash(h, f.colwidth);
+  sas_hash(h, f.coloffset);
+
+  return h;
+}
+
+// page map of a fully scanned file
+inline SasPageMap sas_pagemap(const SasFile& f)
+{
+  SasPageMap pm;
+  size_t np = f.pages.size();
+
+  pm.schema = sas_schema_hash(f);
+  pm.seqnum.resize(np);
+  pm.type.resize(np);
+  pm.rows.assign(np, 0);
+  pm.delmarker.resize(np);
+
+  for (size_t pg = 0; pg < np; ++pg) {
+    pm.seqnum[pg] = f.pages[pg].seqnum;
+    pm.type[pg] = f.pages[pg].type;
+    pm.delmarker[pg] = f.pages[pg].delmarker;
+
+    if (f.compr == 0)
+      pm.rows[pg] = f.totalrowsvec[pg] - (pg > 0 ? f.totalrowsvec[pg - 1] : 0);
+  }
+
+  // compressed rows are counted on the page holding their subheader
+  if (f.compr > 0 && f.pagesize > 0) {
+    for (auto& ref : f.rowrefs) {
+      uint64_t pg = (ref.off - f.headersize) / f.pagesize;
+      if (pg < np) ++pm.rows[pg];
+    }
+  }
+
+  return pm;
+}
+
+// rows of the current file added since old was taken, in file order. Pages
+// after the last page holding rows in old may have grown or been added, all
+// other pages must be unchanged. Returns false if a full reload is required.
+inline bool sas_new_rows(const SasPageMap& old, const SasPageMap& cur,
+                         std::vector<int64_t>& rows)
+{
+  rows.clear();
+
+  size_t np = old.rows.size();
+  if (old.schema != cur.schema || cur.rows.size() < np ||
+      old.seqnum.size() != np || old.type.size() != np ||
+      old.delmarker.size() != np)
+    return false;
+
+  size_t last = 0;
+  for (size_t pg = 0; pg < np; ++pg)
+    if (old.rows[pg] > 0) last = pg;
+
+  int64_t start = 0;
+  for (size_t pg = 0; pg < cur.rows.size(); ++pg) {
+
+    int64_t from = 0;
+
+    if (pg < np) {
+      bool same = old.seqnum[pg] == cur.seqnum[pg] &&
+        old.type[pg] == cur.type[pg] && old.rows[pg] == cur.rows[pg] &&
+        old.delmarker[pg] == cur.delmarker[pg];
+
+      if (!same) {
+        // rows read before were neither changed nor deleted
+        const std::string& dm = old.delmarker[pg];
+        size_t k = std::min<size_t>(old.rows[pg], dm.size());
+        bool grown = pg >= last && old.type[pg] == cur.type[pg] &&
+          cur.rows[pg] >= old.rows[pg] && cur.delmarker[pg].size() >= k &&
+          cur.delmarker[pg].compare(0, k, dm, 0, k) == 0;
+
+        if (!grown) return false;
+      }
+
+      from = old.rows[pg];
+    }
+
+    for (int64_t r = from; r < cur.rows[pg]; ++r)
+      rows.push_back(start + r);
+
+    start += cur.rows[pg];
+  }
+
+  return true;
+}
+
+#endif
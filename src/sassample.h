@@ -0,0 +1,153 @@
+#ifndef SASSAMPLE_H
+#define SASSAMPLE_H
+
+/*
+ * Random row samples without a full scan. Row positions are drawn from the
+ * page row counts, only the pages holding sampled rows are read afterwards.
+ * The generator is fixed (splitmix64) so a seed gives the same sample on
+ * every platform.
+ */
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include "sasfilter.h"
+
+struct SasRng {
+  uint64_t state;
+
+  explicit SasRng(uint64_t seed) : state(seed) {}
+
+  uint64_t next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // uniform in [0, bound), without modulo bias
+  uint64_t below(uint64_t bound) {
+    uint64_t limit = -bound % bound;
+    uint64_t x;
+    do {
+      x = next();
+    } while (x < limit);
+    return x % bound;
+  }
+};
+
+// rows per page that are not deleted
+inline std::vector<int64_t> sas_live_rows(const SasFile& f,
+                                          const std::vector<int64_t>& ends,
+                                          bool skip_deleted)
+{
+  std::vector<int64_t> live(ends.size());
+
+  for (size_t z = 0; z < ends.size(); ++z) {
+    int64_t rows = ends[z] - (z > 0 ? ends[z - 1] : 0);
+
+    if (skip_deleted && f.compr == 0) {
+      const std::string& dm = f.pages[z].delmarker;
+      rows -= std::count(dm.begin(), dm.begin() + std::min<size_t>(dm.size(), rows),
+                         '1');
+    }
+
+    live[z] = rows;
+  }
+
+  return live;
+}
+
+// k of the rows of f without replacement, sorted. Positions are drawn with
+// Floyd's algorithm among the rows that are not deleted and mapped to row
+// numbers page by page.
+inline std::vector<int64_t> sas_sample_rows(const SasFile& f, int64_t k,
+                                            uint64_t seed, bool skip_deleted)
+{
+  std::vector<int64_t> ends = sas_zone_ends_clipped(f);
+  std::vector<int64_t> live = sas_live_rows(f, ends, skip_deleted);
+
+  int64_t total = 0;
+  for (auto l : live) total += l;
+  if (k > total) k = total;
+  if (k <= 0) return std::vector<int64_t>();
+
+  SasRng rng(seed);
+  std::unordered_set<int64_t> drawn;
+  drawn.reserve(k);
+
+  for (int64_t j = total - k; j < total; ++j) {
+    int64_t t = rng.below(j + 1);
+    if (!drawn.insert(t).second) drawn.insert(j);
+  }
+
+  std::vector<int64_t> pos(drawn.begin(), drawn.end());
+  std::sort(pos.begin(), pos.end());
+
+  // position among live rows to row number
+  std::vector<int64_t> rows;
+  rows.reserve(pos.size());
+
+  size_t z = 0;
+  int64_t before = 0; // live rows before page z
+  for (auto p : pos) {
+    while (z < live.size() && p >= before + live[z]) before += live[z++];
+    if (z == live.size()) break;
+
+    int64_t start = z > 0 ? ends[z - 1] : 0;
+    int64_t q = p - before;
+
+    if (skip_deleted && f.compr == 0 && !f.pages[z].delmarker.empty()) {
+      for (int64_t r = start; r < ends[z]; ++r) {
+        if (sas_row_deleted(f, r)) continue;
+        if (q-- == 0) {
+          rows.push_back(r);
+          break;
+        }
+      }
+    } else {
+      rows.push_back(start + q);
+    }
+  }
+
+  return rows;
+}
+
+// whole pages in random order until at least k rows are drawn. Returns the
+// rows of the drawn pages in file order. Cheaper than sas_sample_rows(), the
+// rows of a page are read sequentially.
+inline std::vector<int64_t> sas_sample_pages(const SasFile& f, int64_t k,
+                                             uint64_t seed, bool skip_deleted)
+{
+  std::vector<int64_t> ends = sas_zone_ends_clipped(f);
+  std::vector<int64_t> live = sas_live_rows(f, ends, skip_deleted);
+
+  // partial Fisher-Yates shuffle of the pages holding rows
+  std::vector<size_t> order;
+  for (size_t z = 0; z < live.size(); ++z)
+    if (live[z] > 0) order.push_back(z);
+
+  SasRng rng(seed);
+  std::vector<size_t> pick;
+  int64_t got = 0;
+
+  for (size_t i = 0; i < order.size() && got < k; ++i) {
+    size_t j = i + rng.below(order.size() - i);
+    std::swap(order[i], order[j]);
+    pick.push_back(order[i]);
+    got += live[order[i]];
+  }
+
+  std::sort(pick.begin(), pick.end());
+
+  std::vector<int64_t> rows;
+  for (auto z : pick) {
+    for (int64_t r = z > 0 ? ends[z - 1] : 0; r < ends[z]; ++r)
+      if (!skip_deleted || !sas_row_deleted(f, r)) rows.push_back(r);
+  }
+
+  return rows;
+}
+
+#endif
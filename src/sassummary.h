@@ -0,0 +1,305 @@
+#ifndef SASSUMMARY_H
+#define SASSUMMARY_H
+
+/*
+ * Column statistics computed while decoding, nothing is materialized. The
+ * pages of a file are split into ranges, every range is decoded in chunks
+ * by its own thread into fixed size summaries that are merged at the end:
+ * moments with the pairwise update of Chan et al., distinct values with a
+ * HyperLogLog sketch and frequent values with the Misra-Gries summary.
+ * Memory use depends on the number of columns, not on the number of rows.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "sascore.h"
+
+// 2^12 registers, a standard error of about 1.6%
+const int SAS_HLL_BITS = 12;
+
+// counters of the frequent value summary. Values seen more than n/1024 times
+// are always found, counts are exact as long as a column has no more
+// distinct values.
+const size_t SAS_TOP_CAPACITY = 1024;
+
+// rows decoded at once by a thread
+const int64_t SAS_SUMMARY_CHUNK = 65536;
+
+// splitmix64 finalizer
+inline uint64_t sas_mix(uint64_t z)
+{
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+struct SasHll {
+  std::vector<uint8_t> reg;
+
+  SasHll() : reg((size_t)1 << SAS_HLL_BITS, 0) {}
+
+  void add(uint64_t h) {
+    size_t idx = h >> (64 - SAS_HLL_BITS);
+    uint64_t w = h << SAS_HLL_BITS;
+
+    // position of the first set bit of the remaining bits
+    uint8_t rank = 1;
+    while (rank <= 64 - SAS_HLL_BITS && !(w & (1ULL << 63))) {
+      w <<= 1;
+      ++rank;
+    }
+
+    if (rank > reg[idx]) reg[idx] = rank;
+  }
+
+  void merge(const SasHll& o) {
+    for (size_t i = 0; i < reg.size(); ++i)
+      reg[i] = std::max(reg[i], o.reg[i]);
+  }
+
+  double estimate() const {
+    double m = reg.size(), sum = 0;
+    size_t zeros = 0;
+    for (auto r : reg) {
+      sum += std::ldexp(1.0, -r);
+      zeros += r == 0;
+    }
+
+    double e = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+
+    // small cardinalities are counted from the empty registers
+    if (e <= 2.5 * m && zeros > 0)
+      e = m * std::log(m / zeros);
+
+    return e;
+  }
+};
+
+// Misra-Gries summary of the most frequent keys. Counts are lower bounds, the
+// error is at most n / capacity.
+template <typename K>
+struct SasFrequent {
+  std::unordered_map<K, int64_t> counts;
+  bool exact = true; // no counter was reduced, counts holds every key
+
+  void add(const K& key) {
+    auto it = counts.find(key);
+    if (it != counts.end()) {
+      ++it->second;
+    } else if (counts.size() < SAS_TOP_CAPACITY) {
+      counts.emplace(key, 1);
+    } else {
+      // every counter pays for the new key
+      exact = false;
+      for (auto c = counts.begin(); c != counts.end(); ) {
+        if (--c->second == 0)
+          c = counts.erase(c);
+        else
+          ++c;
+      }
+    }
+  }
+
+  // the merged counters are reduced by the count of the first counter that
+  // does not fit
+  void merge(const SasFrequent& o) {
+    for (auto& kv : o.counts) counts[kv.first] += kv.second;
+    exact = exact && o.exact;
+    if (counts.size() <= SAS_TOP_CAPACITY) return;
+
+    exact = false;
+
+    std::vector<int64_t> c;
+    c.reserve(counts.size());
+    for (auto& kv : counts) c.push_back(kv.second);
+    std::nth_element(c.begin(), c.begin() + SAS_TOP_CAPACITY, c.end(),
+                     std::greater<int64_t>());
+    int64_t cut = c[SAS_TOP_CAPACITY];
+
+    for (auto it = counts.begin(); it != counts.end(); ) {
+      it->second -= cut;
+      if (it->second <= 0)
+        it = counts.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  // k most frequent keys, ties in key order
+  std::vector<std::pair<K, int64_t>> top(size_t k) const {
+    std::vector<std::pair<K, int64_t>> v(counts.begin(), counts.end());
+    std::sort(v.begin(), v.end(), [](const std::pair<K, int64_t>& a,
+                                     const std::pair<K, int64_t>& b) {
+      return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if (v.size() > k) v.resize(k);
+    return v;
+  }
+};
+
+// statistics of a column. Missings, including the special missings of SAS,
+// are counted in nmiss, as are empty strings.
+struct SasStats {
+  int64_t n = 0, nmiss = 0;
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  double mean = 0, m2 = 0;
+  SasHll hll;
+  SasFrequent<double> num;
+  SasFrequent<std::string> str;
+
+  void add(double x) {
+    if (std::isnan(x)) {
+      ++nmiss;
+      return;
+    }
+
+    ++n;
+    if (x < min) min = x;
+    if (x > max) max = x;
+
+    double d = x - mean;
+    mean += d / n;
+    m2 += d * (x - mean);
+
+    if (x == 0) x = 0; // -0 is 0
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    hll.add(sas_mix(bits));
+    num.add(x);
+  }
+
+  void add(const char* p, size_t len) {
+    if (len == 0) {
+      ++nmiss;
+      return;
+    }
+
+    ++n;
+
+    // FNV-1a
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+      h ^= (unsigned char)p[i];
+      h *= 0x100000001b3ULL;
+    }
+    hll.add(sas_mix(h));
+    str.add(std::string(p, len));
+  }
+
+  void merge(const SasStats& o) {
+    nmiss += o.nmiss;
+
+    if (o.n > 0) {
+      double n1 = n, n2 = o.n, d = o.mean - mean;
+      mean += d * n2 / (n1 + n2);
+      m2 += o.m2 + d * d * n1 * n2 / (n1 + n2);
+      n += o.n;
+      min = std::min(min, o.min);
+      max = std::max(max, o.max);
+    }
+
+    hll.merge(o.hll);
+    num.merge(o.num);
+    str.merge(o.str);
+  }
+
+  // distinct values, exact for columns with few distinct values
+  double distinct() const {
+    if (num.exact && str.exact) return num.counts.size() + str.counts.size();
+    return std::round(hll.estimate());
+  }
+};
+
+struct SasStatsSink {
+  std::vector<SasStats>& stats;
+
+  explicit SasStatsSink(std::vector<SasStats>& stats) : stats(stats) {}
+
+  void num(size_t, size_t j, double val) { stats[j].add(val); }
+  void str(size_t, size_t j, const char* p, size_t len) {
+    stats[j].add(p, len);
+  }
+  void missing(size_t) {
+    for (auto& s : stats) ++s.nmiss;
+  }
+};
+
+// statistics of cols of f. The pages are split into nthreads ranges, each
+// decoded by a thread with its own stream. Returns the number of rows with an
+// unexpected size after decompression. Throws SasError.
+inline int64_t sas_summary(const SasFile& f, const std::vector<int64_t>& cols,
+                           bool skip_deleted, int nthreads,
+                           std::vector<SasStats>& stats)
+{
+  int64_t badrows = 0;
+
+  // rows read.sas() returns
+  std::vector<int64_t> ends = sas_zone_ends_clipped(f);
+  size_t nz = ends.size();
+  size_t nt = std::max(nthreads, 1);
+  nt = std::min(nt, std::max<size_t>(nz, 1));
+
+  std::vector<std::vector<SasStats>> part(nt,
+                                          std::vector<SasStats>(cols.size()));
+  std::vector<int64_t> bad(nt, 0);
+  std::vector<std::string> errors(nt);
+
+  auto work = [&](size_t t) {
+    try {
+      size_t z0 = nz * t / nt, z1 = nz * (t + 1) / nt;
+      int64_t r0 = z0 > 0 ? ends[z0 - 1] : 0;
+      int64_t r1 = z1 > 0 ? ends[z1 - 1] : 0;
+
+      std::unique_ptr<std::streambuf> buf = f.src.open();
+      if (!buf) throw SasError(SAS_ERROR_OPEN, "could not open file");
+      std::istream sas(buf.get());
+
+      SasStatsSink sink(part[t]);
+      std::vector<int64_t> rows;
+
+      for (int64_t start = r0; start < r1; start += SAS_SUMMARY_CHUNK) {
+        int64_t end = std::min(r1, start + SAS_SUMMARY_CHUNK);
+        rows.clear();
+        for (int64_t r = start; r < end; ++r)
+          if (!skip_deleted || !sas_row_deleted(f, r)) rows.push_back(r);
+
+        bad[t] += sas_decode(f, sas, rows, cols, sink);
+      }
+    } catch (std::exception& e) {
+      errors[t] = e.what();
+    }
+  };
+
+  if (nt <= 1) {
+    work(0);
+  } else {
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < nt; ++t) pool.emplace_back(work, t);
+    for (auto& t : pool) t.join();
+  }
+
+  for (size_t t = 0; t < nt; ++t) {
+    if (!errors[t].empty()) throw SasError(SAS_ERROR_READ, errors[t]);
+    badrows += bad[t];
+  }
+
+  // ranges are merged in file order, the result does not depend on timing
+  stats = std::move(part[0]);
+  for (size_t t = 1; t < nt; ++t)
+    for (size_t j = 0; j < cols.size(); ++j)
+      stats[j].merge(part[t][j]);
+
+  return badrows;
+}
+
+#endif
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2026 Jan Marvin Garbuszus
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SAS transport files (XPORT version 5 and 8) as described in SAS technical
+ * support document TS-140. The file is a sequence of 80 byte records: a
+ * library header followed by members. Each member has a header, one namestr
+ * of 140 bytes per variable, optional long labels (version 8) and the
+ * observations, stored back to back and padded with blanks to a full record.
+ * Numerics are big endian IBM floats of 2 to 8 bytes.
+ *
+ * A member is mapped onto a SasFile with a single page holding all rows, the
+ * rows are decoded by sas_decode() like those of an uncompressed sas7bdat
+ * file.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "sasparse.h"
+
+const size_t XPT_RECORD = 80;
+
+static std::string xpt_string(const char* p, size_t len)
+{
+  size_t n = 0;
+  while (n < len && p[n] != '\0') ++n;
+  while (n > 0 && p[n - 1] == ' ') --n;
+  return std::string(p, n);
+}
+
+static int64_t xpt_read_be(const char* p, int len)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < len; ++i) v = (v << 8) | (unsigned char)p[i];
+  // sign extension of shorts and ints
+  if (len < 8 && (v >> (8 * len - 1)) & 1) v |= ~0ULL << (8 * len);
+  return (int64_t)v;
+}
+
+// "HEADER RECORD*******name    HEADER RECORD!!!!!!!" followed by six numbers
+// of five digits
+static bool xpt_header(const char* rec, const char* name, int* num = nullptr)
+{
+  if (std::memcmp(rec, "HEADER RECORD*******", 20) != 0 ||
+      std::memcmp(rec + 20, name, 8) != 0 ||
+      std::memcmp(rec + 28, "HEADER RECORD!!!!!!!", 20) != 0)
+    return false;
+
+  if (num) {
+    for (int i = 0; i < 6; ++i) {
+      num[i] = 0;
+      for (int d = 0; d < 5; ++d) {
+        char c = rec[48 + 5 * i + d];
+        if (c >= '0' && c <= '9') num[i] = num[i] * 10 + (c - '0');
+      }
+    }
+  }
+
+  return true;
+}
+
+static void xpt_record(std::istream& sas, char* rec)
+{
+  if (!sas.read(rec, XPT_RECORD))
+    throw SasError(SAS_ERROR_READ, "transport record beyond end of file");
+}
+
+// ddMMMyy:hh:mm:ss as seconds since 1960, 0 if the date is invalid
+static double xpt_datetime(const char* p)
+{
+  static const char* months[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                 "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+
+  std::string s(p, 16);
+  int day = std::atoi(s.substr(0, 2).c_str());
+  int year = std::atoi(s.substr(5, 2).c_str());
+  int hour = std::atoi(s.substr(8, 2).c_str());
+  int min = std::atoi(s.substr(11, 2).c_str());
+  int sec = std::atoi(s.substr(14, 2).c_str());
+
+  int month = 0;
+  for (int m = 0; m < 12; ++m)
+    if (s.compare(2, 3, months[m]) == 0) month = m + 1;
+  if (month == 0 || day < 1 || day > 31) return 0;
+
+  // two digit years, as SAS with YEARCUTOFF=1960
+  year += year < 60 ? 2000 : 1900;
+
+  // days since 1970-01-01 of a proleptic gregorian date
+  int y = year - (month <= 2);
+  int era = (y >= 0 ? y : y - 399) / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  double days = era * 146097.0 + doe - 719468;
+
+  // 1960-01-01 is 3653 days before 1970-01-01
+  return (days + 3653) * 86400 + hour * 3600 + min * 60 + sec;
+}
+
+bool sas_is_xport(std::istream& sas)
+{
+  char rec[XPT_RECORD];
+  sas.seekg(0, sas.beg);
+  bool found = sas.read(rec, XPT_RECORD) &&
+    (xpt_header(rec, "LIBRARY ") || xpt_header(rec, "LIBV8   "));
+  sas.clear();
+  sas.seekg(0, sas.beg);
+  return found;
+}
+
+uint64_t readsas_xport(std::istream& sas, SasLog& log, SasFile& f,
+                       uint64_t offset)
+{
+  const bool debug = log.debug != nullptr;
+  std::ostream nullout(nullptr);
+  std::ostream& dbg = debug ? *log.debug : nullout;
+
+  SasTimer timer(log.profile, SAS_PHASE_HEADER);
+
+  char rec[XPT_RECORD];
+  int num[6];
+
+  // library header, the first real header and the modification date
+  sas.seekg(0, sas.beg);
+  xpt_record(sas, rec);
+
+  bool v8 = xpt_header(rec, "LIBV8   ");
+  if (!v8 && !xpt_header(rec, "LIBRARY "))
+    throw SasError(SAS_ERROR_FORMAT, "not a SAS transport file");
+
+  xpt_record(sas, rec);
+  f.sasfile = xpt_string(rec, 8);
+  f.sasrel = xpt_string(rec + 24, 8);
+  f.osname = xpt_string(rec + 32, 8);
+  f.filetype = v8 ? "XPORT V8" : "XPORT";
+  xpt_record(sas, rec);
+
+  if (offset == 0) offset = sas.tellg();
+  if (offset % XPT_RECORD != 0 || offset + XPT_RECORD > f.size)
+    throw SasError(SAS_ERROR_ARGUMENT, "no transport member at this offset");
+
+  // member header. The size of the namestr records is 140, 136 on VAX.
+  sas.seekg(offset, sas.beg);
+  xpt_record(sas, rec);
+  if (!xpt_header(rec, v8 ? "MEMBV8  " : "MEMBER  ", num))
+    sas_stop("transport member header not found at %d", offset);
+
+  int64_t namestr_size = num[5];
+  if (namestr_size < 88) sas_stop("invalid namestr size %d", namestr_size);
+
+  xpt_record(sas, rec);
+  if (!xpt_header(rec, v8 ? "DSCPTV8 " : "DSCRPTR "))
+    sas_stop("transport descriptor header not found");
+
+  // dataset name, version, os and creation date
+  xpt_record(sas, rec);
+  if (v8) {
+    f.dataset = xpt_string(rec + 8, 32);
+    f.sasrel = xpt_string(rec + 48, 8);
+    f.osname = xpt_string(rec + 56, 8);
+  } else {
+    f.dataset = xpt_string(rec + 8, 8);
+    f.sasrel = xpt_string(rec + 24, 8);
+    f.osname = xpt_string(rec + 32, 8);
+  }
+  f.created = xpt_datetime(rec + 64);
+
+  // modification date, dataset label and type
+  xpt_record(sas, rec);
+  f.modified = xpt_datetime(rec);
+
+  xpt_record(sas, rec);
+  if (!xpt_header(rec, v8 ? "NAMSTV8 " : "NAMESTR ", num))
+    sas_stop("transport namestr header not found");
+
+  int64_t k = num[1];
+
+  if (debug)
+    dbg << "member " << f.dataset << " at " << offset << ": " << k <<
+      " variables" << std::endl;
+
+  // namestr records, padded to a full record
+  std::string ns(k * namestr_size, '\0');
+  if (k > 0 && !sas.read(&ns[0], ns.size()))
+    throw SasError(SAS_ERROR_READ, "namestr records beyond end of file");
+
+  uint64_t pos = sas.tellg();
+  pos += (XPT_RECORD - pos % XPT_RECORD) % XPT_RECORD;
+  sas.seekg(pos, sas.beg);
+
+  f.rowlength = 0;
+
+  for (int64_t i = 0; i < k; ++i) {
+    const char* p = ns.data() + i * namestr_size;
+
+    int16_t ntype = xpt_read_be(p, 2);
+    int32_t nlng = xpt_read_be(p + 4, 2);
+    int64_t npos = xpt_read_be(p + 84, 4);
+
+    std::string name = xpt_string(p + 8, 8);
+    if (v8 && namestr_size >= 122) {
+      std::string longname = xpt_string(p + 88, 32);
+      if (!longname.empty()) name = longname;
+    }
+
+    if (ntype == 1 && (nlng < 2 || nlng > 8))
+      sas_warning(log, "numeric variable %s has invalid length %d", name,
+                  nlng);
+
+    f.varnames.push_back(name);
+    f.labels.push_back(xpt_string(p + 16, 40));
+    f.formats.push_back(xpt_string(p + 56, 8));
+    f.vartyps.push_back(ntype == 1 ? 1 : 2);
+    f.colwidth.push_back(nlng);
+    f.coloffset.push_back(npos);
+    f.fmt32s.push_back(xpt_read_be(p + 64, 2) +
+                       (double)xpt_read_be(p + 66, 2) / 10);
+    f.ifmt32s.push_back(xpt_read_be(p + 80, 2) +
+                        (double)xpt_read_be(p + 82, 2) / 10);
+    f.fmtkeys.push_back(0);
+
+    if (npos >= 0 && nlng > 0)
+      f.rowlength = std::max<uint64_t>(f.rowlength, npos + nlng);
+  }
+  f.k = k;
+
+  // version 8 stores labels longer than 40 characters separately, version 9
+  // formats longer than 8 characters as well
+  xpt_record(sas, rec);
+  bool v9 = xpt_header(rec, "LABELV9 ", num);
+  if (v9 || xpt_header(rec, "LABELV8 ", num)) {
+    for (int i = 0; i < num[0]; ++i) {
+      char len[10];
+      int nlen = v9 ? 10 : 6;
+      if (!sas.read(len, nlen))
+        throw SasError(SAS_ERROR_READ, "transport labels beyond end of file");
+
+      int64_t var = xpt_read_be(len, 2) - 1;
+      std::vector<int64_t> sizes;
+      for (int s = 2; s < nlen; s += 2) sizes.push_back(xpt_read_be(len + s, 2));
+
+      std::vector<std::string> fields;
+      for (auto size : sizes) {
+        std::string field(std::max<int64_t>(size, 0), '\0');
+        if (size > 0 && !sas.read(&field[0], size))
+          throw SasError(SAS_ERROR_READ, "transport labels beyond end of file");
+        fields.push_back(xpt_string(field.data(), field.size()));
+      }
+
+      if (var < 0 || var >= k) continue;
+      f.labels[var] = fields[1];
+      if (v9 && !fields[2].empty()) f.formats[var] = fields[2];
+    }
+
+    pos = sas.tellg();
+    pos += (XPT_RECORD - pos % XPT_RECORD) % XPT_RECORD;
+    sas.seekg(pos, sas.beg);
+    xpt_record(sas, rec);
+  }
+
+  if (!xpt_header(rec, v8 ? "OBSV8   " : "OBS     "))
+    sas_stop("transport observation header not found");
+
+  timer.stop();
+  SasTimer pages(log.profile, SAS_PHASE_PAGES);
+
+  // observations end at the next member header or at the end of the file.
+  // Members are found record by record, there is no directory.
+  uint64_t data = sas.tellg(), end = f.size, next = 0;
+  const char* member = v8 ? "MEMBV8  " : "MEMBER  ";
+  std::string chunk(XPT_RECORD * 4096, '\0');
+
+  for (uint64_t at = data; at < f.size && next == 0; ) {
+    log.check_interrupt();
+
+    sas.seekg(at, sas.beg);
+    sas.read(&chunk[0], chunk.size());
+    size_t got = sas.gcount();
+    sas.clear();
+    if (got < XPT_RECORD) break;
+
+    for (size_t r = 0; r + XPT_RECORD <= got; r += XPT_RECORD) {
+      if (xpt_header(&chunk[r], member)) {
+        end = next = at + r;
+        break;
+      }
+    }
+
+    at += got - got % XPT_RECORD;
+  }
+
+  // the last record is padded with blanks. Rows of blanks in it are padding,
+  // as in every other reader a row of empty strings is lost there.
+  int64_t n = f.rowlength > 0 ? (end - data) / f.rowlength : 0;
+  std::string row(f.rowlength, '\0');
+  while (n > 0 && data + (n - 1) * f.rowlength + XPT_RECORD > end) {
+    sas.seekg(data + (n - 1) * f.rowlength, sas.beg);
+    if (!sas.read(&row[0], row.size()) ||
+        row.find_first_not_of(' ') != std::string::npos)
+      break;
+    --n;
+  }
+  sas.clear();
+
+  if (debug)
+    dbg << "rows: " << n << ", row length: " << f.rowlength <<
+      ", next member: " << next << std::endl;
+
+  // a single page holding all rows. Header and page size stay 0, members
+  // may start beyond 4 GB.
+  SasPage pg;
+  pg.data_pos = data;
+  pg.rows = n;
+  pg.type = 256;
+  f.pages.push_back(pg);
+  f.totalrowsvec.push_back(n);
+
+  f.ibm = true;
+  f.n = n;
+  f.pagecount = 1;
+  f.dataoffset = 1;
+  f.size = end;
+
+  return next;
+}
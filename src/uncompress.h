@@ -7,11 +7,16 @@
  *
  */
 
-#include <math.h>
-#include "sas.h"
-#include "uncompress.h"
+#include <algorithm>
+#include <stdint.h>
+#include <string>
 
-std::string SASYZCRL(uint64_t rowlen, uint64_t reslen, const std::string& rowstr, bool debug) {
+/*
+ * The functions do not touch the R API. The caller has to check whether the
+ * result is of the expected length reslen.
+ */
+
+inline std::string SASYZCRL(uint64_t rowlen, uint64_t reslen, const std::string& rowstr) {
     std::string res;
     res.reserve(reslen);
 
@@ -93,13 +98,10 @@ std::string SASYZCRL(uint64_t rowlen, uint64_t reslen, const std::string& rowstr
         }
     }
 
-    if (res.size() != reslen)
-        Rcpp::warning("SASYZCRL: string size %zu != %zu\n", res.size(), reslen);
-
     return res;
 }
 
-std::string SASYZCR2(uint64_t rowlen, uint64_t reslen, const std::string& rowstr, bool debug) {
+inline std::string SASYZCR2(uint64_t rowlen, uint64_t reslen, const std::string& rowstr) {
     std::string res;
     res.reserve(reslen);
 
@@ -182,12 +184,6 @@ std::string SASYZCR2(uint64_t rowlen, uint64_t reslen, const std::string& rowstr
         }
     }
 
-    if (res.size() != reslen) {
-        Rcpp::warning("SASYZCR2 mismatch: %zu != %zu", res.size(), reslen);
-        if (res.size() < reslen) res.append(reslen - res.size(), '\0');
-        else if (res.size() > reslen) res.resize(reslen);
-    }
-
     return res;
 }
 